@@ -0,0 +1,15 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+namespace fs::benchmark
+{
+
+// each benchmark returns 0 on success, non-zero if implementations disagree
+
+int run_substring_matcher_benchmark(const lang::item_filter& filter);
+int run_compare_strings_benchmark(const lang::item_filter& filter);
+int run_item_batch_benchmark(const lang::item_filter& filter);
+int run_real_filter_parse_benchmark(const lang::item_filter& filter);
+
+}
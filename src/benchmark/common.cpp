@@ -0,0 +1,95 @@
+#include "common.hpp"
+
+#include <fs/compiler/compiler.hpp>
+#include <fs/lang/conditions.hpp>
+#include <fs/lang/market/item_price_data.hpp>
+#include <fs/parser/parser.hpp>
+#include <fs/utility/file.hpp>
+#include <fs/log/console_logger.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace fs::benchmark
+{
+
+std::optional<lang::item_filter>
+load_generated_filter(const std::filesystem::path& template_path, const std::optional<std::filesystem::path>& data_dir)
+{
+	log::console_logger logger;
+
+	std::optional<std::string> source = utility::load_file(template_path, logger);
+	if (!source)
+		return std::nullopt;
+
+	lang::market::item_price_data data;
+	if (data_dir) {
+		std::optional<lang::market::item_price_report> report = lang::market::load_item_price_report(*data_dir, logger);
+		if (!report)
+			return std::nullopt;
+
+		data = std::move((*report).data);
+	}
+
+	std::optional<std::string> output = compiler::parse_compile_generate_spirit_filter_without_preamble(
+		*source, data, compiler::settings{}, logger);
+	if (!output)
+		return std::nullopt;
+
+	std::variant<parser::parsed_real_filter, parser::parse_failure_data> parse_result = parser::parse_real_filter(*output);
+	if (std::holds_alternative<parser::parse_failure_data>(parse_result)) {
+		logger.error() << "failed to parse generated filter\n";
+		return std::nullopt;
+	}
+
+	compiler::diagnostics_store diagnostics;
+	std::optional<lang::item_filter> filter = compiler::compile_real_filter(
+		compiler::settings{}, std::get<parser::parsed_real_filter>(parse_result).ast, diagnostics);
+	if (!filter)
+		logger.error() << "failed to compile generated filter\n";
+
+	return filter;
+}
+
+std::vector<std::vector<std::string_view>>
+collect_non_exact_string_conditions(const lang::item_filter& filter)
+{
+	std::vector<std::vector<std::string_view>> result;
+
+	for (const lang::block_variant& bv : filter.blocks) {
+		const auto* block = std::get_if<lang::item_filter_block>(&bv);
+		if (block == nullptr)
+			continue;
+
+		for (const auto& cond : block->conditions.conditions) {
+			const auto* str_cond = dynamic_cast<const lang::string_comparison_condition*>(cond.get());
+			if (str_cond == nullptr || str_cond->comparison() == lang::equality_comparison_type::exact_match)
+				continue;
+
+			std::vector<std::string_view>& patterns = result.emplace_back();
+			for (const lang::string& value : str_cond->values())
+				patterns.push_back(value.value);
+		}
+	}
+
+	return result;
+}
+
+std::vector<std::string>
+make_test_item_strings(const std::vector<std::vector<std::string_view>>& conditions)
+{
+	std::vector<std::string> result;
+	for (const auto& patterns : conditions)
+		for (std::string_view pattern : patterns)
+			result.emplace_back(pattern);
+
+	result.emplace_back("Maelström Staff");
+	result.emplace_back("Superior Glorious Plate of the Unknown Base Type");
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs::benchmark
+{
+
+/**
+ * @brief generate a real filter from a filter template, the same way the CLI does
+ * @param template_path path to the .filtertemplate file
+ * @param data_dir item price report directory (optional, without it autogen blocks are empty)
+ */
+[[nodiscard]] std::optional<lang::item_filter>
+load_generated_filter(const std::filesystem::path& template_path, const std::optional<std::filesystem::path>& data_dir);
+
+// values of each string condition in the filter that does not use ==
+[[nodiscard]] std::vector<std::vector<std::string_view>>
+collect_non_exact_string_conditions(const lang::item_filter& filter);
+
+// every string from conditions (unique), plus strings that match nothing
+[[nodiscard]] std::vector<std::string>
+make_test_item_strings(const std::vector<std::vector<std::string_view>>& conditions);
+
+class stopwatch
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	stopwatch() : m_start(clock::now()) {}
+
+	[[nodiscard]] double elapsed_ms() const
+	{
+		return std::chrono::duration<double, std::milli>(clock::now() - m_start).count();
+	}
+
+private:
+	clock::time_point m_start;
+};
+
+}
@@ -0,0 +1,81 @@
+#include "benchmarks.hpp"
+#include "common.hpp"
+
+#include <fs/utility/string_helpers.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs::benchmark
+{
+
+namespace
+{
+
+using compare_function_type = bool (*)(std::string_view, std::string_view, bool);
+
+[[nodiscard]] std::vector<bool>
+compare_all(
+	compare_function_type compare,
+	const std::vector<std::string>& values,
+	const std::vector<std::vector<std::string_view>>& conditions,
+	double& elapsed_ms)
+{
+	std::vector<bool> result;
+	const stopwatch timer;
+
+	for (const std::string& value : values)
+		for (const auto& patterns : conditions)
+			for (std::string_view pattern : patterns)
+				result.push_back(compare(value, pattern, false));
+
+	elapsed_ms = timer.elapsed_ms();
+	return result;
+}
+
+[[nodiscard]] int
+run_for(
+	std::string_view description,
+	const std::vector<std::string>& values,
+	const std::vector<std::vector<std::string_view>>& conditions)
+{
+	double scalar_ms = 0;
+	double default_ms = 0;
+	const std::vector<bool> expected = compare_all(&utility::compare_strings_ignore_diacritics_scalar, values, conditions, scalar_ms);
+	const std::vector<bool> actual = compare_all(&utility::compare_strings_ignore_diacritics, values, conditions, default_ms);
+
+	std::cout << description << " (" << expected.size() << " comparisons):\n"
+		<< "    scalar:  " << scalar_ms << " ms\n"
+		<< "    default: " << default_ms << " ms\n";
+
+	if (actual != expected) {
+		std::cout << "ERROR: results differ\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+} // namespace
+
+int run_compare_strings_benchmark(const lang::item_filter& filter)
+{
+	const std::vector<std::vector<std::string_view>> conditions = collect_non_exact_string_conditions(filter);
+	const std::vector<std::string> values = make_test_item_strings(conditions);
+
+	// mod texts and similar properties are much longer than item names
+	std::vector<std::string> long_values;
+	for (std::size_t i = 0; i < values.size(); ++i) {
+		std::string& long_value = long_values.emplace_back();
+		for (std::size_t j = 0; j < 8; ++j)
+			long_value += values[(i + j) % values.size()] + ' ';
+	}
+
+	const int result = run_for("item names", values, conditions);
+	return run_for("long strings", long_values, conditions) + result;
+}
+
+}
@@ -0,0 +1,83 @@
+#include "benchmarks.hpp"
+#include "common.hpp"
+
+#include <fs/lang/compiled_filter.hpp>
+#include <fs/lang/item_batch.hpp>
+#include <fs/lang/item.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs::benchmark
+{
+
+namespace
+{
+
+[[nodiscard]] std::vector<lang::item>
+make_items(const lang::item_filter& filter)
+{
+	const std::vector<std::string> names = make_test_item_strings(collect_non_exact_string_conditions(filter));
+	const char* const classes[] = {"Stackable Currency", "Divination Cards", "Skill Gems", "Rings", "Boots", "Maps"};
+
+	std::vector<lang::item> items;
+	for (std::size_t i = 0; i < 100'000; ++i) {
+		lang::item itm;
+		itm.class_ = classes[i % std::size(classes)];
+		itm.base_type = names.empty() ? "Chaos Orb" : names[i % names.size()];
+		itm.item_level = static_cast<int>(i % 86) + 1;
+		itm.quality = static_cast<int>(i % 21);
+		itm.stack_size = static_cast<int>(i % 20) + 1;
+		itm.gem_level = static_cast<int>(i % 21) + 1;
+		itm.map_tier = static_cast<int>(i % 16) + 1;
+		itm.rarity_ = static_cast<lang::rarity_type>(i % 4);
+		itm.is_identified = i % 3 == 0;
+		itm.corruption_status = i % 5 == 0 ? lang::corruption_status_t::corrupted : lang::corruption_status_t::normal;
+		itm.influence.shaper = i % 17 == 0;
+		items.push_back(std::move(itm));
+	}
+
+	return items;
+}
+
+} // namespace
+
+int run_item_batch_benchmark(const lang::item_filter& filter)
+{
+	const lang::compiled_filter compiled = lang::compile_item_filter(filter);
+	const std::vector<lang::item> items = make_items(filter);
+	constexpr int area_level = 83;
+
+	std::vector<lang::item_style> expected;
+	expected.reserve(items.size());
+	const stopwatch item_timer;
+	for (const lang::item& itm : items)
+		expected.push_back(lang::pass_item_through_compiled_filter(itm, compiled, area_level));
+	const double item_ms = item_timer.elapsed_ms();
+
+	std::vector<lang::item_style> actual(items.size());
+	const stopwatch batch_timer;
+	const lang::item_batch batch(items.data(), items.data() + items.size(), compiled);
+	const double batch_build_ms = batch_timer.elapsed_ms();
+	lang::pass_item_batch_through_compiled_filter(batch, compiled, area_level, actual.data());
+	const double batch_ms = batch_timer.elapsed_ms();
+
+	std::cout << items.size() << " items, " << compiled.blocks.size() << " blocks:\n"
+		<< "    item by item: " << item_ms << " ms\n"
+		<< "    batch:        " << batch_ms << " ms (" << batch_build_ms << " ms to build columns)\n";
+
+	for (std::size_t i = 0; i < items.size(); ++i) {
+		if (actual[i].visibility.show != expected[i].visibility.show
+			|| actual[i].font_size.size.value != expected[i].font_size.size.value)
+		{
+			std::cout << "ERROR: results differ for item " << i << "\n";
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+}
@@ -0,0 +1,53 @@
+#include "benchmarks.hpp"
+#include "common.hpp"
+
+#include <iostream>
+#include <optional>
+#include <string_view>
+
+namespace
+{
+
+void print_usage(const char* program_name)
+{
+	std::cout << "usage: " << program_name << " BENCHMARK TEMPLATE_PATH [ITEM_PRICE_REPORT_DIRECTORY]\n"
+		"benchmarks:\n"
+		"    substring_matcher - non-exact string conditions: substring_matcher vs compare_strings_ignore_diacritics\n"
+		"    compare_strings   - compare_strings_ignore_diacritics: SIMD vs scalar\n"
+		"    item_batch        - compiled filter: item by item vs structure-of-arrays batch\n"
+		"    real_filter_parse - parse and compile a large real filter (as loaded by the GUI)\n";
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3 || argc > 4) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	const std::string_view benchmark_name = argv[1];
+	std::optional<std::filesystem::path> data_dir;
+	if (argc == 4)
+		data_dir = argv[3];
+
+	std::optional<fs::lang::item_filter> filter = fs::benchmark::load_generated_filter(argv[2], data_dir);
+	if (!filter)
+		return 1;
+
+	if (benchmark_name == "substring_matcher")
+		return fs::benchmark::run_substring_matcher_benchmark(*filter);
+
+	if (benchmark_name == "compare_strings")
+		return fs::benchmark::run_compare_strings_benchmark(*filter);
+
+	if (benchmark_name == "item_batch")
+		return fs::benchmark::run_item_batch_benchmark(*filter);
+
+	if (benchmark_name == "real_filter_parse")
+		return fs::benchmark::run_real_filter_parse_benchmark(*filter);
+
+	print_usage(argv[0]);
+	return 1;
+}
@@ -0,0 +1,80 @@
+#include "benchmarks.hpp"
+#include "common.hpp"
+
+#include <fs/parser/parser.hpp>
+#include <fs/compiler/compiler.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <variant>
+
+namespace fs::benchmark
+{
+
+/*
+ * Most of parsing time is spent allocating AST strings, vectors and variant
+ * nodes (~75k allocations for 2 MB of input). An arena for them is not done:
+ * x3 default-constructs attributes, so every AST type would have to become
+ * allocator-aware and the arena could only be injected as a process-wide
+ * default resource - unsafe, filters are also parsed on worker threads.
+ * Reserving the position cache up front made no measurable difference either.
+ */
+int run_real_filter_parse_benchmark(const lang::item_filter& filter)
+{
+	std::ostringstream ss;
+	filter.print(ss, lang::style_overrides{});
+	const std::string filter_text = ss.str();
+
+	if (filter_text.empty()) {
+		std::cout << "ERROR: filter is empty\n";
+		return 1;
+	}
+
+	// community filters are a few MB, repeat the filter to reach a comparable size
+	constexpr std::size_t target_size = 2'000'000;
+	std::string input;
+	while (input.size() < target_size)
+		input += filter_text;
+
+	constexpr int num_runs = 5;
+	double parse_ms = 0;
+	double parse_compile_ms = 0;
+	std::size_t num_positions = 0;
+	for (int i = 0; i < num_runs; ++i) {
+		// the same steps as loading a real filter in the GUI
+		const stopwatch timer;
+		std::variant<parser::parsed_real_filter, parser::parse_failure_data> parse_result = parser::parse_real_filter(input);
+		const double run_parse_ms = timer.elapsed_ms();
+
+		if (std::holds_alternative<parser::parse_failure_data>(parse_result)) {
+			std::cout << "ERROR: failed to parse the filter\n";
+			return 1;
+		}
+
+		const auto& parsed = std::get<parser::parsed_real_filter>(parse_result);
+		compiler::diagnostics_store diagnostics;
+		const std::optional<lang::item_filter> compiled =
+			compiler::compile_real_filter(compiler::settings{}, parsed.ast, diagnostics);
+		const double run_parse_compile_ms = timer.elapsed_ms();
+
+		if (!compiled) {
+			std::cout << "ERROR: failed to compile the filter\n";
+			return 1;
+		}
+
+		num_positions = parsed.metadata.lookup.size();
+		parse_ms = i == 0 ? run_parse_ms : std::min(parse_ms, run_parse_ms);
+		parse_compile_ms = i == 0 ? run_parse_compile_ms : std::min(parse_compile_ms, run_parse_compile_ms);
+	}
+
+	std::cout << input.size() << " bytes, " << num_positions << " positions (best of " << num_runs << " runs):\n"
+		<< "    parse:           " << parse_ms << " ms\n"
+		<< "    parse + compile: " << parse_compile_ms << " ms\n";
+
+	return 0;
+}
+
+}
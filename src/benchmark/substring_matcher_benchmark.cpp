@@ -0,0 +1,83 @@
+#include "benchmarks.hpp"
+#include "common.hpp"
+
+#include <fs/utility/substring_matcher.hpp>
+#include <fs/utility/string_helpers.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs::benchmark
+{
+
+namespace
+{
+
+// the implementation used before substring_matcher
+[[nodiscard]] std::size_t
+find_first_pattern_naive(std::string_view value, const std::vector<std::string_view>& patterns)
+{
+	for (std::size_t i = 0; i < patterns.size(); ++i)
+		if (utility::compare_strings_ignore_diacritics(value, patterns[i], false))
+			return i;
+
+	return utility::substring_matcher::npos;
+}
+
+} // namespace
+
+int run_substring_matcher_benchmark(const lang::item_filter& filter)
+{
+	std::vector<std::vector<std::string_view>> conditions = collect_non_exact_string_conditions(filter);
+	const std::vector<std::string> values = make_test_item_strings(conditions);
+
+	// also simulate a generated block that lists every name
+	// (they do not appear in templates without item price data)
+	conditions.emplace_back(values.begin(), values.end());
+
+	std::size_t num_patterns = 0;
+	for (const auto& patterns : conditions)
+		num_patterns += patterns.size();
+
+	std::cout << "non-exact string conditions: " << conditions.size()
+		<< ", values in them: " << num_patterns
+		<< ", tested strings: " << values.size() << "\n";
+
+	std::vector<std::size_t> expected;
+	expected.reserve(conditions.size() * values.size());
+	const stopwatch naive_timer;
+	for (const auto& patterns : conditions)
+		for (const std::string& value : values)
+			expected.push_back(find_first_pattern_naive(value, patterns));
+	const double naive_ms = naive_timer.elapsed_ms();
+
+	const stopwatch build_timer;
+	std::vector<utility::substring_matcher> matchers;
+	matchers.reserve(conditions.size());
+	for (const auto& patterns : conditions)
+		matchers.emplace_back(patterns);
+	const double build_ms = build_timer.elapsed_ms();
+
+	std::vector<std::size_t> actual;
+	actual.reserve(conditions.size() * values.size());
+	const stopwatch matcher_timer;
+	for (const auto& matcher : matchers)
+		for (const std::string& value : values)
+			actual.push_back(matcher.find_first_pattern(value));
+	const double matcher_ms = matcher_timer.elapsed_ms();
+
+	std::cout << "compare_strings_ignore_diacritics scan: " << naive_ms << " ms\n"
+		<< "substring_matcher: " << matcher_ms << " ms (+ " << build_ms << " ms to build)\n";
+
+	if (actual != expected) {
+		std::cout << "ERROR: results differ\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+}
@@ -1,14 +1,24 @@
 #include "core.hpp"
 
 #include <fs/compiler/compiler.hpp>
+#include <fs/compiler/template_cache.hpp>
 #include <fs/network/item_price_report.hpp>
 #include <fs/network/ggg/download_data.hpp>
 #include <fs/network/ggg/parse_data.hpp>
 #include <fs/lang/constants.hpp>
 #include <fs/utility/file.hpp>
+#include <fs/utility/thread_pool.hpp>
+#include <fs/log/buffer_logger.hpp>
 #include <fs/log/logger.hpp>
 
+#include <cstddef>
 #include <filesystem>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <system_error>
+#include <tuple>
 #include <utility>
 
 using namespace fs;
@@ -16,37 +26,102 @@ using namespace fs;
 namespace
 {
 
-bool generate_item_filter_impl(
-	const lang::market::item_price_report& report,
-	const std::filesystem::path& source_filepath,
-	const std::filesystem::path& output_filepath,
+void check_output_extension(const std::filesystem::path& output_filepath, bool ruthless, log::logger& logger)
+{
+	const char* const expected_extension = ruthless
+		? lang::constants::file_extension_filter_ruthless
+		: lang::constants::file_extension_filter;
+	const auto actual_extension = output_filepath.extension().generic_string();
+
+	if (expected_extension != actual_extension) {
+		logger.warning() << "output file extension \"" << actual_extension
+			<< "\" differs from expected \"" << expected_extension
+			<< "\" - it is recommended to rename the file\n";
+	}
+}
+
+// Same as compiler::parse_and_compile_spirit_filter but the compiled filter template is
+// read from/saved to cache directory, keyed by template contents and settings.
+// Origins in the result refer to the source.
+std::optional<lang::spirit_item_filter> compile_with_template_cache(
+	std::string_view source,
+	const std::filesystem::path& cache_dirpath,
 	fs::compiler::settings st,
 	log::logger& logger)
 {
-	auto check_extension = [&](const char* expected_extension) {
-		const auto actual_extension = output_filepath.extension().generic_string();
-
-		if (expected_extension != actual_extension) {
-			logger.warning() << "output file extension \"" << actual_extension
-				<< "\" differs from expected \"" << expected_extension
-				<< "\" - it is recommended to rename the file\n";
+	const std::uint64_t key = compiler::make_template_cache_key(source, st);
+	std::ostringstream filename;
+	filename << std::hex << std::setw(16) << std::setfill('0') << key << ".fstc";
+	const std::filesystem::path cache_filepath = cache_dirpath / filename.str();
+
+	std::error_code ec;
+	const std::string cache_content = utility::load_file(cache_filepath, ec);
+	if (!ec) {
+		std::optional<compiler::spirit_filter_compilation> cached =
+			compiler::deserialize_spirit_filter(cache_content, source, key, st, logger);
+
+		if (cached) {
+			(*cached).diagnostics.output_messages((*cached).metadata, logger);
+			return std::move((*cached).filter);
 		}
-	};
 
-	if (st.ruthless_mode) {
-		check_extension(lang::constants::file_extension_filter_ruthless);
+		logger.warning() << "ignoring invalid template cache file " << cache_filepath.generic_string() << '\n';
+	}
+
+	std::optional<compiler::spirit_filter_compilation> compilation =
+		compiler::parse_and_compile_spirit_filter_with_metadata(source, st, logger);
+	if (!compilation)
+		return std::nullopt;
+
+	if (std::optional<std::string> cache_data = compiler::serialize_spirit_filter(*compilation, key); cache_data) {
+		if (utility::create_directories(cache_dirpath, logger))
+			(void) utility::save_file(cache_filepath, *cache_data, logger);
 	}
 	else {
-		check_extension(lang::constants::file_extension_filter);
+		logger.info() << "Filter template contains conditions which can not be cached, cache not saved.\n";
 	}
 
+	return std::move((*compilation).filter);
+}
+
+// same output as compiler::parse_compile_generate_spirit_filter_with_preamble
+std::optional<std::string> generate_with_template_cache(
+	const lang::market::item_price_report& report,
+	std::string_view source,
+	const std::filesystem::path& cache_dirpath,
+	fs::compiler::settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	logger.info() << "" << report.data; // add << "" to workaround calling <<(rvalue, item_price_data)
+
+	std::optional<lang::spirit_item_filter> filter_template = compile_with_template_cache(source, cache_dirpath, st, logger);
+	if (!filter_template)
+		return std::nullopt;
+
+	return compiler::generate_item_filter_with_preamble(*filter_template, report, st, logger, parallel);
+}
+
+bool generate_item_filter_impl(
+	const lang::market::item_price_report& report,
+	const std::filesystem::path& source_filepath,
+	const std::filesystem::path& output_filepath,
+	const boost::optional<std::string>& template_cache_dirpath,
+	fs::compiler::settings st,
+	log::logger& logger)
+{
+	check_output_extension(output_filepath, st.ruthless_mode, logger);
+
 	std::optional<std::string> source_file_content = utility::load_file(source_filepath, logger);
 
 	if (!source_file_content)
 		return false;
 
-	std::optional<std::string> filter_content = compiler::parse_compile_generate_spirit_filter_with_preamble(
-		*source_file_content, report, st, logger);
+	utility::thread_pool pool;
+	const utility::parallel_settings parallel{&pool};
+	std::optional<std::string> filter_content = template_cache_dirpath
+		? generate_with_template_cache(report, *source_file_content, *template_cache_dirpath, st, logger, parallel)
+		: compiler::parse_compile_generate_spirit_filter_with_preamble(*source_file_content, report, st, logger, parallel);
 
 	if (!filter_content)
 		return false;
@@ -124,6 +199,7 @@ bool generate_item_filter(
 	const std::optional<lang::market::item_price_report>& report,
 	const boost::optional<std::string>& input_path,
 	const boost::optional<std::string>& output_path,
+	const boost::optional<std::string>& template_cache_dirpath,
 	fs::compiler::settings st,
 	fs::log::logger& logger)
 {
@@ -142,7 +218,179 @@ bool generate_item_filter(
 		return false;
 	}
 
-	return generate_item_filter_impl(*report, *input_path, *output_path, st, logger);
+	return generate_item_filter_impl(*report, *input_path, *output_path, template_cache_dirpath, st, logger);
+}
+
+bool generate_item_filters_batch(
+	const std::vector<batch_entry>& entries,
+	const boost::optional<std::string>& template_cache_dirpath,
+	boost::posix_time::time_duration expiration_time,
+	network::download_settings settings,
+	fs::log::logger& logger)
+{
+	{
+		std::set<std::filesystem::path> output_paths;
+		for (const batch_entry& entry : entries) {
+			if (!output_paths.insert(std::filesystem::path(entry.output_path).lexically_normal()).second) {
+				logger.error() << "Output path " << entry.output_path << " is used by more than 1 batch entry.\n";
+				return false;
+			}
+		}
+	}
+
+	// obtain each distinct item price data source once, its price indexes are
+	// built once too and shared by all entries (the report does not change)
+	using data_source_key = std::tuple<
+		bool,
+		boost::optional<std::string>,
+		boost::optional<std::string>,
+		boost::optional<std::string>>;
+	struct price_source
+	{
+		std::optional<lang::market::item_price_report> report;
+		lang::market::item_price_indexes price_indexes;
+	};
+	std::map<data_source_key, price_source> reports;
+	std::vector<const price_source*> entry_reports;
+	entry_reports.reserve(entries.size());
+
+	for (const batch_entry& entry : entries) {
+		data_source_key key(
+			entry.empty_data, entry.download_league_name_ninja, entry.download_league_name_watch, entry.data_read_dir);
+		auto it = reports.find(key);
+
+		if (it == reports.end()) {
+			std::optional<lang::market::item_price_report> report = entry.empty_data
+				? lang::market::item_price_report()
+				: obtain_item_price_report(
+					entry.download_league_name_ninja,
+					entry.download_league_name_watch,
+					expiration_time,
+					settings,
+					entry.data_read_dir,
+					logger);
+			lang::market::item_price_indexes price_indexes;
+			if (report)
+				price_indexes = lang::market::item_price_indexes((*report).data);
+
+			it = reports.emplace(std::move(key), price_source{std::move(report), std::move(price_indexes)}).first;
+		}
+
+		entry_reports.push_back(&it->second);
+	}
+
+	// compile each distinct template once (per settings which affect compilation)
+	using template_key = std::tuple<std::string, bool, bool, bool>;
+	std::map<std::string, std::optional<std::string>> sources;
+	std::map<template_key, std::optional<lang::spirit_item_filter>> templates;
+	std::vector<const std::optional<lang::spirit_item_filter>*> entry_templates;
+	entry_templates.reserve(entries.size());
+
+	for (const batch_entry& entry : entries) {
+		auto source_it = sources.find(entry.input_path);
+		if (source_it == sources.end())
+			source_it = sources.emplace(entry.input_path, utility::load_file(entry.input_path, logger)).first;
+
+		if (!source_it->second) {
+			entry_templates.push_back(nullptr);
+			continue;
+		}
+
+		template_key key(
+			entry.input_path,
+			entry.st.ruthless_mode,
+			entry.st.error_handling.stop_on_error,
+			entry.st.error_handling.treat_warnings_as_errors);
+		auto it = templates.find(key);
+
+		if (it == templates.end()) {
+			logger.info() << "Filter template " << entry.input_path << ":\n";
+			it = templates.emplace(
+				std::move(key),
+				template_cache_dirpath
+					? compile_with_template_cache(*source_it->second, *template_cache_dirpath, entry.st, logger)
+					: compiler::parse_and_compile_spirit_filter(*source_it->second, entry.st, logger)).first;
+		}
+
+		entry_templates.push_back(&it->second);
+	}
+
+	// Print static blocks of each distinct template once (per style overrides), entries then only
+	// generate and print autogen blocks. Entries with passes which rewrite the whole filter can not.
+	using prerendered_key = std::tuple<
+		const lang::spirit_item_filter*,
+		boost::optional<int>, boost::optional<int>, boost::optional<int>, boost::optional<int>, bool,
+		boost::optional<int>, boost::optional<int>, boost::optional<int>, boost::optional<int>>;
+	std::map<prerendered_key, compiler::prerendered_filter_template> prerendered_templates;
+	std::vector<const compiler::prerendered_filter_template*> entry_prerendered(entries.size(), nullptr);
+
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		const batch_entry& entry = entries[i];
+		if (entry_templates[i] == nullptr || !*entry_templates[i] || entry.st.remove_unreachable_blocks || entry.st.merge_blocks)
+			continue;
+
+		const lang::spirit_item_filter& filter_template = **entry_templates[i];
+		const lang::color_overrides& color = entry.st.overrides.color;
+		const lang::font_overrides& font = entry.st.overrides.font;
+		prerendered_key key(
+			&filter_template,
+			color.show_opacity_min, color.show_opacity_max, color.hide_opacity_min, color.hide_opacity_max,
+			color.override_all_actions,
+			font.show_size_min, font.show_size_max, font.hide_size_min, font.hide_size_max);
+		auto it = prerendered_templates.find(key);
+
+		if (it == prerendered_templates.end())
+			it = prerendered_templates.emplace(std::move(key), compiler::prerendered_filter_template(filter_template, entry.st.overrides)).first;
+
+		entry_prerendered[i] = &it->second;
+	}
+
+	// generate filters in parallel, each with its own log which is printed afterwards in manifest order;
+	// autogeneration inside each filter shares the same pool so threads are not multiplied
+	std::vector<log::buffer_logger> entry_loggers(entries.size());
+	std::vector<char> entry_results(entries.size(), false); // not vector<bool> - elements are written concurrently
+	utility::thread_pool pool;
+	const utility::parallel_settings parallel{&pool, 1};
+	utility::parallel_for(entries.size(), parallel, [&](std::size_t i) {
+		const batch_entry& entry = entries[i];
+		log::buffer_logger& entry_logger = entry_loggers[i];
+
+		const price_source& prices = *entry_reports[i];
+		if (!prices.report) {
+			entry_logger.error() << "No item price data, giving up on filter generation.\n";
+			return;
+		}
+
+		if (entry_templates[i] == nullptr || !*entry_templates[i]) {
+			entry_logger.error() << "Filter template could not be loaded or compiled, giving up on filter generation.\n";
+			return;
+		}
+
+		check_output_extension(entry.output_path, entry.st.ruthless_mode, entry_logger);
+
+		const std::string filter_content = entry_prerendered[i] != nullptr
+			? compiler::generate_item_filter_with_preamble(
+				**entry_templates[i], *entry_prerendered[i], *prices.report, prices.price_indexes, entry_logger, parallel)
+			: compiler::generate_item_filter_with_preamble(
+				**entry_templates[i], *prices.report, prices.price_indexes, entry.st, entry_logger, parallel);
+
+		if (utility::save_file(entry.output_path, filter_content, entry_logger)) {
+			entry_logger.info() << "Item filter successfully saved as " << entry.output_path << ".\n";
+			entry_results[i] = true;
+		}
+	});
+
+	std::size_t num_generated = 0;
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		logger.info() << "Batch entry " << i + 1 << " (" << entries[i].output_path << "):\n";
+		entry_loggers[i].dump_to(logger);
+
+		if (entry_results[i])
+			++num_generated;
+	}
+
+	logger.info() << "Generated " << num_generated << " of " << entries.size() << " item filter(s).\n";
+	return num_generated == entries.size();
 }
 
 int print_item_price_report(
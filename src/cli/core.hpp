@@ -9,6 +9,7 @@
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <string>
+#include <vector>
 
 void
 list_leagues(
@@ -29,9 +30,37 @@ generate_item_filter(
 	const std::optional<fs::lang::market::item_price_report>& report,
 	const boost::optional<std::string>& source_filepath,
 	const boost::optional<std::string>& output_filepath,
+	const boost::optional<std::string>& template_cache_dirpath,
 	fs::compiler::settings st,
 	fs::log::logger& logger);
 
+// one filter to generate in batch mode (1 line of the manifest)
+struct batch_entry
+{
+	// exactly 1 of these should be set
+	boost::optional<std::string> download_league_name_ninja;
+	boost::optional<std::string> download_league_name_watch;
+	boost::optional<std::string> data_read_dir;
+	bool empty_data = false;
+
+	std::string input_path;
+	std::string output_path;
+	fs::compiler::settings st;
+};
+
+// Each distinct item price data source is obtained once and each distinct
+// template (with the same compilation-relevant settings) is compiled once
+// (or read from template cache directory if given) and its static blocks are
+// printed once (per style overrides), then all filters are generated and saved
+// in parallel.
+[[nodiscard]] bool
+generate_item_filters_batch(
+	const std::vector<batch_entry>& entries,
+	const boost::optional<std::string>& template_cache_dirpath,
+	boost::posix_time::time_duration expiration_time,
+	fs::network::download_settings settings,
+	fs::log::logger& logger);
+
 [[nodiscard]] int // <= exit status
 print_item_price_report(
 	const std::string& path,
@@ -6,6 +6,7 @@
 #include <fs/lang/market/item_price_data.hpp>
 #include <fs/lang/constants.hpp>
 #include <fs/network/curl/libcurl.hpp>
+#include <fs/utility/file.hpp>
 #include <fs/utility/terminal.hpp>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -13,9 +14,13 @@
 #include <boost/optional.hpp>
 
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <exception>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace po = boost::program_options;
 
@@ -28,6 +33,7 @@ void print_help(const po::options_description& options)
 		"Filter Spirit - advanced item filter generator for Path of Exile game client\n\n"
 		"Usage:\n"
 		"./filter_spirit_cli <data_obtaining_option> [cache_option]... [-g input_path output_path [generation_option]...]\n"
+		"./filter_spirit_cli [cache_option]... [--template-cache DIRPATH] --batch manifest_path\n"
 		"./filter_spirit_cli <generic_option>\n"
 		"\n"
 		"Examples:\n"
@@ -36,7 +42,9 @@ void print_help(const po::options_description& options)
 		"download API data for future reuse:\n"
 		"./filter_spirit_cli -n \"Standard\" -a 0\n"
 		"generate/refresh an item filter (from specific saved data, never download) (not recommended):\n"
-		"./filter_spirit_cli -d cache/ninja_Standard -g filter_template.txt output.filter\n";
+		"./filter_spirit_cli -d cache/ninja_Standard -g filter_template.txt output.filter\n"
+		"generate multiple filters (each manifest line: <data_obtaining_option> [generation_option]... input_path output_path):\n"
+		"./filter_spirit_cli -a 120 --batch release.txt\n";
 
 	options.print(std::cout);
 
@@ -47,6 +55,148 @@ void print_help(const po::options_description& options)
 		"contact: /u/Xeverous on reddit, Xeverous_2151 on Discord, pathofexile.com/account/view-profile/Xeverous\n";
 }
 
+// options shared by the command line and batch manifest entries
+
+void add_data_obtaining_options(po::options_description& options, batch_entry& entry)
+{
+	options.add_options()
+		("download-watch,w", po::value(&entry.download_league_name_watch)->value_name("LEAGUE"),
+			"download newest item price data from api.poe.watch for specified LEAGUE")
+		("download-ninja,n", po::value(&entry.download_league_name_ninja)->value_name("LEAGUE"),
+			"download newest item price data from poe.ninja/api for specified LEAGUE")
+		("empty-data,e",     po::bool_switch(&entry.empty_data),
+			"run with no item price data (all price queries will have no results)")
+		("read-data,d", po::value(&entry.data_read_dir)->value_name("DIRPATH"),
+			"read item price data (JSON files) from specified directory (ignores age option)")
+	;
+}
+
+void add_filter_settings_options(po::options_description& options, fs::compiler::settings& st)
+{
+	options.add_options()
+		("ruthless,r", po::bool_switch(&st.ruthless_mode), "enable Ruthless-specific filter logic")
+		("remove-unreachable-blocks", po::bool_switch(&st.remove_unreachable_blocks),
+			"remove blocks which can never match (contradictory or shadowed by earlier blocks)")
+		("merge-blocks", po::bool_switch(&st.merge_blocks),
+			"merge adjacent blocks with the same actions which differ only in values of 1 condition")
+		// warning/error/debug
+		("stop-on-error", po::bool_switch(&st.error_handling.stop_on_error),
+			"stop on first error")
+		("warning-is-error", po::bool_switch(&st.error_handling.treat_warnings_as_errors),
+			"treat warnings as errors")
+		("print-ast,p", po::bool_switch(&st.print_ast), "print abstract syntax tree (for debug purposes)")
+		// color modifications
+		("show-opacity-min", po::value(&st.overrides.color.show_opacity_min)->value_name("<0...255>"), "")
+		("show-opacity-max", po::value(&st.overrides.color.show_opacity_max)->value_name("<0...255>"), "")
+		("hide-opacity-min", po::value(&st.overrides.color.hide_opacity_min)->value_name("<0...255>"), "")
+		("hide-opacity-max", po::value(&st.overrides.color.hide_opacity_max)->value_name("<0...255>"),
+			fs::lang::color_overrides::help_opacity)
+		("opacity-all-color-actions", po::bool_switch(&st.overrides.color.override_all_actions),
+			fs::lang::color_overrides::help_override_all_actions)
+		// font modifications
+		("show-font-size-min", po::value(&st.overrides.font.show_size_min)->value_name("<1...45>"), "")
+		("show-font-size-max", po::value(&st.overrides.font.show_size_max)->value_name("<1...45>"), "")
+		("hide-font-size-min", po::value(&st.overrides.font.hide_size_min)->value_name("<1...45>"), "")
+		("hide-font-size-max", po::value(&st.overrides.font.hide_size_max)->value_name("<1...45>"),
+			fs::lang::font_overrides::help_font_size)
+	;
+	// assert correctness of numbers in command-line help
+	static_assert(fs::lang::constants::min_filter_font_size ==  1);
+	static_assert(fs::lang::constants::max_filter_font_size == 45);
+}
+
+constexpr auto input_path_str = "input-path";
+constexpr auto output_path_str = "output-path";
+
+void add_path_options(
+	po::options_description& options,
+	boost::optional<std::string>& input_path,
+	boost::optional<std::string>& output_path)
+{
+	options.add_options()
+		(input_path_str,  po::value(&input_path)->value_name("FILEPATH"),  "FILEPATH to filter template file")
+		(output_path_str, po::value(&output_path)->value_name("FILEPATH"), "FILEPATH where to generate the filter")
+	;
+}
+
+// Each non-empty line which does not start with # describes 1 filter, using the same
+// options as the command line. Relative paths are relative to the manifest's directory.
+std::optional<std::vector<batch_entry>>
+load_batch_manifest(const std::filesystem::path& manifest_path, fs::log::logger& logger)
+{
+	const std::optional<std::string> contents = fs::utility::load_file(manifest_path, logger);
+	if (!contents)
+		return std::nullopt;
+
+	const std::filesystem::path base_dir = manifest_path.parent_path();
+	const auto resolve = [&](const std::string& path) {
+		return (base_dir / path).generic_string();
+	};
+
+	std::vector<batch_entry> entries;
+	std::istringstream lines(*contents);
+	std::string line;
+	for (int line_number = 1; std::getline(lines, line); ++line_number) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		const auto first = line.find_first_not_of(" \t");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		batch_entry entry;
+		boost::optional<std::string> input_path;
+		boost::optional<std::string> output_path;
+
+		po::options_description options;
+		add_data_obtaining_options(options, entry);
+		add_filter_settings_options(options, entry.st);
+		add_path_options(options, input_path, output_path);
+
+		po::positional_options_description positional_options_description;
+		positional_options_description.add(input_path_str, 1).add(output_path_str, 1);
+
+		const auto report_error = [&]() -> fs::log::message_stream {
+			auto stream = logger.error();
+			stream << manifest_path.generic_string() << " line " << line_number << ": ";
+			return stream;
+		};
+
+		try {
+			po::variables_map vm;
+			po::store(po::command_line_parser(po::split_unix(line)).options(options).positional(positional_options_description).run(), vm);
+			po::notify(vm);
+		}
+		catch (const std::exception& e) {
+			report_error() << e.what() << '\n';
+			return std::nullopt;
+		}
+
+		const int num_data_options = entry.empty_data
+			+ entry.download_league_name_ninja.has_value()
+			+ entry.download_league_name_watch.has_value()
+			+ entry.data_read_dir.has_value();
+		if (num_data_options != 1) {
+			report_error() << "exactly 1 data obtaining option is required\n";
+			return std::nullopt;
+		}
+
+		if (!input_path || !output_path) {
+			report_error() << "input and output paths are required\n";
+			return std::nullopt;
+		}
+
+		entry.input_path = resolve(*input_path);
+		entry.output_path = resolve(*output_path);
+		if (entry.data_read_dir)
+			entry.data_read_dir = resolve(*entry.data_read_dir);
+
+		entries.push_back(std::move(entry));
+	}
+
+	return entries;
+}
+
 }
 
 int run(int argc, char* argv[])
@@ -65,21 +215,10 @@ int run(int argc, char* argv[])
 	};
 
 	try {
-		boost::optional<std::string> download_league_name_watch;
-		boost::optional<std::string> download_league_name_ninja;
-		bool opt_empty_data = false;
-		boost::optional<std::string> data_read_dir;
+		// the filter to generate with -g
+		batch_entry cli_entry;
 		po::options_description data_obtaining_options = make_options("data obtaining options (use 1)");
-		data_obtaining_options.add_options()
-			("download-watch,w", po::value(&download_league_name_watch)->value_name("LEAGUE"),
-				"download newest item price data from api.poe.watch for specified LEAGUE")
-			("download-ninja,n", po::value(&download_league_name_ninja)->value_name("LEAGUE"),
-				"download newest item price data from poe.ninja/api for specified LEAGUE")
-			("empty-data,e",     po::bool_switch(&opt_empty_data),
-				"run with no item price data (all price queries will have no results)")
-			("read-data,d", po::value(&data_read_dir)->value_name("DIRPATH"),
-				"read item price data (JSON files) from specified directory (ignores age option)")
-		;
+		add_data_obtaining_options(data_obtaining_options, cli_entry);
 
 		int max_age;
 		po::options_description cache_options = make_options("cache options");
@@ -110,52 +249,26 @@ int run(int argc, char* argv[])
 		;
 
 		bool opt_generate = false;
-		fs::compiler::settings st;
+		boost::optional<std::string> template_cache_dir;
 		po::options_description generation_options = make_options("generation options");
 		generation_options.add_options()
-			// generation
 			("generate,g", po::bool_switch(&opt_generate), "generate an item filter")
-			("ruthless,r", po::bool_switch(&st.ruthless_mode), "enable Ruthless-specific filter logic")
-			// warning/error/debug
-			("stop-on-error", po::bool_switch(&st.error_handling.stop_on_error),
-				"stop on first error")
-			("warning-is-error", po::bool_switch(&st.error_handling.treat_warnings_as_errors),
-				"treat warnings as errors")
-			("print-ast,p", po::bool_switch(&st.print_ast), "print abstract syntax tree (for debug purposes)")
-			// color modifications
-			("show-opacity-min", po::value(&st.overrides.color.show_opacity_min)->value_name("<0...255>"), "")
-			("show-opacity-max", po::value(&st.overrides.color.show_opacity_max)->value_name("<0...255>"), "")
-			("hide-opacity-min", po::value(&st.overrides.color.hide_opacity_min)->value_name("<0...255>"), "")
-			("hide-opacity-max", po::value(&st.overrides.color.hide_opacity_max)->value_name("<0...255>"),
-				fs::lang::color_overrides::help_opacity)
-			("opacity-all-color-actions", po::bool_switch(&st.overrides.color.override_all_actions),
-				fs::lang::color_overrides::help_override_all_actions)
-			// font modifications
-			("show-font-size-min", po::value(&st.overrides.font.show_size_min)->value_name("<1...45>"), "")
-			("show-font-size-max", po::value(&st.overrides.font.show_size_max)->value_name("<1...45>"), "")
-			("hide-font-size-min", po::value(&st.overrides.font.hide_size_min)->value_name("<1...45>"), "")
-			("hide-font-size-max", po::value(&st.overrides.font.hide_size_max)->value_name("<1...45>"),
-				fs::lang::font_overrides::help_font_size)
+			("template-cache", po::value(&template_cache_dir)->value_name("DIRPATH"),
+				"save compiled filter template in DIRPATH and reuse it while the template and settings are unchanged")
 		;
-		// assert correctness of numbers in command-line help
-		static_assert(fs::lang::constants::min_filter_font_size ==  1);
-		static_assert(fs::lang::constants::max_filter_font_size == 45);
+		add_filter_settings_options(generation_options, cli_entry.st);
 
 		boost::optional<std::string> input_path;
 		boost::optional<std::string> output_path;
-		constexpr auto input_path_str = "input-path";
-		constexpr auto output_path_str = "output-path";
 		po::options_description positional_options = make_options("positional arguments required by -g (argument names not required)");
-		positional_options.add_options()
-			(input_path_str,  po::value(&input_path)->value_name("FILEPATH"),  "FILEPATH to filter template file")
-			(output_path_str, po::value(&output_path)->value_name("FILEPATH"), "FILEPATH where to generate the filter")
-		;
+		add_path_options(positional_options, input_path, output_path);
 
 		bool opt_list_leagues = false;
 		bool opt_help = false;
 		bool opt_version = false;
 		boost::optional<std::string> info_path;
 		std::vector<std::string> compare_paths;
+		boost::optional<std::string> batch_path;
 		po::options_description generic_options = make_options("generic options (use 1)");
 		generic_options.add_options()
 			("list-leagues,l", po::bool_switch(&opt_list_leagues), "list leagues available for data download")
@@ -164,6 +277,11 @@ int run(int argc, char* argv[])
 			("info,i",         po::value(&info_path)->value_name("DIRPATH"), "show information about given item price data save")
 			("compare,c",      po::value(&compare_paths)->multitoken()->value_name("DIRPATH DIRPATH"),
 				"compare single-property items (cards, oils, scarabs, fossils, ...) in 2 price data saves")
+			("batch",          po::value(&batch_path)->value_name("FILEPATH"),
+				"generate all item filters listed in manifest FILEPATH - each line: <data_obtaining_option> "
+				"[generation_option]... input_path output_path (paths relative to manifest directory, # comments out a line); "
+				"data and templates are loaded once, filters are generated in parallel; "
+				"of generation options only --template-cache is allowed on the command line")
 		;
 
 		po::positional_options_description positional_options_description;
@@ -224,25 +342,56 @@ int run(int argc, char* argv[])
 			return compare_data_saves(compare_paths, logger);
 		}
 
+		if (batch_path) {
+			// options of a single filter are given per manifest line, do not silently ignore them
+			for (const po::options_description* options : {&data_obtaining_options, &generation_options, &positional_options}) {
+				for (const auto& option : options->options()) {
+					const std::string& name = option->long_name();
+					if (name == "template-cache")
+						continue;
+
+					const auto it = vm.find(name);
+					if (it != vm.end() && !it->second.defaulted()) {
+						logger.error() << "option --" << name
+							<< " can not be used with --batch, specify it in manifest lines instead\n";
+						return EXIT_FAILURE;
+					}
+				}
+			}
+
+			const std::optional<std::vector<batch_entry>> entries = load_batch_manifest(*batch_path, logger);
+			if (!entries)
+				return EXIT_FAILURE;
+
+			if (!generate_item_filters_batch(
+				*entries, template_cache_dir, boost::posix_time::minutes(max_age), download_settings, logger))
+			{
+				logger.info() << "Filter generation failed.\n";
+				return EXIT_FAILURE;
+			}
+
+			return EXIT_SUCCESS;
+		}
+
 		const auto item_price_report = [&]() -> std::optional<fs::lang::market::item_price_report> {
-			if (opt_empty_data) {
+			if (cli_entry.empty_data) {
 				// user explicitly stated to use empty data, some find it useful
 				// to write SSF filters where price queries are not used
 				return fs::lang::market::item_price_report();
 			}
 			else {
 				return obtain_item_price_report(
-					download_league_name_ninja,
-					download_league_name_watch,
+					cli_entry.download_league_name_ninja,
+					cli_entry.download_league_name_watch,
 					boost::posix_time::minutes(max_age),
 					download_settings,
-					data_read_dir,
+					cli_entry.data_read_dir,
 					logger);
 			}
 		}();
 
 		if (opt_generate) {
-			if (!generate_item_filter(item_price_report, input_path, output_path, st, logger)) {
+			if (!generate_item_filter(item_price_report, input_path, output_path, template_cache_dir, cli_entry.st, logger)) {
 				logger.info() << "Filter generation failed.\n";
 				return EXIT_FAILURE;
 			}
@@ -157,9 +157,9 @@ void application::draw_main_menu_bar()
 			ImGui::Separator();
 
 			if (ImGui::MenuItem(str_spirit_filter_from_text_input))
-				_filters.push_back(spirit_filter_window_from_text_input(_network_cache));
+				_filters.push_back(spirit_filter_window_from_text_input(_network_cache, _thread_pool));
 			if (ImGui::MenuItem(str_real_filter_from_text_input))
-				_filters.push_back(real_filter_window_from_text_input());
+				_filters.push_back(real_filter_window_from_text_input(_thread_pool));
 
 			ImGui::Separator();
 
@@ -342,19 +342,19 @@ void application::process_open_file_modals()
 		if (_modal_dialog_state == modal_dialog_state_type::open_spirit_filter) {
 #ifdef __EMSCRIPTEN__
 			if (result.file_name && result.file_content)
-				_filters.push_back(spirit_filter_window_from_source(_network_cache, *result.file_name, *result.file_content));
+				_filters.push_back(spirit_filter_window_from_source(_network_cache, _thread_pool, *result.file_name, *result.file_content));
 #else
 			if (result.file_path)
-				_filters.push_back(spirit_filter_window_from_file(_network_cache, *result.file_path));
+				_filters.push_back(spirit_filter_window_from_file(_network_cache, _thread_pool, *result.file_path));
 #endif
 		}
 		else if (_modal_dialog_state == modal_dialog_state_type::open_real_filter) {
 #ifdef __EMSCRIPTEN__
 			if (result.file_name && result.file_content)
-				_filters.push_back(real_filter_window_from_source(*result.file_name, *result.file_content));
+				_filters.push_back(real_filter_window_from_source(_thread_pool, *result.file_name, *result.file_content));
 #else
 			if (result.file_path)
-				_filters.push_back(real_filter_window_from_file(*result.file_path));
+				_filters.push_back(real_filter_window_from_file(_thread_pool, *result.file_path));
 #endif
 		}
 
@@ -11,6 +11,7 @@
 #include <fs/lang/loot/item_database.hpp>
 #include <fs/lang/loot/generator.hpp>
 #include <fs/network/item_price_report.hpp>
+#include <fs/utility/thread_pool.hpp>
 
 #include <Magnum/ImGuiIntegration/Context.hpp>
 
@@ -72,6 +73,9 @@ private:
 
 	network::cache _network_cache;
 
+	// Application-global, shared by all filter windows for loot filtering and autogeneration.
+	utility::thread_pool _thread_pool;
+
 	bool _show_demo_window = false;
 	bool _force_focus_demo_window = false;
 
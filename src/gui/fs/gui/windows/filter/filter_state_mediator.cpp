@@ -29,6 +29,13 @@ void filter_state_mediator::new_filter_representation(std::optional<lang::item_f
 	on_filter_representation_change(filter_representation());
 }
 
+std::optional<lang::item_filter> filter_state_mediator::release_filter_representation()
+{
+	std::optional<lang::item_filter> result = std::move(_filter_representation);
+	_filter_representation.reset();
+	return result;
+}
+
 void filter_state_mediator::on_filter_representation_change(const lang::item_filter* filter_representation)
 {
 	if (filter_representation)
@@ -126,7 +133,7 @@ void filter_state_mediator::draw_interface_loot(
 
 		FS_ASSERT(_source.source() != nullptr);
 
-		_loot_state.update_items(*_filter_representation);
+		_loot_state.update_items(*_filter_representation, parallel_work());
 		_loot_state.draw_interface(fonting, db, gen, *this);
 	}
 }
@@ -5,6 +5,7 @@
 #include <fs/gui/windows/filter/debug_state.hpp>
 #include <fs/gui/gui_logger.hpp>
 #include <fs/lang/item_filter.hpp>
+#include <fs/utility/parallel_settings.hpp>
 
 #include <optional>
 #include <string>
@@ -27,7 +28,10 @@ struct gui_settings;
 class filter_state_mediator
 {
 public:
-	filter_state_mediator() = default;
+	explicit filter_state_mediator(utility::thread_pool& pool)
+	: _thread_pool(&pool)
+	{
+	}
 
 	virtual ~filter_state_mediator() = default;
 
@@ -61,6 +65,12 @@ public:
 	// template method pattern
 	virtual const parser::parse_metadata* parse_metadata() const = 0;
 
+	// for work which can be split across threads
+	utility::parallel_settings parallel_work() const
+	{
+		return utility::parallel_settings{_thread_pool};
+	}
+
 	const lang::item_filter* filter_representation() const
 	{
 		return _filter_representation.has_value() ? &*_filter_representation : nullptr;
@@ -84,6 +94,8 @@ protected:
 	virtual void draw_interface_derived(const network_settings& networking, network::cache& cache) = 0;
 
 	void new_filter_representation(std::optional<lang::item_filter> filter_representation);
+	// moves the representation out (leaving none) so that it can be updated and set again
+	std::optional<lang::item_filter> release_filter_representation();
 
 private:
 	void draw_interface_filter_representation();
@@ -93,6 +105,7 @@ private:
 		const lang::loot::item_database& db,
 		lang::loot::generator& gen);
 
+	utility::thread_pool* _thread_pool; // never null, pointer to keep the type movable
 	source_state _source; // first step
 	// << possible intermediate data in derived types >>
 	std::optional<lang::item_filter> _filter_representation;
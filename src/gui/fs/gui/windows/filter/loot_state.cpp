@@ -10,12 +10,14 @@
 #include <fs/lang/loot/item_database.hpp>
 #include <fs/lang/loot/generator.hpp>
 #include <fs/utility/assert.hpp>
+#include <fs/utility/thread_pool.hpp>
 
 #include <imgui.h>
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <vector>
 
 namespace {
 
@@ -731,15 +733,22 @@ void loot_state::clear_filter_results(filter_state_mediator& mediator)
 	mediator.on_filter_results_clear();
 }
 
-void loot_state::update_items(const lang::item_filter& filter)
+void loot_state::update_items(const lang::item_filter& filter, utility::parallel_settings settings)
 {
+	std::vector<looted_item*> unfiltered_items;
 	for (looted_item& itm : _items) {
-		if (!itm.filtering_result) {
-			itm.filtering_result = lang::pass_item_through_filter(itm.itm, filter, _area_level);
+		if (!itm.filtering_result)
+			unfiltered_items.push_back(&itm);
+	}
 
-			if (!(*itm.filtering_result).style.visibility.show)
-				++_num_hidden_items;
-		}
+	utility::parallel_for(unfiltered_items.size(), settings, [&, area_level = _area_level](std::size_t i) {
+		looted_item& itm = *unfiltered_items[i];
+		itm.filtering_result = lang::pass_item_through_filter(itm.itm, filter, area_level);
+	});
+
+	for (const looted_item* itm : unfiltered_items) {
+		if (!(*itm->filtering_result).style.visibility.show)
+			++_num_hidden_items;
 	}
 }
 
@@ -747,9 +756,11 @@ void loot_state::refilter_items(const lang::item_filter& filter, filter_state_me
 {
 	_num_hidden_items = 0;
 
-	for (looted_item& itm : _items) {
-		itm.filtering_result = lang::pass_item_through_filter(itm.itm, filter, _area_level);
+	utility::parallel_for(_items.size(), mediator.parallel_work(), [&, area_level = _area_level](std::size_t i) {
+		_items[i].filtering_result = lang::pass_item_through_filter(_items[i].itm, filter, area_level);
+	});
 
+	for (const looted_item& itm : _items) {
 		if (!(*itm.filtering_result).style.visibility.show)
 			++_num_hidden_items;
 	}
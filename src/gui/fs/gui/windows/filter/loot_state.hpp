@@ -150,7 +150,7 @@ public:
 		lang::loot::generator& gen,
 		filter_state_mediator& mediator);
 
-	void update_items(const lang::item_filter& filter); // apply filter to items without style
+	void update_items(const lang::item_filter& filter, utility::parallel_settings settings); // apply filter to items without style
 	void refilter_items(const lang::item_filter& filter, filter_state_mediator& mediator); // apply filter to every item
 	void clear_items(filter_state_mediator& mediator);
 	void clear_filter_results(filter_state_mediator& mediator);
@@ -56,8 +56,8 @@ void market_data_state::refresh_item_price_report(
 	spirit_filter_state_mediator& mediator)
 {
 	if (!_selected_league) {
-		_price_report = {};
-		mediator.on_price_report_change(_price_report);
+		new_price_report({});
+		mediator.on_price_report_change(_price_report, _price_indexes);
 		return;
 	}
 
@@ -65,8 +65,8 @@ void market_data_state::refresh_item_price_report(
 	std::optional<lang::market::item_price_report> opt_price_report = cache.find_in_memory_cache(
 		*_selected_league, _selected_api, max_market_data_age);
 	if (opt_price_report) {
-		_price_report = std::move(*opt_price_report);
-		mediator.on_price_report_change(_price_report);
+		new_price_report(std::move(*opt_price_report));
+		mediator.on_price_report_change(_price_report, _price_indexes);
 		return;
 	}
 
@@ -92,6 +92,12 @@ void market_data_state::refresh_item_price_report(
 	_price_report_download_running = true;
 }
 
+void market_data_state::new_price_report(lang::market::item_price_report report)
+{
+	_price_report = std::move(report);
+	_price_indexes = lang::market::item_price_indexes(_price_report.data);
+}
+
 void market_data_state::refresh_available_leagues(const network_settings& settings, spirit_filter_state_mediator& mediator)
 {
 	if (_leagues_download_running)
@@ -136,7 +142,7 @@ void market_data_state::check_downloads(const network_settings& settings, networ
 	if (_price_report_download_running) {
 		if (utility::is_ready(_price_report_future)) {
 			try {
-				_price_report = _price_report_future.get();
+				new_price_report(_price_report_future.get());
 				mediator.logger().info() << "Market data download complete.\n";
 			}
 			catch (const std::exception& e) {
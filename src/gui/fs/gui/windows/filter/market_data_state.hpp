@@ -29,7 +29,15 @@ public:
 		return _price_report;
 	}
 
+	// built from price_report(), once per report
+	const lang::market::item_price_indexes& price_indexes() const
+	{
+		return _price_indexes;
+	}
+
 private:
+	void new_price_report(lang::market::item_price_report report);
+
 	void on_league_change(
 		const network_settings& settings,
 		network::item_price_report_cache& cache,
@@ -59,6 +67,7 @@ private:
 	std::optional<std::string> _selected_league;
 	std::vector<lang::league> _available_leagues;
 	lang::market::item_price_report _price_report;
+	lang::market::item_price_indexes _price_indexes;
 
 	bool _leagues_download_running = false;
 	std::shared_ptr<network::download_info> _leagues_download_info;
@@ -11,7 +11,10 @@ namespace fs::gui {
 class real_filter_state_mediator: public filter_state_mediator
 {
 public:
-	real_filter_state_mediator() = default;
+	explicit real_filter_state_mediator(utility::thread_pool& pool)
+	: filter_state_mediator(pool)
+	{
+	}
 
 	real_filter_state_mediator(real_filter_state_mediator&& other) noexcept = default;
 	real_filter_state_mediator& operator=(real_filter_state_mediator&& other) noexcept = default;
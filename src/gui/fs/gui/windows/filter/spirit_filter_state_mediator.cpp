@@ -130,24 +130,46 @@ void spirit_filter_state_mediator::new_spirit_filter(std::optional<lang::spirit_
 
 void spirit_filter_state_mediator::on_spirit_filter_change(const lang::spirit_item_filter* spirit_filter)
 {
-	refresh_filter_representation(spirit_filter, price_report().data);
+	make_filter_representation(spirit_filter, price_report().data, price_indexes());
 }
 
-void spirit_filter_state_mediator::on_price_report_change(const lang::market::item_price_report& report)
+void spirit_filter_state_mediator::on_price_report_change(
+	const lang::market::item_price_report& report,
+	const lang::market::item_price_indexes& price_indexes)
 {
-	refresh_filter_representation(spirit_filter(), report.data);
+	refresh_filter_representation(spirit_filter(), report.data, price_indexes);
 }
 
-void spirit_filter_state_mediator::refresh_filter_representation(
+void spirit_filter_state_mediator::make_filter_representation(
 	const lang::spirit_item_filter* spirit_filter,
-	const lang::market::item_price_data& item_price_data)
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes)
 {
 	if (!spirit_filter) {
 		new_filter_representation(std::nullopt);
 		return;
 	}
 
-	new_filter_representation(compiler::make_item_filter(*spirit_filter, item_price_data));
+	new_filter_representation(compiler::make_item_filter(
+		compiler::materialize_item_filter(*spirit_filter, item_price_data, price_indexes, parallel_work()), _filter_layout));
+}
+
+void spirit_filter_state_mediator::refresh_filter_representation(
+	const lang::spirit_item_filter* spirit_filter,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes)
+{
+	// the representation (if any) is made from the current spirit filter,
+	// only autogen blocks depend on item prices - keep static blocks
+	std::optional<lang::item_filter> filter = release_filter_representation();
+	if (!spirit_filter || !filter) {
+		make_filter_representation(spirit_filter, item_price_data, price_indexes);
+		return;
+	}
+
+	compiler::refresh_item_filter(
+		*filter, _filter_layout, compiler::materialize_item_filter(*spirit_filter, item_price_data, price_indexes, parallel_work()));
+	new_filter_representation(std::move(filter));
 }
 
 void spirit_filter_state_mediator::draw_interface_derived(const network_settings& networking, network::cache& cache)
@@ -2,6 +2,7 @@
 
 #include <fs/gui/windows/filter/filter_state_mediator.hpp>
 #include <fs/gui/windows/filter/market_data_state.hpp>
+#include <fs/compiler/compiler.hpp>
 #include <fs/compiler/symbol_table.hpp>
 #include <fs/parser/parser.hpp>
 #include <fs/lang/item_filter.hpp>
@@ -17,8 +18,9 @@ namespace fs::gui {
 class spirit_filter_state_mediator: public filter_state_mediator
 {
 public:
-	spirit_filter_state_mediator(std::vector<lang::league> available_leagues)
-	: _market_data(std::move(available_leagues))
+	spirit_filter_state_mediator(utility::thread_pool& pool, std::vector<lang::league> available_leagues)
+	: filter_state_mediator(pool)
+	, _market_data(std::move(available_leagues))
 	, _logger_ptr(std::make_shared<log::thread_safe_logger<log::buffer_logger>>())
 	{
 	}
@@ -43,7 +45,8 @@ public:
 	void on_spirit_filter_change(
 		const lang::spirit_item_filter* spirit_filter);
 	void on_price_report_change(
-		const lang::market::item_price_report& report);
+		const lang::market::item_price_report& report,
+		const lang::market::item_price_indexes& price_indexes);
 
 	const parser::parsed_spirit_filter* parsed_spirit_filter() const
 	{
@@ -67,14 +70,24 @@ public:
 		return _market_data.price_report();
 	}
 
+	const lang::market::item_price_indexes& price_indexes() const
+	{
+		return _market_data.price_indexes();
+	}
+
 private:
 	void new_parsed_spirit_filter(std::optional<parser::parsed_spirit_filter> parsed_spirit_filter);
 	void new_spirit_filter_symbols(std::optional<compiler::symbol_table> spirit_filter_symbols);
 	void new_spirit_filter(std::optional<lang::spirit_item_filter> spirit_filter);
 
+	void make_filter_representation(
+		const lang::spirit_item_filter* spirit_filter,
+		const lang::market::item_price_data& item_price_data,
+		const lang::market::item_price_indexes& price_indexes);
 	void refresh_filter_representation(
 		const lang::spirit_item_filter* spirit_filter,
-		const lang::market::item_price_data& item_price_data);
+		const lang::market::item_price_data& item_price_data,
+		const lang::market::item_price_indexes& price_indexes);
 
 	void draw_interface_derived(const network_settings& networking, network::cache& cache) override;
 	void draw_interface_save_filter(const lang::item_filter& filter, log::logger& logger) override;
@@ -87,6 +100,8 @@ private:
 	std::optional<parser::parsed_spirit_filter> _parsed_spirit_filter;
 	std::optional<compiler::symbol_table> _spirit_filter_symbols;
 	std::optional<lang::spirit_item_filter> _spirit_filter;
+	// where generated blocks are in the filter representation, price changes replace only them
+	compiler::item_filter_layout _filter_layout;
 	market_data_state _market_data;
 	std::shared_ptr<log::thread_safe_logger<log::buffer_logger>> _logger_ptr;
 };
@@ -40,64 +40,65 @@ std::string make_title(const source_state& state, const char* text_input_title)
 namespace fs::gui {
 
 #ifndef __EMSCRIPTEN__
-std::unique_ptr<filter_window> real_filter_window_from_file(std::string path)
+std::unique_ptr<filter_window> real_filter_window_from_file(utility::thread_pool& pool, std::string path)
 {
-	return std::make_unique<real_filter_window>(real_filter_window::from_file(std::move(path)));
+	return std::make_unique<real_filter_window>(real_filter_window::from_file(pool, std::move(path)));
 }
 
-std::unique_ptr<filter_window> spirit_filter_window_from_file(const network::cache& network_cache, std::string path)
+std::unique_ptr<filter_window> spirit_filter_window_from_file(const network::cache& network_cache, utility::thread_pool& pool, std::string path)
 {
-	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_file(network_cache, std::move(path)));
+	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_file(network_cache, pool, std::move(path)));
 }
 #endif
 
-std::unique_ptr<filter_window> real_filter_window_from_text_input()
+std::unique_ptr<filter_window> real_filter_window_from_text_input(utility::thread_pool& pool)
 {
-	return std::make_unique<real_filter_window>(real_filter_window::from_text_input());
+	return std::make_unique<real_filter_window>(real_filter_window::from_text_input(pool));
 }
 
-std::unique_ptr<filter_window> spirit_filter_window_from_text_input(const network::cache& network_cache)
+std::unique_ptr<filter_window> spirit_filter_window_from_text_input(const network::cache& network_cache, utility::thread_pool& pool)
 {
-	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_text_input(network_cache));
+	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_text_input(network_cache, pool));
 }
 
-std::unique_ptr<filter_window> real_filter_window_from_source(std::string name, std::string source)
+std::unique_ptr<filter_window> real_filter_window_from_source(utility::thread_pool& pool, std::string name, std::string source)
 {
-	return std::make_unique<real_filter_window>(real_filter_window::from_source(std::move(name), std::move(source)));
+	return std::make_unique<real_filter_window>(real_filter_window::from_source(pool, std::move(name), std::move(source)));
 }
 
-std::unique_ptr<filter_window> spirit_filter_window_from_source(const network::cache& network_cache, std::string name, std::string source)
+std::unique_ptr<filter_window> spirit_filter_window_from_source(const network::cache& network_cache, utility::thread_pool& pool, std::string name, std::string source)
 {
-	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_source(network_cache, std::move(name), std::move(source)));
+	return std::make_unique<spirit_filter_window>(spirit_filter_window::from_source(network_cache, pool, std::move(name), std::move(source)));
 }
 
 filter_window::filter_window()
 : imgui_window({}, drawable_area_size()) {}
 
-real_filter_window::real_filter_window()
+real_filter_window::real_filter_window(utility::thread_pool& pool)
+: _state(pool)
 {
 	open();
 }
 
 #ifndef __EMSCRIPTEN__
-real_filter_window real_filter_window::from_file(std::string path)
+real_filter_window real_filter_window::from_file(utility::thread_pool& pool, std::string path)
 {
-	real_filter_window window;
+	real_filter_window window(pool);
 	window._state.load_source_file(std::move(path));
 	return window;
 }
 #endif
 
-real_filter_window real_filter_window::from_text_input()
+real_filter_window real_filter_window::from_text_input(utility::thread_pool& pool)
 {
-	real_filter_window window;
+	real_filter_window window(pool);
 	window._state.open_text_input();
 	return window;
 }
 
-real_filter_window real_filter_window::from_source(std::string name, std::string source)
+real_filter_window real_filter_window::from_source(utility::thread_pool& pool, std::string name, std::string source)
 {
-	real_filter_window window;
+	real_filter_window window(pool);
 	window._state.new_source(std::move(source));
 	window._state.source().name(std::move(name));
 	return window;
@@ -113,31 +114,31 @@ void real_filter_window::draw_impl(
 	_state.draw(settings, db, gen, network_cache);
 }
 
-spirit_filter_window::spirit_filter_window(const network::cache& network_cache)
-: _state(network_cache.leagues.get_leagues())
+spirit_filter_window::spirit_filter_window(const network::cache& network_cache, utility::thread_pool& pool)
+: _state(pool, network_cache.leagues.get_leagues())
 {
 	open();
 }
 
 #ifndef __EMSCRIPTEN__
-spirit_filter_window spirit_filter_window::from_file(const network::cache& network_cache, std::string path)
+spirit_filter_window spirit_filter_window::from_file(const network::cache& network_cache, utility::thread_pool& pool, std::string path)
 {
-	spirit_filter_window window(network_cache);
+	spirit_filter_window window(network_cache, pool);
 	window._state.load_source_file(std::move(path));
 	return window;
 }
 #endif
 
-spirit_filter_window spirit_filter_window::from_text_input(const network::cache& network_cache)
+spirit_filter_window spirit_filter_window::from_text_input(const network::cache& network_cache, utility::thread_pool& pool)
 {
-	spirit_filter_window window(network_cache);
+	spirit_filter_window window(network_cache, pool);
 	window._state.open_text_input();
 	return window;
 }
 
-spirit_filter_window spirit_filter_window::from_source(const network::cache& network_cache, std::string name, std::string source)
+spirit_filter_window spirit_filter_window::from_source(const network::cache& network_cache, utility::thread_pool& pool, std::string name, std::string source)
 {
-	spirit_filter_window window(network_cache);
+	spirit_filter_window window(network_cache, pool);
 	window._state.new_source(std::move(source));
 	window._state.source().name(std::move(name));
 	return window;
@@ -12,10 +12,10 @@ class real_filter_window : public filter_window
 {
 public:
 #ifndef __EMSCRIPTEN__
-	static real_filter_window from_file(std::string path);
+	static real_filter_window from_file(utility::thread_pool& pool, std::string path);
 #endif
-	static real_filter_window from_text_input();
-	static real_filter_window from_source(std::string name, std::string source);
+	static real_filter_window from_text_input(utility::thread_pool& pool);
+	static real_filter_window from_source(utility::thread_pool& pool, std::string name, std::string source);
 
 	void draw_impl(
 		const gui_settings& settings,
@@ -24,7 +24,7 @@ public:
 		network::cache& network_cache) override;
 
 private:
-	real_filter_window();
+	real_filter_window(utility::thread_pool& pool);
 
 	real_filter_state_mediator _state;
 };
@@ -33,10 +33,10 @@ class spirit_filter_window : public filter_window
 {
 public:
 #ifndef __EMSCRIPTEN__
-	static spirit_filter_window from_file(const network::cache& network_cache, std::string path);
+	static spirit_filter_window from_file(const network::cache& network_cache, utility::thread_pool& pool, std::string path);
 #endif
-	static spirit_filter_window from_text_input(const network::cache& network_cache);
-	static spirit_filter_window from_source(const network::cache& network_cache, std::string name, std::string source);
+	static spirit_filter_window from_text_input(const network::cache& network_cache, utility::thread_pool& pool);
+	static spirit_filter_window from_source(const network::cache& network_cache, utility::thread_pool& pool, std::string name, std::string source);
 
 	void draw_impl(
 		const gui_settings& settings,
@@ -45,7 +45,7 @@ public:
 		network::cache& network_cache) override;
 
 private:
-	spirit_filter_window(const network::cache& network_cache);
+	spirit_filter_window(const network::cache& network_cache, utility::thread_pool& pool);
 
 	spirit_filter_state_mediator _state;
 };
@@ -14,6 +14,8 @@ class generator;
 
 namespace fs::network { struct cache; }
 
+namespace fs::utility { class thread_pool; }
+
 namespace fs::gui {
 
 constexpr auto str_real_filter_from_text_input = "Real filter - from text input";
@@ -48,13 +50,13 @@ protected:
 };
 
 #ifndef __EMSCRIPTEN__
-std::unique_ptr<filter_window> real_filter_window_from_file(std::string path);
-std::unique_ptr<filter_window> spirit_filter_window_from_file(const network::cache& network_cache, std::string path);
+std::unique_ptr<filter_window> real_filter_window_from_file(utility::thread_pool& pool, std::string path);
+std::unique_ptr<filter_window> spirit_filter_window_from_file(const network::cache& network_cache, utility::thread_pool& pool, std::string path);
 #endif
 
-std::unique_ptr<filter_window> real_filter_window_from_text_input();
-std::unique_ptr<filter_window> spirit_filter_window_from_text_input(const network::cache& network_cache);
-std::unique_ptr<filter_window> real_filter_window_from_source(std::string name, std::string source);
-std::unique_ptr<filter_window> spirit_filter_window_from_source(const network::cache& network_cache, std::string name, std::string source);
+std::unique_ptr<filter_window> real_filter_window_from_text_input(utility::thread_pool& pool);
+std::unique_ptr<filter_window> spirit_filter_window_from_text_input(const network::cache& network_cache, utility::thread_pool& pool);
+std::unique_ptr<filter_window> real_filter_window_from_source(utility::thread_pool& pool, std::string name, std::string source);
+std::unique_ptr<filter_window> spirit_filter_window_from_source(const network::cache& network_cache, utility::thread_pool& pool, std::string name, std::string source);
 
 }
@@ -8,19 +8,26 @@
 #include <fs/lang/item_filter.hpp>
 #include <fs/lang/item.hpp>
 #include <fs/lang/keywords.hpp>
+#include <fs/lang/unreachable_blocks.hpp>
+#include <fs/lang/merge_blocks.hpp>
 #include <fs/log/structure_printer.hpp>
 #include <fs/utility/assert.hpp>
 #include <fs/utility/string_helpers.hpp>
 #include <fs/utility/monadic.hpp>
+#include <fs/utility/thread_pool.hpp>
 #include <fs/utility/visitor.hpp>
 #include <fs/version.hpp>
 
 #include <boost/spirit/home/x3/support/utility/lambda_visitor.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <optional>
 #include <sstream>
+#include <variant>
+#include <vector>
 
 namespace fs::compiler {
 
@@ -177,7 +184,8 @@ make_spirit_filter_block(
 		if (!func)
 			return boost::none;
 
-		result_autogen = lang::autogen_extension{std::move(func), conditions.price_range, autogen.origin};
+		result_autogen = lang::autogen_extension{
+			std::move(func), conditions.price_range, autogen.category, autogen.origin};
 	}
 
 	return lang::spirit_item_filter_block{
@@ -322,6 +330,12 @@ compile_statements_recursively_impl(
 				if (!block)
 					return false;
 
+				// Nested blocks inherit conditions of their parents, these can overlap
+				// (e.g. ItemLevel >= 60 and ItemLevel 75 86) or contradict each other.
+				// Contradicting blocks can never match anything, do not output them.
+				if (!lang::normalize_conditions((*block).block.conditions))
+					return true;
+
 				blocks.push_back(lang::spirit_block_variant(std::move(*block)));
 				return true;
 			},
@@ -422,7 +436,34 @@ R"(# autogenerated by Filter Spirit - an advanced item filter generator for Path
 	return preamble;
 }
 
-std::optional<lang::spirit_item_filter> parse_and_compile_spirit_filter(
+void remove_trailing_linebreak(std::string& filter)
+{
+	// Each Condition/Action/etc. adds a newline after itself.
+	// Additionally, each Block also adds a newline after itself to separate blocks with 1 empty line.
+	// If filter is non-empty, this means there are 2 linebreaks after the last line.
+	// Remove one, as text editing tools expect a single trailing newline and to ease committing test files.
+	if (utility::ends_with(filter, "\n\n"))
+		filter.resize(filter.size() - 1);
+}
+
+} // namespace
+
+std::optional<lang::spirit_item_filter>
+parse_and_compile_spirit_filter(
+	std::string_view input,
+	settings st,
+	log::logger& logger)
+{
+	std::optional<spirit_filter_compilation> result = parse_and_compile_spirit_filter_with_metadata(input, st, logger);
+
+	if (!result)
+		return std::nullopt;
+
+	return std::move((*result).filter);
+}
+
+std::optional<spirit_filter_compilation>
+parse_and_compile_spirit_filter_with_metadata(
 	std::string_view input,
 	settings st,
 	log::logger& logger)
@@ -436,17 +477,17 @@ std::optional<lang::spirit_item_filter> parse_and_compile_spirit_filter(
 	}
 
 	logger.info() << "Parse successful.\n";
-	const auto& parse_data = std::get<parser::parsed_spirit_filter>(parse_result);
+	auto& parse_data = std::get<parser::parsed_spirit_filter>(parse_result);
 
 	if (st.print_ast)
 		log::structure_printer()(parse_data.ast);
 
 	logger.info() << "Resolving filter template symbols...\n";
 
-	diagnostics_store diagnostics_symbols;
+	diagnostics_store diagnostics;
 	const std::optional<symbol_table> symbols =
-		resolve_spirit_filter_symbols(st, parse_data.ast.definitions, diagnostics_symbols);
-	diagnostics_symbols.output_messages(parse_data.metadata, logger);
+		resolve_spirit_filter_symbols(st, parse_data.ast.definitions, diagnostics);
+	diagnostics.output_messages(parse_data.metadata, logger);
 
 	if (!symbols)
 		return std::nullopt;
@@ -459,10 +500,12 @@ std::optional<lang::spirit_item_filter> parse_and_compile_spirit_filter(
 		compile_spirit_filter_statements(st, parse_data.ast.statements, *symbols, diagnostics_spirit_filter);
 	diagnostics_spirit_filter.output_messages(parse_data.metadata, logger);
 
-	return spirit_filter;
-}
+	if (!spirit_filter)
+		return std::nullopt;
 
-} // namespace
+	diagnostics.move_messages_from(diagnostics_spirit_filter);
+	return spirit_filter_compilation{std::move(*spirit_filter), std::move(diagnostics), std::move(parse_data.metadata)};
+}
 
 // placed in this file to reuse code and avoid creating symbol_table.cpp for just 1 function
 bool
@@ -606,57 +649,262 @@ compile_spirit_filter_statements(
 	return lang::spirit_item_filter{st.ruthless_mode, std::move(*blocks)};
 }
 
-lang::item_filter
-make_item_filter(
+lang::market::item_price_indexes
+make_item_price_indexes(
 	const lang::spirit_item_filter& filter_template,
 	const lang::market::item_price_data& item_price_data)
 {
-	std::vector<lang::block_variant> result_blocks;
-	result_blocks.reserve(filter_template.blocks.size());
+	// templates usually have autogen blocks of only a few categories, often repeated
+	std::vector<bool> is_built(lang::autogen_category::_size(), false);
+	lang::market::item_price_indexes result;
+
+	for (const lang::spirit_block_variant& block_variant : filter_template.blocks) {
+		const auto* const block = std::get_if<lang::spirit_item_filter_block>(&block_variant);
+		if (block == nullptr || !block->autogen)
+			continue;
+
+		const lang::autogen_category category = (*block->autogen).category;
+		if (is_built[category._to_index()])
+			continue;
+
+		result.build(item_price_data, category);
+		is_built[category._to_index()] = true;
+	}
+
+	return result;
+}
+
+materialized_item_filter
+materialize_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	utility::parallel_settings settings)
+{
+	return materialize_item_filter(
+		filter_template, item_price_data, make_item_price_indexes(filter_template, item_price_data), settings);
+}
+
+materialized_item_filter
+materialize_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	utility::parallel_settings settings)
+{
+	materialized_item_filter result{filter_template.is_ruthless, {}};
+	result.parts.reserve(filter_template.blocks.size());
 
+	std::vector<std::size_t> autogen_part_indexes;
 	for (const lang::spirit_block_variant& block_variant : filter_template.blocks) {
 		std::visit(utility::visitor{
 			[&](const lang::import_block& block) {
-				result_blocks.push_back(lang::block_variant(block));
+				result.parts.emplace_back(&block);
 			},
 			[&](const lang::spirit_item_filter_block& block) {
 				if (block.autogen) {
-					const auto& autogen = *block.autogen;
-
-					lang::block_generation_info block_gen_info{
-						block.block.visibility,
-						block.block.actions,
-						block.block.continuation,
-						autogen.origin,
-						autogen.price_range
-					};
-
-					autogen.blocks_generator(
-						block_gen_info, item_price_data, lang::generated_blocks_consumer{std::ref(result_blocks)});
+					autogen_part_indexes.push_back(result.parts.size());
+					result.parts.emplace_back(std::vector<lang::block_variant>());
 				}
 				else {
-					result_blocks.push_back(lang::block_variant(block.block));
+					result.parts.emplace_back(&block.block);
 				}
 			}
 		}, block_variant);
 	}
 
-	return lang::item_filter{filter_template.is_ruthless, std::move(result_blocks)};
+	// Autogen generators are independent of each other, run them (possibly
+	// concurrently) each into its own part. Parts keep template order, so the
+	// result does not depend on how generators were scheduled.
+	settings.chunk_size = 1; // each generator can produce a lot of blocks
+	utility::parallel_for(autogen_part_indexes.size(), settings, [&](std::size_t i) {
+		const std::size_t part_index = autogen_part_indexes[i];
+		const auto& block = std::get<lang::spirit_item_filter_block>(filter_template.blocks[part_index]);
+		const auto& autogen = *block.autogen;
+
+		lang::block_generation_info block_gen_info{
+			block.block.visibility,
+			block.block.actions,
+			block.block.continuation,
+			autogen.origin,
+			autogen.price_range
+		};
+
+		auto& generated_blocks = std::get<std::vector<lang::block_variant>>(result.parts[part_index]);
+		autogen.blocks_generator(
+			block_gen_info, item_price_data, price_indexes, lang::generated_blocks_consumer{std::ref(generated_blocks)});
+	});
+
+	return result;
 }
 
-std::string item_filter_to_string_without_preamble(const lang::item_filter& filter, lang::style_overrides overrides)
+lang::item_filter
+make_item_filter(materialized_item_filter filter)
+{
+	item_filter_layout layout;
+	return make_item_filter(std::move(filter), layout);
+}
+
+lang::item_filter
+make_item_filter(materialized_item_filter filter, item_filter_layout& layout)
+{
+	layout.part_sizes.clear();
+	layout.part_sizes.reserve(filter.parts.size());
+
+	std::size_t num_result_blocks = 0;
+	for (const materialized_item_filter::part& part : filter.parts) {
+		if (const auto* const generated_blocks = std::get_if<std::vector<lang::block_variant>>(&part); generated_blocks)
+			layout.part_sizes.push_back(generated_blocks->size());
+		else
+			layout.part_sizes.push_back(1);
+
+		num_result_blocks += layout.part_sizes.back();
+	}
+
+	std::vector<lang::block_variant> result_blocks;
+	result_blocks.reserve(num_result_blocks);
+
+	for (materialized_item_filter::part& part : filter.parts) {
+		std::visit(utility::visitor{
+			[&](const lang::item_filter_block* block) {
+				result_blocks.push_back(lang::block_variant(*block));
+			},
+			[&](const lang::import_block* block) {
+				result_blocks.push_back(lang::block_variant(*block));
+			},
+			[&](std::vector<lang::block_variant>& generated_blocks) {
+				std::move(generated_blocks.begin(), generated_blocks.end(), std::back_inserter(result_blocks));
+			}
+		}, part);
+	}
+
+	return lang::item_filter{filter.is_ruthless, std::move(result_blocks)};
+}
+
+void refresh_item_filter(lang::item_filter& filter, item_filter_layout& layout, materialized_item_filter next)
+{
+	FS_ASSERT(layout.part_sizes.size() == next.parts.size());
+	FS_ASSERT(filter.is_ruthless == next.is_ruthless);
+
+	std::size_t num_result_blocks = 0;
+	for (std::size_t i = 0; i < next.parts.size(); ++i) {
+		if (const auto* const generated_blocks = std::get_if<std::vector<lang::block_variant>>(&next.parts[i]); generated_blocks)
+			num_result_blocks += generated_blocks->size();
+		else
+			num_result_blocks += layout.part_sizes[i];
+	}
+
+	std::vector<lang::block_variant> result_blocks;
+	result_blocks.reserve(num_result_blocks);
+
+	auto previous_first = filter.blocks.begin();
+	for (std::size_t i = 0; i < next.parts.size(); ++i) {
+		const auto previous_last = previous_first + static_cast<std::ptrdiff_t>(layout.part_sizes[i]);
+		FS_ASSERT(previous_last <= filter.blocks.end());
+
+		if (auto* const generated_blocks = std::get_if<std::vector<lang::block_variant>>(&next.parts[i]); generated_blocks) {
+			layout.part_sizes[i] = generated_blocks->size();
+			std::move(generated_blocks->begin(), generated_blocks->end(), std::back_inserter(result_blocks));
+		}
+		else {
+			FS_ASSERT(layout.part_sizes[i] == 1u);
+			std::move(previous_first, previous_last, std::back_inserter(result_blocks));
+		}
+
+		previous_first = previous_last;
+	}
+
+	FS_ASSERT(previous_first == filter.blocks.end());
+	filter.blocks = std::move(result_blocks);
+}
+
+lang::item_filter
+make_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	utility::parallel_settings settings)
 {
+	return make_item_filter(materialize_item_filter(filter_template, item_price_data, settings));
+}
+
+lang::item_filter
+make_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	utility::parallel_settings settings)
+{
+	return make_item_filter(materialize_item_filter(filter_template, item_price_data, price_indexes, settings));
+}
+
+prerendered_filter_template::prerendered_filter_template(
+	const lang::spirit_item_filter& filter_template,
+	lang::style_overrides overrides)
+: m_overrides(overrides)
+, m_is_ruthless(filter_template.is_ruthless)
+{
+	m_static_texts.reserve(filter_template.blocks.size());
+
+	for (const lang::spirit_block_variant& block_variant : filter_template.blocks) {
+		std::stringstream ss;
+		std::visit(utility::visitor{
+			[&](const lang::import_block& block) {
+				block.print(ss);
+			},
+			[&](const lang::spirit_item_filter_block& block) {
+				if (!block.autogen)
+					block.block.print(ss, m_overrides, m_is_ruthless);
+			}
+		}, block_variant);
+		m_static_texts.push_back(ss.str());
+	}
+}
+
+std::string prerendered_filter_template::to_string_without_preamble(const materialized_item_filter& filter) const
+{
+	FS_ASSERT(filter.parts.size() == m_static_texts.size());
+
 	std::stringstream ss;
-	filter.print(ss, overrides);
+	for (std::size_t i = 0; i < filter.parts.size(); ++i) {
+		const auto* const generated_blocks = std::get_if<std::vector<lang::block_variant>>(&filter.parts[i]);
+		if (generated_blocks == nullptr) {
+			ss << m_static_texts[i];
+			continue;
+		}
+
+		for (const lang::block_variant& block_variant : *generated_blocks) {
+			std::visit(utility::visitor{
+				[&](const lang::item_filter_block& block) { block.print(ss, m_overrides, m_is_ruthless); },
+				[&](const      lang::import_block& block) { block.print(ss); }
+			}, block_variant);
+		}
+	}
+
 	std::string result = ss.str();
+	remove_trailing_linebreak(result);
+	return result;
+}
 
-	// Each Condition/Action/etc. adds a newline after itself.
-	// Additionally, each Block also adds a newline after itself to separate blocks with 1 empty line.
-	// If filter is non-empty, this means there are 2 linebreaks after the last line.
-	// Remove one, as text editing tools expect a single trailing newline and to ease committing test files.
-	if (utility::ends_with(result, "\n\n"))
-		result.resize(result.size() - 1);
+std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const prerendered_filter_template& prerendered,
+	const lang::market::item_price_report& report,
+	const lang::market::item_price_indexes& price_indexes,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	std::string result = make_preamble(filter_template.is_ruthless, report.metadata)
+		+ prerendered.to_string_without_preamble(materialize_item_filter(filter_template, report.data, price_indexes, parallel));
+	logger.info() << "Compilation successful.\n";
+	return result;
+}
 
+std::string item_filter_to_string_without_preamble(const lang::item_filter& filter, lang::style_overrides overrides)
+{
+	std::stringstream ss;
+	filter.print(ss, overrides);
+	std::string result = ss.str();
+	remove_trailing_linebreak(result);
 	return result;
 }
 
@@ -669,11 +917,76 @@ item_filter_to_string_with_preamble(
 	return make_preamble(filter.is_ruthless, item_price_metadata) + item_filter_to_string_without_preamble(filter, overrides);
 }
 
+std::string
+generate_item_filter_without_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	return generate_item_filter_without_preamble(
+		filter_template, item_price_data, make_item_price_indexes(filter_template, item_price_data), st, logger, parallel);
+}
+
+std::string
+generate_item_filter_without_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	lang::item_filter filter = make_item_filter(filter_template, item_price_data, price_indexes, parallel);
+
+	if (st.remove_unreachable_blocks) {
+		const std::size_t num_removed = lang::remove_unreachable_blocks(filter).size();
+		logger.info() << "Removed " << num_removed << " block(s) which can never match any item.\n";
+	}
+
+	if (st.merge_blocks) {
+		const lang::block_merge_statistics stats = lang::merge_adjacent_blocks(filter);
+		logger.info() << "Merged " << stats.merged_blocks << " block(s) into adjacent ones, saved "
+			<< stats.saved_bytes << " bytes.\n";
+	}
+
+	logger.info() << "Compilation successful.\n";
+
+	return item_filter_to_string_without_preamble(filter, st.overrides);
+}
+
+std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_report& report,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	return make_preamble(filter_template.is_ruthless, report.metadata)
+		+ generate_item_filter_without_preamble(filter_template, report.data, st, logger, parallel);
+}
+
+std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_report& report,
+	const lang::market::item_price_indexes& price_indexes,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel)
+{
+	return make_preamble(filter_template.is_ruthless, report.metadata)
+		+ generate_item_filter_without_preamble(filter_template, report.data, price_indexes, st, logger, parallel);
+}
+
 std::optional<std::string> parse_compile_generate_spirit_filter_without_preamble(
 	std::string_view input,
 	const lang::market::item_price_data& item_price_data,
 	settings st,
-	log::logger& logger)
+	log::logger& logger,
+	utility::parallel_settings parallel)
 {
 	logger.info() << "" << item_price_data; // add << "" to workaround calling <<(rvalue, item_price_data)
 
@@ -682,20 +995,18 @@ std::optional<std::string> parse_compile_generate_spirit_filter_without_preamble
 	if (!spirit_filter)
 		return std::nullopt;
 
-	lang::item_filter filter = make_item_filter(*spirit_filter, item_price_data);
-	logger.info() << "Compilation successful.\n";
-
-	return item_filter_to_string_without_preamble(filter, st.overrides);
+	return generate_item_filter_without_preamble(*spirit_filter, item_price_data, st, logger, parallel);
 }
 
 std::optional<std::string> parse_compile_generate_spirit_filter_with_preamble(
 	std::string_view input,
 	const lang::market::item_price_report& report,
 	settings st,
-	log::logger& logger)
+	log::logger& logger,
+	utility::parallel_settings parallel)
 {
 	std::optional<std::string> maybe_filter =
-		parse_compile_generate_spirit_filter_without_preamble(input, report.data, st, logger);
+		parse_compile_generate_spirit_filter_without_preamble(input, report.data, st, logger, parallel);
 
 	if (!maybe_filter)
 		return std::nullopt;
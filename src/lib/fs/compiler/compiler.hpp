@@ -4,11 +4,17 @@
 #include <fs/lang/market/item_price_data.hpp>
 #include <fs/log/logger.hpp>
 #include <fs/parser/ast.hpp>
+#include <fs/parser/parser.hpp>
 #include <fs/compiler/settings.hpp>
 #include <fs/compiler/diagnostics.hpp>
 #include <fs/compiler/symbol_table.hpp>
+#include <fs/utility/parallel_settings.hpp>
 
+#include <cstddef>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace fs::compiler
@@ -38,11 +44,133 @@ compile_spirit_filter_statements(
 	const symbol_table& symbols,
 	diagnostics_store& diagnostics);
 
+// input_string => spirit_filter_representation
+// (parse, resolve symbols and compile, diagnostics are written to the logger)
+[[nodiscard]] std::optional<lang::spirit_item_filter>
+parse_and_compile_spirit_filter(
+	std::string_view input,
+	settings st,
+	log::logger& logger);
+
+struct spirit_filter_compilation
+{
+	lang::spirit_item_filter filter;
+	// messages which were written to the logger, kept to show them again (e.g. from cache)
+	diagnostics_store diagnostics;
+	// origins in both the filter and diagnostics refer to it, valid as long as the input is
+	parser::parse_metadata metadata;
+};
+
+// same as above but keeps everything needed to output diagnostics later
+[[nodiscard]] std::optional<spirit_filter_compilation>
+parse_and_compile_spirit_filter_with_metadata(
+	std::string_view input,
+	settings st,
+	log::logger& logger);
+
+// real filter blocks in the order of spirit filter blocks: static blocks refer to
+// the spirit_filter_representation (which must outlive this object) and
+// each autogen block is replaced by the blocks it generated
+struct materialized_item_filter
+{
+	using part = std::variant<
+		const lang::item_filter_block*,
+		const lang::import_block*,
+		std::vector<lang::block_variant>
+	>;
+
+	bool is_ruthless;
+	std::vector<part> parts; // 1 for each block of spirit_filter_representation
+};
+
+// price indexes of the categories used by autogen blocks of the template
+// (indexes of other categories are left empty)
+[[nodiscard]] lang::market::item_price_indexes
+make_item_price_indexes(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data);
+
+// spirit_filter_representation + item_price_data => materialized filter
+// (only autogen blocks are allocated, they are generated concurrently on
+// settings.pool if given - output is the same regardless of settings)
+[[nodiscard]] materialized_item_filter
+materialize_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	utility::parallel_settings settings = {});
+
+// as above, with indexes built by the owner of item_price_data (at least
+// those of categories used by the template) instead of building them here
+[[nodiscard]] materialized_item_filter
+materialize_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	utility::parallel_settings settings = {});
+
+// number of real filter blocks made from each block of spirit_filter_representation
+// (1 for static blocks), lets refresh_item_filter find generated blocks again
+struct item_filter_layout
+{
+	std::vector<std::size_t> part_sizes;
+};
+
+// materialized filter => real_filter_representation (copies static blocks)
+[[nodiscard]] lang::item_filter
+make_item_filter(materialized_item_filter filter);
+
+// as above, layout is overwritten with the layout of the result
+[[nodiscard]] lang::item_filter
+make_item_filter(materialized_item_filter filter, item_filter_layout& layout);
+
+// Price refresh: filter (with the given layout) must have been made from the same
+// spirit_filter_representation as next. Generated blocks are replaced by the ones
+// in next, static blocks are kept (moved, not copied again). Layout is updated.
+void refresh_item_filter(lang::item_filter& filter, item_filter_layout& layout, materialized_item_filter next);
+
 // spirit_filter_representation + item_price_data => real_filter_representation
 [[nodiscard]] lang::item_filter
 make_item_filter(
 	const lang::spirit_item_filter& filter_template,
-	const lang::market::item_price_data& item_price_data);
+	const lang::market::item_price_data& item_price_data,
+	utility::parallel_settings settings = {});
+
+// as above, with indexes built from item_price_data
+[[nodiscard]] lang::item_filter
+make_item_filter(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	utility::parallel_settings settings = {});
+
+// For repeated output of the same spirit_filter_representation with different
+// item_price_data: text of static blocks is rendered once on construction,
+// only generated blocks are printed each time. Output is the same as
+// item_filter_to_string_without_preamble(make_item_filter(...), overrides).
+class prerendered_filter_template
+{
+public:
+	prerendered_filter_template(const lang::spirit_item_filter& filter_template, lang::style_overrides overrides);
+
+	// filter must be materialized from the same spirit_filter_representation
+	[[nodiscard]] std::string to_string_without_preamble(const materialized_item_filter& filter) const;
+
+private:
+	std::vector<std::string> m_static_texts; // 1 for each template block, empty for autogen blocks
+	lang::style_overrides m_overrides;
+	bool m_is_ruthless;
+};
+
+// spirit_filter_representation + prerendered static blocks + item_price_report => preamble + output_string
+// (no optional passes, only autogen blocks are generated and printed; price_indexes are built from the report)
+[[nodiscard]] std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const prerendered_filter_template& prerendered,
+	const lang::market::item_price_report& report,
+	const lang::market::item_price_indexes& price_indexes,
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
 
 // real_filter_representation => string
 [[nodiscard]] std::string
@@ -57,6 +185,46 @@ item_filter_to_string_with_preamble(
 	lang::style_overrides overrides,
 	const lang::market::item_price_metadata& item_price_metadata);
 
+// spirit_filter_representation + item_price_data => output_string
+// (also runs optional passes requested in settings, no preamble;
+// autogen blocks are generated as in materialize_item_filter)
+[[nodiscard]] std::string
+generate_item_filter_without_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
+
+// as above, with indexes built from item_price_data
+[[nodiscard]] std::string
+generate_item_filter_without_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
+
+// spirit_filter_representation + item_price_report => preamble + output_string
+[[nodiscard]] std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_report& report,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
+
+// as above, with indexes built from the report
+[[nodiscard]] std::string
+generate_item_filter_with_preamble(
+	const lang::spirit_item_filter& filter_template,
+	const lang::market::item_price_report& report,
+	const lang::market::item_price_indexes& price_indexes,
+	settings st,
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
+
 // end-to-end function: input_string => output_string
 // (no version/config/about preamble in generated file contents)
 [[nodiscard]] std::optional<std::string>
@@ -64,7 +232,8 @@ parse_compile_generate_spirit_filter_without_preamble(
 	std::string_view input,
 	const lang::market::item_price_data& item_price_data,
 	settings st,
-	log::logger& logger);
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
 
 // end-to-end function: input_string => output_string
 [[nodiscard]] std::optional<std::string>
@@ -72,6 +241,7 @@ parse_compile_generate_spirit_filter_with_preamble(
 	std::string_view input,
 	const lang::market::item_price_report& report,
 	settings st,
-	log::logger& logger);
+	log::logger& logger,
+	utility::parallel_settings parallel = {});
 
 }
@@ -5,10 +5,17 @@
 #include <fs/lang/item_filter.hpp>
 #include <fs/lang/constants.hpp>
 #include <fs/lang/market/item_price_data.hpp>
+#include <fs/utility/assert.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
 #include <string_view>
 #include <initializer_list>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace fs::compiler::detail {
 
@@ -16,62 +23,95 @@ namespace {
 
 // ---- item search/match functions ----
 
-template <typename Container, typename Predicate>
-[[nodiscard]] lang::condition_values_container<lang::string>
-get_matching_items(
-	const Container& container,
-	Predicate predicate,
-	lang::price_range_condition price_range,
-	lang::position_tag autogen_origin)
+// positions of items within the price range, in the order of the container
+template <typename MarketItemType>
+[[nodiscard]] std::vector<std::size_t>
+find_items_in_price_range(
+	[[maybe_unused]] const std::vector<MarketItemType>& items,
+	const lang::market::price_index& index,
+	lang::price_range_condition price_range)
 {
-	using container_value_type = typename Container::value_type;
 	static_assert(
-		std::is_base_of_v<lang::market::elementary_item, container_value_type>,
+		std::is_base_of_v<lang::market::elementary_item, MarketItemType>,
 		"items container should store elementary_item or derived type");
-	static_assert(
-		std::is_invocable_r_v<bool, Predicate, container_value_type>,
-		"Predicate should accept Container's element and return bool");
 
-	lang::condition_values_container<lang::string> result;
-	for (const auto& item : container) {
-		if (item.price.is_low_confidence || !price_range.includes(item.price.chaos_value))
-			continue;
-
-		if (!predicate(item))
-			continue;
+	FS_ASSERT(index.prices.size() <= items.size());
 
-		result.push_back(lang::string{item.name, autogen_origin});
-	}
+	const auto first = std::partition_point(index.prices.begin(), index.prices.end(),
+		[&](double price) { return !price_range.test_lower_bound(price); });
+	const auto last = std::partition_point(first, index.prices.end(),
+		[&](double price) { return price_range.test_upper_bound(price); });
 
+	const auto first_index = index.indexes.begin() + (first - index.prices.begin());
+	const auto last_index  = index.indexes.begin() + (last  - index.prices.begin());
+	std::vector<std::size_t> result(first_index, last_index);
+	// generated conditions should not depend on the order of prices
+	std::sort(result.begin(), result.end());
 	return result;
 }
 
-struct empty_matcher
+template <typename MarketItemType>
+[[nodiscard]] lang::condition_values_container<lang::string>
+get_matching_items(
+	const std::vector<MarketItemType>& items,
+	const lang::market::price_index& index,
+	lang::price_range_condition price_range,
+	lang::position_tag autogen_origin)
 {
-	bool operator()(const lang::market::elementary_item& /* itm */)
-	{
-		return true;
-	}
-};
+	lang::condition_values_container<lang::string> result;
+	for (std::size_t i : find_items_in_price_range(items, index, price_range))
+		result.push_back(lang::string{items[i].name, autogen_origin});
 
-struct gem_matcher
+	return result;
+}
+
+struct gem_group
 {
 	int level;
 	int quality;
 	bool corrupt;
 
-	bool operator()(const lang::market::gem& g) const
+	bool operator<(gem_group other) const
 	{
-		return g.level == level && g.quality == quality && g.is_corrupted == corrupt;
+		return std::tie(level, quality, corrupt) < std::tie(other.level, other.quality, other.corrupt);
 	}
 };
 
+/*
+ * Single pass over all gems, each gem lands in its (level, quality, corruption) group.
+ * Groups are ordered the same way as blocks are generated, gems inside each group
+ * keep their order from the price data.
+ */
+[[nodiscard]] std::map<gem_group, lang::condition_values_container<lang::string>>
+get_matching_gems(
+	const std::vector<lang::market::gem>& gems,
+	const lang::market::price_index& index,
+	lang::price_range_condition price_range,
+	lang::position_tag autogen_origin)
+{
+	std::map<gem_group, lang::condition_values_container<lang::string>> result;
+	for (std::size_t i : find_items_in_price_range(gems, index, price_range)) {
+		const lang::market::gem& g = gems[i];
+
+		if (g.level < lang::constants::min_item_gem_level || g.level > lang::constants::max_item_gem_level)
+			continue;
+
+		if (g.quality < lang::constants::min_item_gem_quality || g.quality > lang::constants::max_item_gem_quality)
+			continue;
+
+		result[gem_group{g.level, g.quality, g.is_corrupted}].push_back(lang::string{g.name, autogen_origin});
+	}
+
+	return result;
+}
+
 // ---- block generation functions ----
 
 template <typename MarketItemType>
 void generate_blocks_simple(
 	const lang::block_generation_info& block_info,
 	const std::vector<MarketItemType>& item_price_data_field,
+	const lang::market::price_index& price_index,
 	std::string_view item_class_name,
 	lang::generated_blocks_consumer consumer)
 {
@@ -89,7 +129,7 @@ void generate_blocks_simple(
 		block_info.autogen_origin));
 	block.conditions.conditions.push_back(lang::make_base_type_condition(
 		lang::equality_comparison_type::exact_match,
-		get_matching_items(item_price_data_field, empty_matcher{}, block_info.price_range, block_info.autogen_origin),
+		get_matching_items(item_price_data_field, price_index, block_info.price_range, block_info.autogen_origin),
 		block_info.autogen_origin));
 
 	if (block.conditions.is_valid())
@@ -99,47 +139,42 @@ void generate_blocks_simple(
 void generate_blocks_gems(
 	const lang::block_generation_info& block_info,
 	const lang::market::item_price_data& item_price_data,
+	const lang::market::item_price_indexes& price_indexes,
 	lang::generated_blocks_consumer consumer)
 {
-	for (int level = lang::constants::min_item_gem_level; level <= lang::constants::max_item_gem_level; ++level) {
-		for (int quality = lang::constants::min_item_gem_quality; quality <= lang::constants::max_item_gem_quality; ++quality) {
-			for (bool corrupt : {false, true}) {
-				lang::item_filter_block block(block_info.visibility);
-				block.actions = block_info.actions;
-				block.continuation = block_info.continuation;
-
-				block.conditions.conditions.push_back(lang::make_class_condition(
-					lang::equality_comparison_type::exact_match,
-					lang::condition_values_container<lang::string>{
-						lang::string{lang::item_class_names::gems_active, block_info.autogen_origin},
-						lang::string{lang::item_class_names::gems_support, block_info.autogen_origin}
-					},
-					block_info.autogen_origin));
-				block.conditions.conditions.push_back(lang::make_base_type_condition(
-					lang::equality_comparison_type::exact_match,
-					get_matching_items(
-						item_price_data.gems,
-						gem_matcher{level, quality, corrupt},
-						block_info.price_range,
-						block_info.autogen_origin
-					),
-					block_info.autogen_origin));
-				block.conditions.conditions.push_back(lang::make_gem_level_value_list_condition(
-					lang::condition_values_container<lang::integer>{lang::integer{level, block_info.autogen_origin}},
-					true,
-					block_info.autogen_origin));
-				block.conditions.conditions.push_back(lang::make_quality_value_list_condition(
-					lang::condition_values_container<lang::integer>{lang::integer{quality, block_info.autogen_origin}},
-					true,
-					block_info.autogen_origin));
-				block.conditions.conditions.push_back(lang::make_corrupted_condition(
-					lang::boolean{corrupt, block_info.autogen_origin},
-					block_info.autogen_origin));
-
-				if (block.conditions.is_valid())
-					consumer.push(std::move(block));
-			}
-		}
+	auto groups = get_matching_gems(
+		item_price_data.gems, price_indexes.gems, block_info.price_range, block_info.autogen_origin);
+
+	for (auto& [group, names] : groups) {
+		lang::item_filter_block block(block_info.visibility);
+		block.actions = block_info.actions;
+		block.continuation = block_info.continuation;
+
+		block.conditions.conditions.push_back(lang::make_class_condition(
+			lang::equality_comparison_type::exact_match,
+			lang::condition_values_container<lang::string>{
+				lang::string{lang::item_class_names::gems_active, block_info.autogen_origin},
+				lang::string{lang::item_class_names::gems_support, block_info.autogen_origin}
+			},
+			block_info.autogen_origin));
+		block.conditions.conditions.push_back(lang::make_base_type_condition(
+			lang::equality_comparison_type::exact_match,
+			std::move(names),
+			block_info.autogen_origin));
+		block.conditions.conditions.push_back(lang::make_gem_level_value_list_condition(
+			lang::condition_values_container<lang::integer>{lang::integer{group.level, block_info.autogen_origin}},
+			true,
+			block_info.autogen_origin));
+		block.conditions.conditions.push_back(lang::make_quality_value_list_condition(
+			lang::condition_values_container<lang::integer>{lang::integer{group.quality, block_info.autogen_origin}},
+			true,
+			block_info.autogen_origin));
+		block.conditions.conditions.push_back(lang::make_corrupted_condition(
+			lang::boolean{group.corrupt, block_info.autogen_origin},
+			block_info.autogen_origin));
+
+		if (block.conditions.is_valid())
+			consumer.push(std::move(block));
 	}
 }
 
@@ -231,6 +266,7 @@ make_autogen_simple(
 	lang::position_tag autogen_origin,
 	std::string_view item_class_name,
 	std::vector<MarketItemType> lang::market::item_price_data::* field,
+	lang::market::price_index lang::market::item_price_indexes::* index_field,
 	diagnostics_store& diagnostics)
 {
 	static_assert(std::is_base_of_v<lang::market::elementary_item, MarketItemType>);
@@ -238,12 +274,14 @@ make_autogen_simple(
 	if (!verify_autogen_conditions(st, conditions, class_condition_verifier{item_class_name}, autogen_origin, diagnostics))
 		return {};
 
-	return [field, item_class_name](
+	return [field, index_field, item_class_name](
 			const lang::block_generation_info& block_info,
 			const lang::market::item_price_data& item_price_data,
+			const lang::market::item_price_indexes& price_indexes,
 			lang::generated_blocks_consumer consumer)
 		{
-			return generate_blocks_simple(block_info, item_price_data.*field, item_class_name, consumer);
+			return generate_blocks_simple(
+				block_info, item_price_data.*field, price_indexes.*index_field, item_class_name, consumer);
 		};
 }
 
@@ -280,34 +318,35 @@ make_autogen_func(
 	}
 
 	using ipd = lang::market::item_price_data;
+	using ipi = lang::market::item_price_indexes;
 	namespace cn = lang::item_class_names;
 
 	switch (autogen.category) {
 		// TODO some of these may benefit from additional StackSize condition
 		case lang::autogen_category::currency:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::currency_stackable, &ipd::currency, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::currency_stackable, &ipd::currency, &ipi::currency, diagnostics);
 		case lang::autogen_category::delirium_orbs:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::delirium_orbs, &ipd::delirium_orbs, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::delirium_orbs, &ipd::delirium_orbs, &ipi::delirium_orbs, diagnostics);
 		case lang::autogen_category::essences:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::essences, &ipd::essences, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::essences, &ipd::essences, &ipi::essences, diagnostics);
 		case lang::autogen_category::fossils:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::fossils, &ipd::fossils, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::fossils, &ipd::fossils, &ipi::fossils, diagnostics);
 		case lang::autogen_category::oils:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::oils, &ipd::oils, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::oils, &ipd::oils, &ipi::oils, diagnostics);
 		case lang::autogen_category::vials:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::vials, &ipd::vials, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::vials, &ipd::vials, &ipi::vials, diagnostics);
 		case lang::autogen_category::fragments:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::map_fragments, &ipd::fragments, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::map_fragments, &ipd::fragments, &ipi::fragments, diagnostics);
 		case lang::autogen_category::resonators:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::resonators, &ipd::resonators, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::resonators, &ipd::resonators, &ipi::resonators, diagnostics);
 		case lang::autogen_category::scarabs:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::scarabs, &ipd::scarabs, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::scarabs, &ipd::scarabs, &ipi::scarabs, diagnostics);
 		case lang::autogen_category::tattoos:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::tattoos, &ipd::tattoos, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::tattoos, &ipd::tattoos, &ipi::tattoos, diagnostics);
 		case lang::autogen_category::incubators:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::incubator, &ipd::incubators, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::incubator, &ipd::incubators, &ipi::incubators, diagnostics);
 		case lang::autogen_category::cards:
-			return make_autogen_simple(st, conditions, autogen.origin, cn::divination_card, &ipd::divination_cards, diagnostics);
+			return make_autogen_simple(st, conditions, autogen.origin, cn::divination_card, &ipd::divination_cards, &ipi::divination_cards, diagnostics);
 		case lang::autogen_category::gems:
 			return make_autogen_gem(st, conditions, autogen.origin, diagnostics);
 
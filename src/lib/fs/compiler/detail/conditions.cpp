@@ -28,33 +28,29 @@ struct protocondition
 	lang::position_tag condition_origin;
 };
 
-template <typename R, typename... Args>
-using condition_factory_func = std::shared_ptr<R> (Args...);
+template <typename... Args>
+using condition_factory_func = lang::official_condition_value (Args...);
 
 using boolean_condition_factory_func = condition_factory_func<
-	lang::boolean_condition, lang::boolean, lang::position_tag>;
+	lang::boolean, lang::position_tag>;
 template <typename T>
 using range_bound_condition_factory_func = condition_factory_func<
-	lang::range_bound_condition<T>, lang::range_bound<T>, bool, lang::position_tag>;
+	lang::range_bound<T>, bool, lang::position_tag>;
 template <typename T>
 using value_list_condition_factory_func = condition_factory_func<
-	lang::value_list_condition<T>,
 	typename lang::value_list_condition<T>::container_type,
 	bool,
 	lang::position_tag>;
 using string_comparison_condition_factory_func = condition_factory_func<
-	lang::string_comparison_condition,
 	lang::equality_comparison_type,
 	lang::string_comparison_condition::container_type,
 	lang::position_tag>;
 using counted_string_comparison_condition_factory_func = condition_factory_func<
-	lang::counted_string_comparison_condition,
 	lang::comparison_type,
 	std::optional<lang::integer>,
 	lang::counted_string_comparison_condition::container_type,
 	lang::position_tag>;
 using socket_specification_condition_factory_func = condition_factory_func<
-	lang::socket_specification_condition,
 	lang::comparison_type,
 	lang::socket_specification_condition::container_type,
 	lang::position_tag>;
@@ -74,7 +70,7 @@ check_no_counted_comparison(
 	return true;
 }
 
-[[nodiscard]] std::shared_ptr<lang::boolean_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_boolean_condition(
 	protocondition pc,
 	boolean_condition_factory_func& func,
@@ -167,7 +163,7 @@ make_influence_spec(settings st, const lang::object& obj, diagnostics_store& dia
 	return spec;
 }
 
-[[nodiscard]] std::shared_ptr<lang::has_influence_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_has_influence_condition(settings st, protocondition pc, diagnostics_store& diagnostics)
 {
 	if (!check_no_counted_comparison(pc.comparison.integer, diagnostics))
@@ -253,7 +249,7 @@ make_condition_values_container(settings /* st */, const lang::object& obj, diag
 }
 
 template <typename T>
-[[nodiscard]] std::shared_ptr<lang::range_or_list_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_range_or_list_condition(
 	settings st,
 	protocondition pc,
@@ -296,7 +292,7 @@ make_range_or_list_condition(
 	return nullptr;
 }
 
-[[nodiscard]] std::shared_ptr<lang::string_comparison_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_string_comparison_condition(
 	settings st,
 	protocondition pc,
@@ -324,7 +320,7 @@ make_string_comparison_condition(
 	return func(*maybe_cmp, std::move(*maybe_strings), pc.condition_origin);
 }
 
-[[nodiscard]] std::shared_ptr<lang::counted_string_comparison_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_counted_string_comparison_condition(
 	settings st,
 	protocondition pc,
@@ -362,7 +358,7 @@ make_counted_string_comparison_condition(
 	return func(pc.comparison.operator_.value, count, std::move(*maybe_strings), pc.condition_origin);
 }
 
-[[nodiscard]] std::shared_ptr<lang::socket_specification_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_socket_specification_condition(
 	settings st,
 	protocondition pc,
@@ -382,7 +378,7 @@ make_socket_specification_condition(
 	return func(pc.comparison.operator_.value, std::move(*maybe_specs), pc.condition_origin);
 }
 
-[[nodiscard]] std::shared_ptr<lang::official_condition> // null on failure
+[[nodiscard]] lang::official_condition_value // empty on failure
 make_official_condition(
 	settings st,
 	lang::official_condition_property property,
@@ -814,7 +810,7 @@ spirit_filter_add_official_condition(
 	if (!maybe_obj)
 		return false;
 
-	std::shared_ptr<lang::official_condition> new_condition = make_official_condition(
+	lang::official_condition_value new_condition = make_official_condition(
 		st,
 		condition.property,
 		protocondition{condition.comparison, std::move(*maybe_obj), position_tag_of(condition)},
@@ -970,7 +966,7 @@ real_filter_add_condition(
 	if (!maybe_obj)
 		return false;
 
-	std::shared_ptr<lang::official_condition> new_condition = make_official_condition(
+	lang::official_condition_value new_condition = make_official_condition(
 		st,
 		condition.property,
 		protocondition{condition.comparison, std::move(*maybe_obj), position_tag_of(condition)},
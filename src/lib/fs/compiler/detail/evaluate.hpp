@@ -30,13 +30,13 @@ make_socket_spec(
 [[nodiscard]] inline lang::string
 evaluate(const parser::ast::rf::string& str)
 {
-	return {str.value, parser::position_tag_of(str)};
+	return {std::string(str.value), parser::position_tag_of(str)};
 }
 
 [[nodiscard]] inline lang::string
 evaluate(const parser::ast::common::string_literal& sl)
 {
-	return {static_cast<std::string>(sl), parser::position_tag_of(sl)};
+	return {std::string(sl.value), parser::position_tag_of(sl)};
 }
 
 [[nodiscard]] inline lang::boolean
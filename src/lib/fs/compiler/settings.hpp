@@ -15,6 +15,10 @@ struct settings
 {
 	bool ruthless_mode = false;
 	bool print_ast = false;
+	// drop blocks which can never match (see lang::find_unreachable_blocks)
+	bool remove_unreachable_blocks = false;
+	// join adjacent blocks which differ only in values of 1 condition (see lang::merge_adjacent_blocks)
+	bool merge_blocks = false;
 	error_handling_settings error_handling;
 	lang::style_overrides overrides;
 };
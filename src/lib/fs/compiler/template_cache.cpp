@@ -0,0 +1,1239 @@
+#include <fs/compiler/template_cache.hpp>
+#include <fs/compiler/detail/autogen.hpp>
+#include <fs/compiler/detail/types.hpp>
+#include <fs/utility/visitor.hpp>
+#include <fs/version.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace fs::compiler
+{
+
+namespace
+{
+
+using property_t = lang::official_condition_property;
+
+constexpr std::string_view magic = "FSTC";
+// bump whenever the layout below changes
+constexpr std::uint32_t format_version = 2;
+
+// stored instead of offsets of origins which do not refer to any text
+constexpr std::uint32_t no_offset = 0xffffffffu;
+
+enum class block_kind : std::uint8_t { import, item_filter_block };
+
+// which official_condition derived class a condition is, for each
+// there is a family of lang::make_*_condition functions (1 per property)
+enum class condition_kind : std::uint8_t
+{
+	boolean,
+	has_influence,
+	rarity_range_bound,
+	rarity_value_list,
+	integer_range_bound,
+	integer_value_list,
+	string_comparison,
+	counted_string_comparison,
+	socket_specification
+};
+
+// FNV-1a
+class hasher
+{
+public:
+	void add(std::string_view bytes) noexcept
+	{
+		for (char c : bytes) {
+			m_state ^= static_cast<unsigned char>(c);
+			m_state *= 0x100000001b3u;
+		}
+	}
+
+	void add(std::uint64_t value) noexcept
+	{
+		for (int i = 0; i < 8; ++i) {
+			const char c = static_cast<char>((value >> (8 * i)) & 0xffu);
+			add(std::string_view(&c, 1));
+		}
+	}
+
+	std::uint64_t result() const noexcept { return m_state; }
+
+private:
+	std::uint64_t m_state = 0xcbf29ce484222325u;
+};
+
+// all values are stored little-endian regardless of the platform
+class writer
+{
+public:
+	void write_u8(std::uint8_t value)
+	{
+		m_data.push_back(static_cast<char>(value));
+	}
+
+	void write_u32(std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+			write_u8(static_cast<std::uint8_t>((value >> (8 * i)) & 0xffu));
+	}
+
+	void write_u64(std::uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i)
+			write_u8(static_cast<std::uint8_t>((value >> (8 * i)) & 0xffu));
+	}
+
+	void write_i32(int value)
+	{
+		write_u32(static_cast<std::uint32_t>(value));
+	}
+
+	void write_f64(double value)
+	{
+		static_assert(sizeof(double) == sizeof(std::uint64_t));
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		write_u64(bits);
+	}
+
+	void write_bool(bool value)
+	{
+		write_u8(value ? 1 : 0);
+	}
+
+	template <typename Enum>
+	void write_enum(Enum value)
+	{
+		write_u8(static_cast<std::uint8_t>(value));
+	}
+
+	void write_size(std::size_t size)
+	{
+		write_u32(static_cast<std::uint32_t>(size));
+	}
+
+	void write_bytes(std::string_view bytes)
+	{
+		m_data.append(bytes.data(), bytes.size());
+	}
+
+	void write_string(std::string_view str)
+	{
+		write_size(str.size());
+		write_bytes(str);
+	}
+
+	std::string release() { return std::move(m_data); }
+
+private:
+	std::string m_data;
+};
+
+// Reading past the end or an invalid value makes the reader fail: all further
+// reads return zeros and failed() is true. This saves checking every value,
+// callers check failed() before using anything which was read.
+class reader
+{
+public:
+	explicit reader(std::string_view data)
+	: m_data(data)
+	{}
+
+	std::uint8_t read_u8()
+	{
+		return static_cast<std::uint8_t>(read_le(1));
+	}
+
+	std::uint32_t read_u32()
+	{
+		return static_cast<std::uint32_t>(read_le(4));
+	}
+
+	std::uint64_t read_u64()
+	{
+		return read_le(8);
+	}
+
+	int read_i32()
+	{
+		return static_cast<int>(static_cast<std::int32_t>(read_u32()));
+	}
+
+	double read_f64()
+	{
+		const std::uint64_t bits = read_u64();
+		double result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	bool read_bool()
+	{
+		const std::uint8_t value = read_u8();
+		if (value > 1)
+			fail();
+
+		return value == 1;
+	}
+
+	// values above last are invalid
+	template <typename Enum>
+	Enum read_enum(Enum last)
+	{
+		const std::uint8_t value = read_u8();
+		if (value > static_cast<std::uint8_t>(last))
+			fail();
+
+		return static_cast<Enum>(value);
+	}
+
+	// number of elements which will be read next, each taking at least 1 byte
+	// (prevents huge allocations on malformed data)
+	std::size_t read_size()
+	{
+		const std::size_t size = read_u32();
+		if (size > m_data.size()) {
+			fail();
+			return 0;
+		}
+
+		return size;
+	}
+
+	std::string_view read_bytes(std::size_t size)
+	{
+		if (m_data.size() < size) {
+			fail();
+			return {};
+		}
+
+		std::string_view result = m_data.substr(0, size);
+		m_data.remove_prefix(size);
+		return result;
+	}
+
+	std::string read_string()
+	{
+		return std::string(read_bytes(read_size()));
+	}
+
+	void fail() noexcept
+	{
+		m_failed = true;
+		m_data = {};
+	}
+
+	bool failed() const noexcept { return m_failed; }
+	bool at_end() const noexcept { return m_data.empty(); }
+
+private:
+	std::uint64_t read_le(int num_bytes)
+	{
+		if (m_data.size() < static_cast<std::size_t>(num_bytes)) {
+			fail();
+			return 0;
+		}
+
+		std::uint64_t result = 0;
+		for (int i = 0; i < num_bytes; ++i)
+			result |= std::uint64_t{static_cast<unsigned char>(m_data[static_cast<std::size_t>(i)])} << (8 * i);
+
+		m_data.remove_prefix(static_cast<std::size_t>(num_bytes));
+		return result;
+	}
+
+	std::string_view m_data;
+	bool m_failed = false;
+};
+
+// ---- factories of conditions ----
+
+using boolean_condition_factory = lang::official_condition_value (*)(lang::boolean, lang::position_tag);
+using integer_range_bound_condition_factory = lang::official_condition_value (*)(
+	lang::range_bound<lang::integer>, bool, lang::position_tag);
+using integer_value_list_condition_factory = lang::official_condition_value (*)(
+	lang::value_list_condition<lang::integer>::container_type, bool, lang::position_tag);
+using string_comparison_condition_factory = lang::official_condition_value (*)(
+	lang::equality_comparison_type, lang::string_comparison_condition::container_type, lang::position_tag);
+using counted_string_comparison_condition_factory = lang::official_condition_value (*)(
+	lang::comparison_type, std::optional<lang::integer>, lang::counted_string_comparison_condition::container_type, lang::position_tag);
+
+// same mapping as compiler's make_official_condition, null for other properties
+
+boolean_condition_factory find_boolean_condition_factory(property_t property)
+{
+	switch (property) {
+		case property_t::identified:
+			return lang::make_identified_condition;
+		case property_t::corrupted:
+			return lang::make_corrupted_condition;
+		case property_t::mirrored:
+			return lang::make_mirrored_condition;
+		case property_t::elder_item:
+			return lang::make_elder_item_condition;
+		case property_t::shaper_item:
+			return lang::make_shaper_item_condition;
+		case property_t::fractured_item:
+			return lang::make_fractured_item_condition;
+		case property_t::synthesised_item:
+			return lang::make_synthesised_item_condition;
+		case property_t::any_enchantment:
+			return lang::make_any_enchantment_condition;
+		case property_t::shaped_map:
+			return lang::make_shaped_map_condition;
+		case property_t::elder_map:
+			return lang::make_elder_map_condition;
+		case property_t::blighted_map:
+			return lang::make_blighted_map_condition;
+		case property_t::replica:
+			return lang::make_replica_condition;
+		case property_t::scourged:
+			return lang::make_scourged_condition;
+		case property_t::uber_blighted_map:
+			return lang::make_uber_blighted_map_condition;
+		case property_t::has_implicit_mod:
+			return lang::make_has_implicit_mod_condition;
+		case property_t::has_crucible_passive_tree:
+			return lang::make_has_crucible_passive_tree_condition;
+		case property_t::alternate_quality:
+			return lang::make_alternate_quality_condition;
+		case property_t::zana_memory:
+			return lang::make_zana_memory_condition;
+		case property_t::transfigured_gem:
+			return lang::make_transfigured_gem_condition_boolean_version;
+		default:
+			return nullptr;
+	}
+}
+
+struct integer_condition_factories
+{
+	integer_range_bound_condition_factory range_bound = nullptr;
+	integer_value_list_condition_factory value_list = nullptr;
+};
+
+integer_condition_factories find_integer_condition_factories(property_t property)
+{
+	switch (property) {
+		case property_t::item_level:
+			return {lang::make_item_level_range_bound_condition, lang::make_item_level_value_list_condition};
+		case property_t::drop_level:
+			return {lang::make_drop_level_range_bound_condition, lang::make_drop_level_value_list_condition};
+		case property_t::quality:
+			return {lang::make_quality_range_bound_condition, lang::make_quality_value_list_condition};
+		case property_t::linked_sockets:
+			return {lang::make_linked_sockets_range_bound_condition, lang::make_linked_sockets_value_list_condition};
+		case property_t::height:
+			return {lang::make_height_range_bound_condition, lang::make_height_value_list_condition};
+		case property_t::width:
+			return {lang::make_width_range_bound_condition, lang::make_width_value_list_condition};
+		case property_t::stack_size:
+			return {lang::make_stack_size_range_bound_condition, lang::make_stack_size_value_list_condition};
+		case property_t::gem_level:
+			return {lang::make_gem_level_range_bound_condition, lang::make_gem_level_value_list_condition};
+		case property_t::map_tier:
+			return {lang::make_map_tier_range_bound_condition, lang::make_map_tier_value_list_condition};
+		case property_t::area_level:
+			return {lang::make_area_level_range_bound_condition, lang::make_area_level_value_list_condition};
+		case property_t::corrupted_mods:
+			return {lang::make_corrupted_mods_range_bound_condition, lang::make_corrupted_mods_value_list_condition};
+		case property_t::enchantment_passive_num:
+			return {lang::make_enchantment_passive_num_range_bound_condition, lang::make_enchantment_passive_num_value_list_condition};
+		case property_t::base_defence_percentile:
+			return {lang::make_base_defence_percentile_range_bound_condition, lang::make_base_defence_percentile_value_list_condition};
+		case property_t::base_armour:
+			return {lang::make_base_armour_range_bound_condition, lang::make_base_armour_value_list_condition};
+		case property_t::base_evasion:
+			return {lang::make_base_evasion_range_bound_condition, lang::make_base_evasion_value_list_condition};
+		case property_t::base_energy_shield:
+			return {lang::make_base_energy_shield_range_bound_condition, lang::make_base_energy_shield_value_list_condition};
+		case property_t::base_ward:
+			return {lang::make_base_ward_range_bound_condition, lang::make_base_ward_value_list_condition};
+		case property_t::has_searing_exarch_implicit:
+			return {lang::make_has_searing_exarch_implicit_range_bound_condition, lang::make_has_searing_exarch_implicit_value_list_condition};
+		case property_t::has_eater_of_worlds_implicit:
+			return {lang::make_has_eater_of_worlds_implicit_range_bound_condition, lang::make_has_eater_of_worlds_implicit_value_list_condition};
+		case property_t::memory_strands:
+			return {lang::make_memory_strands_range_bound_condition, lang::make_memory_strands_value_list_condition};
+		default:
+			return {};
+	}
+}
+
+string_comparison_condition_factory find_string_comparison_condition_factory(property_t property)
+{
+	switch (property) {
+		case property_t::class_:
+			return lang::make_class_condition;
+		case property_t::base_type:
+			return lang::make_base_type_condition;
+		case property_t::enchantment_passive_node:
+			return lang::make_enchantment_passive_node_condition;
+		case property_t::archnemesis_mod:
+			return lang::make_archnemesis_mod_condition;
+		case property_t::transfigured_gem:
+			return lang::make_transfigured_gem_condition_string_version;
+		default:
+			return nullptr;
+	}
+}
+
+counted_string_comparison_condition_factory find_counted_string_comparison_condition_factory(property_t property)
+{
+	switch (property) {
+		case property_t::has_explicit_mod:
+			return lang::make_has_explicit_mod_condition;
+		case property_t::has_enchantment:
+			return lang::make_has_enchantment_condition;
+		default:
+			return nullptr;
+	}
+}
+
+// ---- spirit_filter_representation => binary ----
+
+class filter_writer
+{
+public:
+	explicit filter_writer(const parser::parse_metadata& metadata)
+	: m_positions(metadata.lookup.position_cache())
+	{}
+
+	writer& bytes() { return m_writer; }
+
+	void write(lang::position_tag origin)
+	{
+		if (!lang::is_valid(origin)) {
+			m_writer.write_u32(no_offset);
+			m_writer.write_u32(no_offset);
+			return;
+		}
+
+		const auto range = m_positions.position_of(origin);
+		m_writer.write_size(static_cast<std::size_t>(range.begin() - m_positions.first()));
+		m_writer.write_size(static_cast<std::size_t>(range.end() - m_positions.first()));
+	}
+
+	template <typename T>
+	void write(const std::optional<T>& opt)
+	{
+		m_writer.write_bool(opt.has_value());
+		if (opt)
+			write(*opt);
+	}
+
+	template <typename T>
+	void write(const boost::optional<T>& opt)
+	{
+		m_writer.write_bool(opt.has_value());
+		if (opt)
+			write(*opt);
+	}
+
+	template <typename T>
+	void write(const lang::condition_values_container<T>& values)
+	{
+		m_writer.write_size(values.size());
+		for (const T& value : values)
+			write(value);
+	}
+
+	void write(lang::none_type none) { write(none.origin); }
+	void write(lang::boolean b) { m_writer.write_bool(b.value); write(b.origin); }
+	void write(lang::integer i) { m_writer.write_i32(i.value); write(i.origin); }
+	void write(lang::fractional f) { m_writer.write_f64(f.value); write(f.origin); }
+	void write(lang::rarity r) { m_writer.write_enum(r.value); write(r.origin); }
+	void write(lang::shape s) { m_writer.write_enum(s.value); write(s.origin); }
+	void write(lang::suit s) { m_writer.write_enum(s.value); write(s.origin); }
+	void write(lang::shaper_voice_line svl) { m_writer.write_enum(svl.value); write(svl.origin); }
+	void write(const lang::string& str) { m_writer.write_string(str.value); write(str.origin); }
+
+	void write(lang::socket_spec ss)
+	{
+		m_writer.write_bool(ss.num.has_value());
+		if (ss.num)
+			m_writer.write_i32(*ss.num);
+
+		for (int n : {ss.r, ss.g, ss.b, ss.w, ss.a, ss.d})
+			m_writer.write_i32(n);
+		write(ss.origin);
+	}
+
+	void write(const lang::influence_spec& spec)
+	{
+		write(spec.shaper);
+		write(spec.elder);
+		write(spec.crusader);
+		write(spec.redeemer);
+		write(spec.hunter);
+		write(spec.warlord);
+		write(spec.none);
+	}
+
+	template <typename T>
+	void write(lang::range_bound<T> bound)
+	{
+		write(bound.value);
+		m_writer.write_bool(bound.inclusive);
+	}
+
+	void write(lang::price_bound bound)
+	{
+		write(bound.bound);
+		write(bound.origin);
+	}
+
+	// ---- actions ----
+
+	void write(lang::color c)
+	{
+		write(c.r);
+		write(c.g);
+		write(c.b);
+		write(c.a);
+	}
+
+	void write(lang::color_action action) { write(action.c); write(action.origin); }
+	void write(lang::font_size_action action) { write(action.size); write(action.origin); }
+	void write(lang::switch_drop_sound_action action) { m_writer.write_bool(action.enable); write(action.origin); }
+
+	void write(lang::play_effect_action action)
+	{
+		m_writer.write_size(action.effect.index());
+		std::visit(utility::visitor{
+			[this](lang::enabled_play_effect effect) { write(effect.color); m_writer.write_bool(effect.is_temporary); },
+			[this](lang::disabled_play_effect effect) { write(effect.none); }
+		}, action.effect);
+		write(action.origin);
+	}
+
+	void write(lang::minimap_icon_action action)
+	{
+		m_writer.write_size(action.icon.index());
+		std::visit(utility::visitor{
+			[this](lang::enabled_minimap_icon icon) { write(icon.size); write(icon.color); write(icon.shape_); },
+			[this](lang::disabled_minimap_icon icon) { write(icon.sentinel_origin); }
+		}, action.icon);
+		write(action.origin);
+	}
+
+	void write(const lang::alert_sound_action& action)
+	{
+		m_writer.write_size(action.sound.index());
+		std::visit(utility::visitor{
+			[this](lang::builtin_alert_sound sound) {
+				m_writer.write_bool(sound.is_positional);
+				m_writer.write_size(sound.sound_id.id.index());
+				std::visit([this](auto id) { write(id); }, sound.sound_id.id);
+			},
+			[this](const lang::custom_alert_sound& sound) {
+				m_writer.write_bool(sound.is_optional);
+				write(sound.path);
+			}
+		}, action.sound);
+		write(action.volume);
+		write(action.origin);
+	}
+
+	void write(const lang::action_set& actions)
+	{
+		write(actions.text_color);
+		write(actions.border_color);
+		write(actions.background_color);
+		write(actions.font_size);
+		write(actions.effect);
+		write(actions.minimap_icon);
+		write(actions.alert_sound);
+		write(actions.switch_drop_sound);
+		write(actions.switch_drop_sound_if_alert_sound);
+	}
+
+	// ---- conditions ----
+
+	// false if the condition is of unknown type
+	[[nodiscard]] bool write(const lang::official_condition& condition)
+	{
+		if (const auto* const cond = dynamic_cast<const lang::boolean_condition*>(&condition)) {
+			write_condition_header(condition_kind::boolean, condition);
+			write(cond->value());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::has_influence_condition*>(&condition)) {
+			write_condition_header(condition_kind::has_influence, condition);
+			write(cond->spec());
+			m_writer.write_bool(cond->is_exact_match());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::range_bound_condition<lang::rarity>*>(&condition)) {
+			write_condition_header(condition_kind::rarity_range_bound, condition);
+			write(cond->bound());
+			m_writer.write_bool(cond->is_lower_bound());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::value_list_condition<lang::rarity>*>(&condition)) {
+			write_condition_header(condition_kind::rarity_value_list, condition);
+			write(cond->values());
+			m_writer.write_bool(cond->is_allowed_list());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::range_bound_condition<lang::integer>*>(&condition)) {
+			write_condition_header(condition_kind::integer_range_bound, condition);
+			write(cond->bound());
+			m_writer.write_bool(cond->is_lower_bound());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::value_list_condition<lang::integer>*>(&condition)) {
+			write_condition_header(condition_kind::integer_value_list, condition);
+			write(cond->values());
+			m_writer.write_bool(cond->is_allowed_list());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::string_comparison_condition*>(&condition)) {
+			write_condition_header(condition_kind::string_comparison, condition);
+			m_writer.write_enum(cond->comparison());
+			write(cond->values());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::counted_string_comparison_condition*>(&condition)) {
+			write_condition_header(condition_kind::counted_string_comparison, condition);
+			m_writer.write_enum(cond->comparison());
+			write(cond->count());
+			write(cond->values());
+		}
+		else if (const auto* const cond = dynamic_cast<const lang::socket_specification_condition*>(&condition)) {
+			write_condition_header(condition_kind::socket_specification, condition);
+			m_writer.write_enum(cond->comparison());
+			write(cond->values());
+		}
+		else {
+			return false;
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] bool write(const lang::official_conditions& conditions)
+	{
+		m_writer.write_size(conditions.conditions.size());
+		for (const lang::official_condition_value& condition : conditions.conditions)
+			if (!write(*condition))
+				return false;
+
+		m_writer.write_size(conditions.evaluation_order.size());
+		for (std::uint32_t index : conditions.evaluation_order)
+			m_writer.write_u32(index);
+
+		return true;
+	}
+
+	// ---- blocks ----
+
+	void write(const lang::import_block& block)
+	{
+		m_writer.write_enum(block_kind::import);
+		write(block.path);
+		m_writer.write_bool(block.is_optional);
+		write(block.origin);
+	}
+
+	[[nodiscard]] bool write(const lang::spirit_item_filter_block& sb)
+	{
+		const lang::item_filter_block& block = sb.block;
+		m_writer.write_enum(block_kind::item_filter_block);
+		m_writer.write_enum(block.visibility.policy);
+		write(block.visibility.origin);
+
+		if (!write(block.conditions))
+			return false;
+
+		write(block.actions);
+		write(block.continuation.origin);
+
+		m_writer.write_bool(sb.autogen.has_value());
+		if (sb.autogen) {
+			const lang::autogen_extension& autogen = *sb.autogen;
+			m_writer.write_i32(autogen.category._to_integral());
+			write(autogen.price_range.lower_bound());
+			write(autogen.price_range.upper_bound());
+			write(autogen.origin);
+		}
+
+		return true;
+	}
+
+	void write(const diagnostic_message& message)
+	{
+		m_writer.write_enum(message.severity);
+		m_writer.write_enum(message.id);
+		write(message.origin);
+		m_writer.write_string(message.description);
+	}
+
+private:
+	void write_condition_header(condition_kind kind, const lang::official_condition& condition)
+	{
+		m_writer.write_enum(kind);
+		m_writer.write_enum(condition.tested_property());
+		write(condition.origin());
+	}
+
+	writer m_writer;
+	const parser::detail::position_cache_type& m_positions;
+};
+
+// ---- binary => spirit_filter_representation ----
+
+class filter_reader
+{
+public:
+	filter_reader(std::string_view data, parser::detail::position_cache_type& positions)
+	: m_reader(data)
+	, m_positions(positions)
+	{}
+
+	reader& bytes() { return m_reader; }
+
+	// each origin gets new position IDs, pointing at the same text as when the cache was saved
+	lang::position_tag read_origin()
+	{
+		const std::uint32_t first = m_reader.read_u32();
+		const std::uint32_t last = m_reader.read_u32();
+		if (first == no_offset && last == no_offset)
+			return lang::no_origin();
+
+		const auto source_size = static_cast<std::size_t>(m_positions.last() - m_positions.first());
+		if (first > last || last > source_size) {
+			m_reader.fail();
+			return lang::no_origin();
+		}
+
+		lang::position_tag result;
+		m_positions.annotate(result, m_positions.first() + first, m_positions.first() + last);
+		return result;
+	}
+
+	template <typename F>
+	auto read_optional(F read) -> std::optional<decltype(read())>
+	{
+		if (m_reader.read_bool())
+			return read();
+
+		return std::nullopt;
+	}
+
+	template <typename T, typename F>
+	lang::condition_values_container<T> read_values(F read)
+	{
+		lang::condition_values_container<T> result;
+		const std::size_t size = m_reader.read_size();
+		result.reserve(size);
+		for (std::size_t i = 0; i < size; ++i)
+			result.push_back(read());
+
+		return result;
+	}
+
+	lang::none_type read_none() { return lang::none_type{read_origin()}; }
+
+	lang::boolean read_boolean()
+	{
+		const bool value = m_reader.read_bool();
+		return lang::boolean{value, read_origin()};
+	}
+
+	lang::integer read_integer()
+	{
+		const int value = m_reader.read_i32();
+		return lang::integer{value, read_origin()};
+	}
+
+	lang::fractional read_fractional()
+	{
+		const double value = m_reader.read_f64();
+		return lang::fractional{value, read_origin()};
+	}
+
+	lang::rarity read_rarity()
+	{
+		const auto value = m_reader.read_enum(lang::rarity_type::unique);
+		return lang::rarity{value, read_origin()};
+	}
+
+	lang::shape read_shape()
+	{
+		const auto value = m_reader.read_enum(lang::shape_type::upside_down_house);
+		return lang::shape{value, read_origin()};
+	}
+
+	lang::suit read_suit()
+	{
+		const auto value = m_reader.read_enum(lang::suit_type::purple);
+		return lang::suit{value, read_origin()};
+	}
+
+	lang::shaper_voice_line read_shaper_voice_line()
+	{
+		const auto value = m_reader.read_enum(lang::shaper_voice_line_type::blessed);
+		return lang::shaper_voice_line{value, read_origin()};
+	}
+
+	lang::string read_string()
+	{
+		std::string value = m_reader.read_string();
+		return lang::string{std::move(value), read_origin()};
+	}
+
+	lang::socket_spec read_socket_spec()
+	{
+		lang::socket_spec result;
+		result.num = read_optional([this]() { return m_reader.read_i32(); });
+		for (int* n : {&result.r, &result.g, &result.b, &result.w, &result.a, &result.d})
+			*n = m_reader.read_i32();
+		result.origin = read_origin();
+		return result;
+	}
+
+	lang::influence_spec read_influence_spec()
+	{
+		const auto read = [this]() { return read_optional([this]() { return read_origin(); }); };
+		lang::influence_spec result;
+		result.shaper = read();
+		result.elder = read();
+		result.crusader = read();
+		result.redeemer = read();
+		result.hunter = read();
+		result.warlord = read();
+		result.none = read();
+		return result;
+	}
+
+	template <typename T, typename F>
+	lang::range_bound<T> read_range_bound(F read)
+	{
+		T value = read();
+		return lang::range_bound<T>{value, m_reader.read_bool()};
+	}
+
+	lang::price_bound read_price_bound()
+	{
+		const auto bound = read_range_bound<lang::fractional>([this]() { return read_fractional(); });
+		return lang::price_bound{bound, read_origin()};
+	}
+
+	// ---- actions ----
+
+	lang::color read_color()
+	{
+		lang::color result{read_integer(), read_integer(), read_integer(), std::nullopt};
+		result.a = read_optional([this]() { return read_integer(); });
+		return result;
+	}
+
+	lang::color_action read_color_action()
+	{
+		const lang::color c = read_color();
+		return lang::color_action{c, read_origin()};
+	}
+
+	lang::font_size_action read_font_size_action()
+	{
+		const lang::integer size = read_integer();
+		return lang::font_size_action{size, read_origin()};
+	}
+
+	lang::switch_drop_sound_action read_switch_drop_sound_action()
+	{
+		const bool enable = m_reader.read_bool();
+		return lang::switch_drop_sound_action{enable, read_origin()};
+	}
+
+	lang::play_effect_action read_play_effect_action()
+	{
+		lang::play_effect_action result{lang::disabled_play_effect{}, {}};
+		const std::size_t index = m_reader.read_u32();
+		if (index == 0) {
+			const lang::suit color = read_suit();
+			result.effect = lang::enabled_play_effect{color, m_reader.read_bool()};
+		}
+		else if (index == 1) {
+			result.effect = lang::disabled_play_effect{read_none()};
+		}
+		else {
+			m_reader.fail();
+		}
+
+		result.origin = read_origin();
+		return result;
+	}
+
+	lang::minimap_icon_action read_minimap_icon_action()
+	{
+		lang::minimap_icon_action result{lang::disabled_minimap_icon{}, {}};
+		const std::size_t index = m_reader.read_u32();
+		if (index == 0) {
+			const lang::integer size = read_integer();
+			const lang::suit color = read_suit();
+			result.icon = lang::enabled_minimap_icon{size, color, read_shape()};
+		}
+		else if (index == 1) {
+			result.icon = lang::disabled_minimap_icon{read_origin()};
+		}
+		else {
+			m_reader.fail();
+		}
+
+		result.origin = read_origin();
+		return result;
+	}
+
+	lang::alert_sound_action read_alert_sound_action()
+	{
+		lang::alert_sound_action result{lang::custom_alert_sound{}, std::nullopt, {}};
+		const std::size_t index = m_reader.read_u32();
+		if (index == 0) {
+			lang::builtin_alert_sound sound{m_reader.read_bool(), lang::builtin_alert_sound_id{lang::none_type{}}};
+			const std::size_t id_index = m_reader.read_u32();
+			if (id_index == 0)
+				sound.sound_id.id = read_integer();
+			else if (id_index == 1)
+				sound.sound_id.id = read_shaper_voice_line();
+			else if (id_index == 2)
+				sound.sound_id.id = read_none();
+			else
+				m_reader.fail();
+
+			result.sound = sound;
+		}
+		else if (index == 1) {
+			const bool is_optional = m_reader.read_bool();
+			result.sound = lang::custom_alert_sound{is_optional, read_string()};
+		}
+		else {
+			m_reader.fail();
+		}
+
+		result.volume = read_optional([this]() { return read_integer(); });
+		result.origin = read_origin();
+		return result;
+	}
+
+	lang::action_set read_action_set()
+	{
+		lang::action_set result;
+		result.text_color = read_optional([this]() { return read_color_action(); });
+		result.border_color = read_optional([this]() { return read_color_action(); });
+		result.background_color = read_optional([this]() { return read_color_action(); });
+		result.font_size = read_optional([this]() { return read_font_size_action(); });
+		result.effect = read_optional([this]() { return read_play_effect_action(); });
+		result.minimap_icon = read_optional([this]() { return read_minimap_icon_action(); });
+		result.alert_sound = read_optional([this]() { return read_alert_sound_action(); });
+		result.switch_drop_sound = read_optional([this]() { return read_switch_drop_sound_action(); });
+		result.switch_drop_sound_if_alert_sound = read_optional([this]() { return read_switch_drop_sound_action(); });
+		return result;
+	}
+
+	// ---- conditions ----
+
+	// empty on failure
+	lang::official_condition_value read_condition()
+	{
+		const auto kind = m_reader.read_enum(condition_kind::socket_specification);
+		const auto property = m_reader.read_enum(property_t::transfigured_gem);
+		const lang::position_tag origin = read_origin();
+		if (m_reader.failed())
+			return nullptr;
+
+		switch (kind) {
+			case condition_kind::boolean: {
+				const lang::boolean value = read_boolean();
+				if (const auto factory = find_boolean_condition_factory(property); factory != nullptr)
+					return factory(value, origin);
+
+				return nullptr;
+			}
+			case condition_kind::has_influence: {
+				const lang::influence_spec spec = read_influence_spec();
+				if (property != property_t::has_influence)
+					return nullptr;
+
+				return lang::make_has_influence_condition(spec, m_reader.read_bool(), origin);
+			}
+			case condition_kind::rarity_range_bound: {
+				const auto bound = read_range_bound<lang::rarity>([this]() { return read_rarity(); });
+				if (property != property_t::rarity)
+					return nullptr;
+
+				return lang::make_rarity_range_bound_condition(bound, m_reader.read_bool(), origin);
+			}
+			case condition_kind::rarity_value_list: {
+				auto values = read_values<lang::rarity>([this]() { return read_rarity(); });
+				if (property != property_t::rarity)
+					return nullptr;
+
+				return lang::make_rarity_value_list_condition(std::move(values), m_reader.read_bool(), origin);
+			}
+			case condition_kind::integer_range_bound: {
+				const auto bound = read_range_bound<lang::integer>([this]() { return read_integer(); });
+				if (const auto factory = find_integer_condition_factories(property).range_bound; factory != nullptr)
+					return factory(bound, m_reader.read_bool(), origin);
+
+				return nullptr;
+			}
+			case condition_kind::integer_value_list: {
+				auto values = read_values<lang::integer>([this]() { return read_integer(); });
+				if (const auto factory = find_integer_condition_factories(property).value_list; factory != nullptr)
+					return factory(std::move(values), m_reader.read_bool(), origin);
+
+				return nullptr;
+			}
+			case condition_kind::string_comparison: {
+				const auto cmp = m_reader.read_enum(lang::equality_comparison_type::not_equal);
+				auto values = read_values<lang::string>([this]() { return read_string(); });
+				if (const auto factory = find_string_comparison_condition_factory(property); factory != nullptr)
+					return factory(cmp, std::move(values), origin);
+
+				return nullptr;
+			}
+			case condition_kind::counted_string_comparison: {
+				const auto cmp = m_reader.read_enum(lang::comparison_type::not_equal);
+				const auto count = read_optional([this]() { return read_integer(); });
+				auto values = read_values<lang::string>([this]() { return read_string(); });
+				if (const auto factory = find_counted_string_comparison_condition_factory(property); factory != nullptr)
+					return factory(cmp, count, std::move(values), origin);
+
+				return nullptr;
+			}
+			case condition_kind::socket_specification: {
+				const auto cmp = m_reader.read_enum(lang::comparison_type::not_equal);
+				auto values = read_values<lang::socket_spec>([this]() { return read_socket_spec(); });
+				if (property == property_t::sockets)
+					return lang::make_sockets_condition(cmp, std::move(values), origin);
+				else if (property == property_t::socket_group)
+					return lang::make_socket_group_condition(cmp, std::move(values), origin);
+
+				return nullptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	lang::official_conditions read_conditions()
+	{
+		lang::official_conditions result;
+
+		const std::size_t num_conditions = m_reader.read_size();
+		result.conditions.reserve(num_conditions);
+		for (std::size_t i = 0; i < num_conditions; ++i) {
+			lang::official_condition_value condition = read_condition();
+			if (!condition) {
+				m_reader.fail();
+				return result;
+			}
+
+			result.conditions.push_back(std::move(condition));
+		}
+
+		const std::size_t order_size = m_reader.read_size();
+		if (order_size != 0 && order_size != num_conditions) {
+			m_reader.fail();
+			return result;
+		}
+
+		result.evaluation_order.reserve(order_size);
+		for (std::size_t i = 0; i < order_size; ++i) {
+			const std::uint32_t index = m_reader.read_u32();
+			if (index >= num_conditions)
+				m_reader.fail();
+
+			result.evaluation_order.push_back(index);
+		}
+
+		return result;
+	}
+
+	// ---- blocks ----
+
+	lang::import_block read_import_block()
+	{
+		lang::string path = read_string();
+		const bool is_optional = m_reader.read_bool();
+		return lang::import_block{std::move(path), is_optional, read_origin()};
+	}
+
+	// empty on failure
+	std::optional<lang::spirit_item_filter_block> read_spirit_item_filter_block(settings st)
+	{
+		const auto policy = m_reader.read_enum(lang::item_visibility_policy::discard);
+		const lang::item_visibility visibility{policy, read_origin()};
+		lang::official_conditions conditions = read_conditions();
+		lang::action_set actions = read_action_set();
+		const lang::block_continuation continuation{read_optional([this]() { return read_origin(); })};
+
+		lang::spirit_item_filter_block result{
+			lang::item_filter_block(visibility, std::move(conditions), std::move(actions), continuation),
+			std::nullopt};
+
+		if (!m_reader.read_bool())
+			return result;
+
+		const auto category = lang::autogen_category::_from_integral_nothrow(m_reader.read_i32());
+		const std::optional<lang::price_bound> lower_bound = read_optional([this]() { return read_price_bound(); });
+		const std::optional<lang::price_bound> upper_bound = read_optional([this]() { return read_price_bound(); });
+		const lang::position_tag autogen_origin = read_origin();
+		if (!category || m_reader.failed())
+			return std::nullopt;
+
+		lang::price_range_condition price_range;
+		if (lower_bound)
+			price_range.set_lower_bound((*lower_bound).bound, (*lower_bound).origin);
+		if (upper_bound)
+			price_range.set_upper_bound((*upper_bound).bound, (*upper_bound).origin);
+
+		// diagnostics of the block were stored with the original compilation
+		diagnostics_store diagnostics;
+		auto func = detail::make_autogen_func(
+			st,
+			result.block.conditions,
+			price_range,
+			detail::autogen_protocondition{*category, autogen_origin},
+			visibility.origin,
+			diagnostics);
+
+		if (!func)
+			return std::nullopt;
+
+		result.autogen = lang::autogen_extension{std::move(func), price_range, *category, autogen_origin};
+		return result;
+	}
+
+	diagnostic_message read_diagnostic_message()
+	{
+		diagnostic_message result;
+		result.severity = m_reader.read_enum(diagnostic_message_severity::error);
+		result.id = m_reader.read_enum(diagnostic_message_id::minor_note);
+		if (m_reader.read_bool())
+			result.origin = read_origin();
+		result.description = m_reader.read_string();
+		return result;
+	}
+
+private:
+	reader m_reader;
+	parser::detail::position_cache_type& m_positions;
+};
+
+} // namespace
+
+std::uint64_t make_template_cache_key(std::string_view source, settings st)
+{
+	// Only settings which affect the spirit_filter_representation are hashed.
+	// Style overrides and block optimizations are applied to generated filters.
+	const version::version_triplet v = version::current();
+
+	hasher h;
+	h.add(std::uint64_t{format_version});
+	h.add(static_cast<std::uint64_t>(v.major));
+	h.add(static_cast<std::uint64_t>(v.minor));
+	h.add(static_cast<std::uint64_t>(v.patch));
+	h.add(std::uint64_t{st.ruthless_mode});
+	h.add(std::uint64_t{st.error_handling.stop_on_error});
+	h.add(std::uint64_t{st.error_handling.treat_warnings_as_errors});
+	h.add(static_cast<std::uint64_t>(source.size()));
+	h.add(source);
+	return h.result();
+}
+
+std::optional<std::string>
+serialize_spirit_filter(const spirit_filter_compilation& compilation, std::uint64_t key)
+{
+	filter_writer fw(compilation.metadata);
+	writer& w = fw.bytes();
+	w.write_bytes(magic);
+	w.write_u32(format_version);
+	w.write_u64(key);
+	w.write_bool(compilation.filter.is_ruthless);
+
+	w.write_size(compilation.filter.blocks.size());
+	for (const lang::spirit_block_variant& block : compilation.filter.blocks) {
+		const bool written = std::visit(utility::visitor{
+			[&](const lang::import_block& b) {
+				fw.write(b);
+				return true;
+			},
+			[&](const lang::spirit_item_filter_block& b) {
+				return fw.write(b);
+			}
+		}, block);
+
+		if (!written)
+			return std::nullopt;
+	}
+
+	w.write_size(compilation.diagnostics.size());
+	for (std::size_t i = 0; i < compilation.diagnostics.size(); ++i)
+		fw.write(compilation.diagnostics[i]);
+
+	return w.release();
+}
+
+std::optional<spirit_filter_compilation>
+deserialize_spirit_filter(
+	std::string_view data,
+	std::string_view source,
+	std::uint64_t expected_key,
+	settings st,
+	log::logger& logger)
+{
+	const parser::iterator_type first = source.data();
+	const parser::iterator_type last = source.data() + source.size();
+	parser::detail::position_cache_type positions(first, last);
+	filter_reader fr(data, positions);
+	reader& r = fr.bytes();
+
+	const std::string_view file_magic = r.read_bytes(magic.size());
+	const std::uint32_t file_format_version = r.read_u32();
+	const std::uint64_t file_key = r.read_u64();
+	const bool is_ruthless = r.read_bool();
+
+	if (r.failed() || file_magic != magic || file_format_version != format_version
+		|| file_key != expected_key || is_ruthless != st.ruthless_mode)
+	{
+		return std::nullopt;
+	}
+
+	std::vector<lang::spirit_block_variant> blocks;
+	const std::size_t num_blocks = r.read_size();
+	blocks.reserve(num_blocks);
+	for (std::size_t i = 0; i < num_blocks; ++i) {
+		const auto kind = r.read_enum(block_kind::item_filter_block);
+		if (r.failed())
+			return std::nullopt;
+
+		if (kind == block_kind::import) {
+			blocks.emplace_back(fr.read_import_block());
+			continue;
+		}
+
+		std::optional<lang::spirit_item_filter_block> block = fr.read_spirit_item_filter_block(st);
+		if (!block)
+			return std::nullopt;
+
+		blocks.emplace_back(std::move(*block));
+	}
+
+	diagnostics_store diagnostics;
+	const std::size_t num_messages = r.read_size();
+	for (std::size_t i = 0; i < num_messages; ++i)
+		diagnostics.push_message(fr.read_diagnostic_message());
+
+	if (r.failed() || !r.at_end())
+		return std::nullopt;
+
+	logger.info() << "Loaded compiled filter template from cache.\n";
+	return spirit_filter_compilation{
+		lang::spirit_item_filter(is_ruthless, std::move(blocks)),
+		std::move(diagnostics),
+		parser::parse_metadata{parser::lookup_data(std::move(positions)), parser::line_lookup(first, last)}};
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+#include <fs/log/logger.hpp>
+#include <fs/parser/parser.hpp>
+#include <fs/compiler/compiler.hpp>
+#include <fs/compiler/diagnostics.hpp>
+#include <fs/compiler/settings.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fs::compiler
+{
+
+// Binary cache of spirit_filter_representation, to skip parsing and compiling
+// a filter template which has not changed since the last generation.
+//
+// Blocks are stored as their conditions, actions and autogeneration extensions.
+// Origins are stored as offsets into the template source so that diagnostics
+// of the original compilation (also stored) can be output again without
+// parsing the template.
+
+// changes whenever the template, relevant settings or program version change
+[[nodiscard]] std::uint64_t
+make_template_cache_key(std::string_view source, settings st);
+
+// spirit_filter_compilation => binary cache contents
+// (nothing if the filter contains a condition type this file does not know)
+[[nodiscard]] std::optional<std::string>
+serialize_spirit_filter(const spirit_filter_compilation& compilation, std::uint64_t key);
+
+// binary cache contents + template source it was made from => spirit_filter_compilation
+// (nothing if data is malformed or was made for a different key, origins refer
+// to the source which must outlive the result)
+[[nodiscard]] std::optional<spirit_filter_compilation>
+deserialize_spirit_filter(
+	std::string_view data,
+	std::string_view source,
+	std::uint64_t expected_key,
+	settings st,
+	log::logger& logger);
+
+}
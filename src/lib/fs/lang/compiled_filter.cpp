@@ -0,0 +1,538 @@
+#include <fs/lang/compiled_filter.hpp>
+#include <fs/lang/condition_order.hpp>
+#include <fs/lang/conditions.hpp>
+#include <fs/lang/item.hpp>
+#include <fs/utility/assert.hpp>
+#include <fs/utility/exceptions.hpp>
+#include <fs/utility/string_helpers.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <string_view>
+#include <variant>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+// nullptr if the item has no such property
+[[nodiscard]] const std::string*
+read_string_property(const item& itm, official_condition_property property)
+{
+	using ocp = official_condition_property;
+
+	switch (property) {
+		case ocp::class_:
+			return &itm.class_;
+		case ocp::base_type:
+			return &itm.base_type;
+		case ocp::enchantment_passive_node:
+			return itm.enchantment_cluster_jewel ? &*itm.enchantment_cluster_jewel : nullptr;
+		case ocp::archnemesis_mod:
+			return itm.archnemesis_mod ? &*itm.archnemesis_mod : nullptr;
+		case ocp::transfigured_gem:
+			// the name is only tested for items that are transfigured gems
+			return itm.is_transfigured_gem ? &itm.base_type : nullptr;
+		default:
+			break;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+[[nodiscard]] string_id
+read_string_id_property(const item& itm, const prepared_item& prepared, official_condition_property property)
+{
+	using ocp = official_condition_property;
+
+	switch (property) {
+		case ocp::class_:
+			return prepared.class_;
+		case ocp::base_type:
+			return prepared.base_type;
+		case ocp::enchantment_passive_node:
+			return prepared.enchantment_passive_node;
+		case ocp::archnemesis_mod:
+			return prepared.archnemesis_mod;
+		case ocp::transfigured_gem:
+			return itm.is_transfigured_gem ? prepared.base_type : string_table::npos;
+		default:
+			break;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+[[nodiscard]] int
+count_string_matches(const item& itm, const compiled_condition& cond, const compiled_filter& filter)
+{
+	const bool exact_match = cond.comparison == comparison_type::exact_match;
+	const auto first = filter.strings.begin() + cond.first;
+	const auto last = first + cond.count;
+
+	if (cond.property == official_condition_property::has_explicit_mod) {
+		int result = 0;
+		for (auto it = first; it != last; ++it) {
+			for (const std::string& mod : itm.explicit_mods) {
+				if (utility::compare_strings_ignore_diacritics(*it, mod, exact_match))
+					++result;
+			}
+		}
+
+		return result;
+	}
+
+	if (cond.property == official_condition_property::has_enchantment) {
+		if (!itm.enchantment_labyrinth)
+			return 0;
+
+		return static_cast<int>(std::count_if(first, last, [&](const std::string& str) {
+			return utility::compare_strings_ignore_diacritics(str, *itm.enchantment_labyrinth, exact_match);
+		}));
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+// bits which the condition requires to be (care, want) or nothing if it can not be expressed so
+[[nodiscard]] std::optional<std::pair<std::uint32_t, std::uint32_t>>
+to_flags_requirement(const compiled_condition& cond)
+{
+	if (cond.test == compiled_test::boolean) {
+		const std::uint32_t bit = item_flag_mask(cond.property);
+		return std::make_pair(bit, cond.flag ? bit : 0u);
+	}
+
+	if (cond.test == compiled_test::influence) {
+		const auto influences = static_cast<std::uint32_t>(cond.min);
+
+		if (cond.max == 1) // None
+			return std::make_pair(influence_flags_mask, 0u);
+
+		// exact match requires all listed influences, non-exact with 1 influence is the same
+		const bool is_single = influences != 0 && (influences & (influences - 1u)) == 0;
+		if (cond.flag || is_single)
+			return std::make_pair(influences, influences);
+	}
+
+	return std::nullopt;
+}
+
+/*
+ * Replaces boolean conditions and influence conditions that require specific influences
+ * with 1 flags test, placed where the first of them was. Conflicting requirements
+ * (e.g. Identified True and Identified False) produce a dead condition instead.
+ */
+void fold_flag_conditions(std::size_t first_condition, compiled_filter& output)
+{
+	std::uint32_t care = 0;
+	std::uint32_t want = 0;
+	bool is_contradiction = false;
+	std::optional<std::size_t> fold_position;
+
+	std::size_t out = first_condition;
+	for (std::size_t i = first_condition; i < output.conditions.size(); ++i) {
+		const compiled_condition cond = output.conditions[i];
+		const auto requirement = to_flags_requirement(cond);
+
+		if (!requirement) {
+			output.conditions[out++] = cond;
+			continue;
+		}
+
+		if (!fold_position) {
+			fold_position = out++;
+			output.conditions[*fold_position] = cond; // keeps the property of the first folded condition
+		}
+
+		const auto [new_care, new_want] = *requirement;
+		if (((want ^ new_want) & care & new_care) != 0)
+			is_contradiction = true;
+
+		care |= new_care;
+		want |= new_want;
+	}
+
+	output.conditions.resize(out);
+
+	if (!fold_position)
+		return;
+
+	compiled_condition& folded = output.conditions[*fold_position];
+	if (is_contradiction) {
+		folded.test = compiled_test::never;
+	}
+	else {
+		folded.test = compiled_test::flags;
+		folded.min = static_cast<int>(care);
+		folded.max = static_cast<int>(want);
+	}
+}
+
+void compile_block(const item_filter_block& block, compiled_filter& output)
+{
+	// invalid blocks never match any item
+	if (!block.is_valid())
+		return;
+
+	const auto first_condition = static_cast<std::uint32_t>(output.conditions.size());
+
+	// compiled filters exist to be evaluated: blocks which were not given
+	// an order (e.g. from sample items) are tested cheapest conditions first
+	const official_conditions& conditions = block.conditions;
+	const std::vector<std::uint32_t> order = conditions.evaluation_order.empty()
+		? static_condition_order(conditions)
+		: conditions.evaluation_order;
+
+	for (std::size_t i = 0; i < conditions.conditions.size(); ++i) {
+		[[maybe_unused]] const auto size_before = output.conditions.size();
+		const official_condition& condition = order.empty() ? *conditions.conditions[i] : *conditions.conditions[order[i]];
+		condition.compile(output);
+		FS_ASSERT(output.conditions.size() == size_before + 1u);
+	}
+
+	fold_flag_conditions(first_condition, output);
+
+	output.blocks.push_back(compiled_block{
+		first_condition,
+		static_cast<std::uint32_t>(output.conditions.size()) - first_condition,
+		to_item_visibility_style(block.visibility),
+		block.continuation.origin.has_value(),
+		block.actions
+	});
+}
+
+} // namespace
+
+int read_integer_property(const item& itm, official_condition_property property, int area_level)
+{
+	using ocp = official_condition_property;
+
+	switch (property) {
+		case ocp::rarity:
+			return static_cast<int>(itm.rarity_);
+		case ocp::item_level:
+			return itm.item_level;
+		case ocp::drop_level:
+			return itm.drop_level;
+		case ocp::quality:
+			return itm.quality;
+		case ocp::linked_sockets:
+			return itm.linked_sockets();
+		case ocp::height:
+			return itm.height;
+		case ocp::width:
+			return itm.width;
+		case ocp::stack_size:
+			return itm.stack_size;
+		case ocp::gem_level:
+			return itm.gem_level;
+		case ocp::map_tier:
+			return itm.map_tier;
+		case ocp::area_level:
+			return area_level;
+		case ocp::corrupted_mods:
+			return itm.corrupted_mods;
+		case ocp::enchantment_passive_num:
+			return itm.enchantment_passive_num;
+		case ocp::base_armour:
+			return itm.base_armour;
+		case ocp::base_evasion:
+			return itm.base_evasion;
+		case ocp::base_energy_shield:
+			return itm.base_energy_shield;
+		case ocp::base_ward:
+			return itm.base_ward;
+		case ocp::base_defence_percentile:
+			return itm.base_defence_percentile;
+		case ocp::has_searing_exarch_implicit:
+			return itm.implicit_exarch_value();
+		case ocp::has_eater_of_worlds_implicit:
+			return itm.implicit_eater_value();
+		case ocp::memory_strands:
+			return itm.memory_strands;
+		default:
+			break;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+bool read_boolean_property(const item& itm, official_condition_property property)
+{
+	using ocp = official_condition_property;
+
+	switch (property) {
+		case ocp::identified:
+			return itm.is_identified;
+		case ocp::corrupted:
+			return itm.is_corrupted();
+		case ocp::mirrored:
+			return itm.is_mirrored;
+		case ocp::elder_item:
+			return itm.is_elder_item();
+		case ocp::shaper_item:
+			return itm.is_shaper_item();
+		case ocp::fractured_item:
+			return itm.is_fractured;
+		case ocp::synthesised_item:
+			return itm.is_synthesised;
+		case ocp::any_enchantment:
+			return itm.has_enchantment();
+		case ocp::shaped_map:
+			return itm.is_shaped_map;
+		case ocp::elder_map:
+			return itm.is_elder_map;
+		case ocp::blighted_map:
+			return itm.is_blighted_map();
+		case ocp::replica:
+			return itm.is_replica;
+		case ocp::scourged:
+			return itm.is_scourged();
+		case ocp::uber_blighted_map:
+			return itm.is_uber_blighted_map();
+		case ocp::has_implicit_mod:
+			return itm.has_implicit_mod();
+		case ocp::has_crucible_passive_tree:
+			return itm.has_crucible_passive_tree;
+		case ocp::zana_memory:
+			return itm.zana_memory;
+		case ocp::transfigured_gem:
+			return itm.is_transfigured_gem;
+		default:
+			break;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+std::uint32_t item_flag_mask(official_condition_property property)
+{
+	using ocp = official_condition_property;
+
+	// bits 0 - 5 are influences
+	switch (property) {
+		case ocp::identified:
+			return 1u << 6;
+		case ocp::corrupted:
+			return 1u << 7;
+		case ocp::mirrored:
+			return 1u << 8;
+		case ocp::elder_item:
+			return 1u << 9;
+		case ocp::shaper_item:
+			return 1u << 10;
+		case ocp::fractured_item:
+			return 1u << 11;
+		case ocp::synthesised_item:
+			return 1u << 12;
+		case ocp::any_enchantment:
+			return 1u << 13;
+		case ocp::shaped_map:
+			return 1u << 14;
+		case ocp::elder_map:
+			return 1u << 15;
+		case ocp::blighted_map:
+			return 1u << 16;
+		case ocp::replica:
+			return 1u << 17;
+		case ocp::scourged:
+			return 1u << 18;
+		case ocp::uber_blighted_map:
+			return 1u << 19;
+		case ocp::has_implicit_mod:
+			return 1u << 20;
+		case ocp::has_crucible_passive_tree:
+			return 1u << 21;
+		case ocp::zana_memory:
+			return 1u << 22;
+		case ocp::transfigured_gem:
+			return 1u << 23;
+		default:
+			break;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+std::uint32_t make_item_flags(const item& itm)
+{
+	using ocp = official_condition_property;
+
+	std::uint32_t result = static_cast<std::uint32_t>(to_influence_mask(itm.influence));
+	for (ocp property : {
+		ocp::identified, ocp::corrupted, ocp::mirrored, ocp::elder_item, ocp::shaper_item,
+		ocp::fractured_item, ocp::synthesised_item, ocp::any_enchantment, ocp::shaped_map,
+		ocp::elder_map, ocp::blighted_map, ocp::replica, ocp::scourged, ocp::uber_blighted_map,
+		ocp::has_implicit_mod, ocp::has_crucible_passive_tree, ocp::zana_memory, ocp::transfigured_gem})
+	{
+		if (read_boolean_property(itm, property))
+			result |= item_flag_mask(property);
+	}
+
+	return result;
+}
+
+bool test_compiled_condition(
+	const item& itm,
+	const prepared_item& prepared,
+	const compiled_condition& cond,
+	const compiled_filter& filter,
+	int area_level)
+{
+	switch (cond.test) {
+		case compiled_test::integer_range: {
+			const int value = read_integer_property(itm, cond.property, area_level);
+			return cond.min <= value && value <= cond.max;
+		}
+		case compiled_test::integer_list: {
+			const int value = read_integer_property(itm, cond.property, area_level);
+			const auto first = filter.integers.begin() + cond.first;
+			const auto last = first + cond.count;
+			return cond.flag == (std::find(first, last, value) != last);
+		}
+		case compiled_test::boolean: {
+			return read_boolean_property(itm, cond.property) == cond.flag;
+		}
+		case compiled_test::influence: {
+			const int item_mask = static_cast<int>(prepared.flags & influence_flags_mask);
+
+			if (cond.max == 1) // None
+				return item_mask == 0;
+
+			if (cond.flag)
+				return (item_mask & cond.min) == cond.min;
+			else
+				return (item_mask & cond.min) != 0;
+		}
+		case compiled_test::flags: {
+			return (prepared.flags & static_cast<std::uint32_t>(cond.min)) == static_cast<std::uint32_t>(cond.max);
+		}
+		case compiled_test::strings: {
+			const std::string* const item_field = read_string_property(itm, cond.property);
+			bool found = false;
+
+			if (item_field != nullptr) {
+				const bool exact_match = cond.comparison == comparison_type::exact_match;
+				const auto first = filter.strings.begin() + cond.first;
+				const auto last = first + cond.count;
+				found = std::any_of(first, last, [&](const std::string& str) {
+					return utility::compare_strings_ignore_diacritics(*item_field, str, exact_match);
+				});
+			}
+
+			return found == (cond.comparison != comparison_type::not_equal);
+		}
+		case compiled_test::string_ids: {
+			const string_id id = read_string_id_property(itm, prepared, cond.property);
+			if (id == string_table::npos)
+				return false;
+
+			const auto first = filter.string_ids.begin() + cond.first;
+			const auto last = first + cond.count;
+			return std::binary_search(first, last, id);
+		}
+		case compiled_test::substrings: {
+			const std::string* const item_field = read_string_property(itm, cond.property);
+			const bool found = item_field != nullptr && filter.substring_matchers[cond.first].matches_any(*item_field);
+			return found == (cond.comparison != comparison_type::not_equal);
+		}
+		case compiled_test::counted_strings: {
+			const int matches = count_string_matches(itm, cond, filter);
+
+			if (cond.flag)
+				return compare_integers(cond.comparison, matches, cond.min);
+			else
+				return matches > 0;
+		}
+		case compiled_test::sockets: {
+			const bool group_matters = cond.property == official_condition_property::socket_group;
+			const bool is_negative = cond.comparison == comparison_type::not_equal;
+			const auto cmp = is_negative ? comparison_type::equal : cond.comparison;
+			const auto first = filter.socket_specs.begin() + cond.first;
+			const auto last = first + cond.count;
+
+			const bool found = std::any_of(first, last, [&](socket_spec ss) {
+				return test_sockets_condition(cmp, ss, group_matters, prepared.sockets);
+			});
+
+			return is_negative != found;
+		}
+		case compiled_test::never: {
+			return false;
+		}
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+compiled_filter compile_item_filter(const item_filter& filter)
+{
+	compiled_filter result;
+	result.blocks.reserve(filter.blocks.size());
+
+	for (const block_variant& bv : filter.blocks) {
+		// import blocks are not evaluated
+		if (const auto* block = std::get_if<item_filter_block>(&bv); block != nullptr)
+			compile_block(*block, result);
+	}
+
+	return result;
+}
+
+prepared_item prepare_item(const item& itm, const compiled_filter& filter)
+{
+	const string_table& table = filter.interned_strings;
+	prepared_item result;
+	result.class_ = table.find(itm.class_);
+	result.base_type = table.find(itm.base_type);
+
+	if (itm.enchantment_cluster_jewel)
+		result.enchantment_passive_node = table.find(*itm.enchantment_cluster_jewel);
+
+	if (itm.archnemesis_mod)
+		result.archnemesis_mod = table.find(*itm.archnemesis_mod);
+
+	result.flags = make_item_flags(itm);
+
+	if (!filter.socket_specs.empty())
+		result.sockets = itm.sockets.summary();
+
+	return result;
+}
+
+item_style pass_item_through_compiled_filter(const item& itm, const compiled_filter& filter, int area_level)
+{
+	return pass_item_through_compiled_filter(itm, prepare_item(itm, filter), filter, area_level);
+}
+
+item_style pass_item_through_compiled_filter(
+	const item& itm, const prepared_item& prepared, const compiled_filter& filter, int area_level)
+{
+	item_style style = default_item_style(itm);
+
+	for (const compiled_block& block : filter.blocks) {
+		const auto first = filter.conditions.begin() + block.first_condition;
+		const auto last = first + block.num_conditions;
+
+		const bool is_successful = std::all_of(first, last, [&](const compiled_condition& cond) {
+			return test_compiled_condition(itm, prepared, cond, filter, area_level);
+		});
+
+		if (!is_successful)
+			continue;
+
+		style.override_with(block.actions);
+		style.visibility = block.visibility;
+
+		if (!block.is_continue)
+			break;
+	}
+
+	return style;
+}
+
+}
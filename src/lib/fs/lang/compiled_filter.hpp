@@ -0,0 +1,173 @@
+#pragma once
+
+#include <fs/lang/enum_types.hpp>
+#include <fs/lang/primitive_types.hpp>
+#include <fs/lang/action_set.hpp>
+#include <fs/lang/influence_info.hpp>
+#include <fs/lang/item_filter.hpp>
+#include <fs/lang/string_table.hpp>
+#include <fs/utility/substring_matcher.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fs::lang
+{
+
+struct item;
+
+/*
+ * Compiled filter is an evaluation-only form of item_filter.
+ *
+ * item_filter is optimized for printing and debugging: every condition is a separate
+ * heap object tested through a virtual call and every test produces match results with
+ * origins. This is too slow for bulk item evaluation (loot simulations, statistics).
+ *
+ * Compiled filter stores all conditions of all blocks in 1 contiguous array.
+ * Each condition is a small trivially-copyable op which identifies the tested
+ * item property and holds its operands inline. Variable-length operands
+ * (value lists, strings, socket specs) are stored in shared pools and
+ * referenced by index ranges. Import blocks and invalid blocks are dropped
+ * as they can never match.
+ *
+ * Exact (==) string conditions are compiled to sorted lists of interned string IDs.
+ * Item strings are interned once per item (see prepared_item) and then each such
+ * condition is a binary search over integers instead of a series of string comparisons.
+ * Non-exact string conditions are compiled to substring matchers which test all values
+ * of a condition in a single pass over the item's string.
+ *
+ * Boolean properties and influences of an item are packed into 1 bit mask, also once
+ * per item. All boolean conditions of a block and influence conditions which require
+ * specific influences are folded into 1 flags test: (item flags & care) == want.
+ *
+ * The compiled form does not reference the source item_filter - it can be safely
+ * used after the source filter is destroyed.
+ */
+
+enum class compiled_test : std::uint8_t
+{
+	integer_range,   // min <= value <= max
+	integer_list,    // value is (flag = true) or is not (flag = false) one of integer pool [first, first + count)
+	boolean,         // value == flag
+	influence,       // min = influence bit mask, max = 1 for None, flag = exact match (==)
+	flags,           // (item flags & min) == max, see item_flag_mask
+	strings,         // comparison with string pool [first, first + count)
+	string_ids,      // exact (==) comparison, value is one of sorted string ID pool [first, first + count)
+	substrings,      // non-exact comparison with substring matcher pool [first]
+	counted_strings, // counted comparison with string pool [first, first + count), flag = has count, min = count
+	sockets,         // comparison with socket spec pool [first, first + count)
+	never            // dead condition, nothing matches
+};
+
+// 1 bit per influence, in the order of influence_type
+constexpr int to_influence_mask(influence_info info) noexcept
+{
+	return (info.shaper   ? 1 << 0 : 0)
+		| (info.elder    ? 1 << 1 : 0)
+		| (info.crusader ? 1 << 2 : 0)
+		| (info.redeemer ? 1 << 3 : 0)
+		| (info.hunter   ? 1 << 4 : 0)
+		| (info.warlord  ? 1 << 5 : 0);
+}
+
+constexpr int to_influence_mask(const influence_spec& spec) noexcept
+{
+	return to_influence_mask(influence_info{
+		spec.shaper.has_value(),
+		spec.elder.has_value(),
+		spec.crusader.has_value(),
+		spec.redeemer.has_value(),
+		spec.hunter.has_value(),
+		spec.warlord.has_value()});
+}
+
+// Bit of the given boolean property in item flags (see prepared_item).
+// Influences occupy the lowest bits, in the same order as in to_influence_mask.
+[[nodiscard]] std::uint32_t item_flag_mask(official_condition_property property);
+
+constexpr std::uint32_t influence_flags_mask = (1u << 6) - 1u;
+
+struct compiled_condition
+{
+	compiled_test test;
+	official_condition_property property;
+	comparison_type comparison = comparison_type::equal;
+	bool flag = false;
+	int min = 0;
+	int max = 0;
+	std::uint32_t first = 0;
+	std::uint32_t count = 0;
+};
+
+struct compiled_block
+{
+	std::uint32_t first_condition;
+	std::uint32_t num_conditions;
+	item_visibility_style visibility;
+	bool is_continue;
+	action_set actions;
+};
+
+struct compiled_filter
+{
+	std::vector<compiled_block> blocks;
+	std::vector<compiled_condition> conditions;
+
+	// operand pools
+	std::vector<int> integers;
+	std::vector<std::string> strings;
+	std::vector<string_id> string_ids;
+	std::vector<utility::substring_matcher> substring_matchers;
+	std::vector<socket_spec> socket_specs;
+
+	// strings referenced by string_ids
+	string_table interned_strings;
+};
+
+// Properties of an item computed once before it is passed through a compiled filter.
+struct prepared_item
+{
+	// Item strings which can be tested by exact string conditions, as IDs of the
+	// filter's string table. string_table::npos if the item has no such property
+	// or no condition in the filter has such string.
+	string_id class_ = string_table::npos;
+	string_id base_type = string_table::npos;
+	string_id enchantment_passive_node = string_table::npos;
+	string_id archnemesis_mod = string_table::npos;
+
+	// influences and boolean properties, see item_flag_mask
+	std::uint32_t flags = 0;
+
+	// only computed if the filter has Sockets or SocketGroup conditions
+	socket_summary sockets;
+};
+
+// conditions are compiled in evaluation order, see condition_order.hpp
+[[nodiscard]] compiled_filter compile_item_filter(const item_filter& filter);
+
+// Property reads as done by compiled conditions. Throw on properties of other types.
+[[nodiscard]] int read_integer_property(const item& itm, official_condition_property property, int area_level);
+[[nodiscard]] bool read_boolean_property(const item& itm, official_condition_property property);
+
+// result of a single condition of the filter
+[[nodiscard]] bool test_compiled_condition(
+	const item& itm,
+	const prepared_item& prepared,
+	const compiled_condition& cond,
+	const compiled_filter& filter,
+	int area_level);
+
+// equivalent of pass_item_through_filter(...).style
+[[nodiscard]] item_style pass_item_through_compiled_filter(const item& itm, const compiled_filter& filter, int area_level);
+
+[[nodiscard]] std::uint32_t make_item_flags(const item& itm);
+
+[[nodiscard]] prepared_item prepare_item(const item& itm, const compiled_filter& filter);
+
+// equivalent of pass_item_through_compiled_filter(itm, filter, area_level) with the item
+// prepared up front, for callers which pass the same item multiple times
+[[nodiscard]] item_style pass_item_through_compiled_filter(
+	const item& itm, const prepared_item& prepared, const compiled_filter& filter, int area_level);
+
+}
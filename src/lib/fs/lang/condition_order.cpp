@@ -0,0 +1,157 @@
+#include <fs/lang/condition_order.hpp>
+#include <fs/lang/item.hpp>
+#include <fs/utility/exceptions.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <variant>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+/*
+ * Sorts conditions by expected cost of rejecting an item. For independent
+ * conditions, testing them in ascending order of cost / failure rate
+ * minimizes average cost of testing a block. Ties keep source order.
+ * Returns empty order if source order is already the best.
+ */
+template <typename FailureRate>
+std::vector<std::uint32_t> make_evaluation_order(const official_conditions& conditions, FailureRate failure_rate)
+{
+	const std::size_t num_conditions = conditions.conditions.size();
+
+	if (num_conditions < 2u)
+		return {};
+
+	std::vector<double> ranks(num_conditions);
+	for (std::size_t i = 0; i < num_conditions; ++i)
+		ranks[i] = condition_test_cost(conditions.conditions[i]->tested_property()) / failure_rate(i);
+
+	std::vector<std::uint32_t> order(num_conditions);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+		return ranks[lhs] < ranks[rhs];
+	});
+
+	// source order needs no permutation
+	if (std::is_sorted(order.begin(), order.end()))
+		return {};
+
+	return order;
+}
+
+} // namespace
+
+int condition_test_cost(official_condition_property property)
+{
+	using ocp = official_condition_property;
+
+	switch (property) {
+		// direct field reads
+		case ocp::identified:
+		case ocp::mirrored:
+		case ocp::fractured_item:
+		case ocp::synthesised_item:
+		case ocp::shaped_map:
+		case ocp::elder_map:
+		case ocp::replica:
+		case ocp::has_crucible_passive_tree:
+		case ocp::zana_memory:
+		case ocp::alternate_quality:
+		case ocp::rarity:
+		case ocp::item_level:
+		case ocp::drop_level:
+		case ocp::quality:
+		case ocp::height:
+		case ocp::width:
+		case ocp::stack_size:
+		case ocp::gem_level:
+		case ocp::map_tier:
+		case ocp::area_level:
+		case ocp::corrupted_mods:
+		case ocp::enchantment_passive_num:
+		case ocp::base_armour:
+		case ocp::base_evasion:
+		case ocp::base_energy_shield:
+		case ocp::base_ward:
+		case ocp::base_defence_percentile:
+		case ocp::has_searing_exarch_implicit:
+		case ocp::has_eater_of_worlds_implicit:
+		case ocp::memory_strands:
+			return 1;
+		// simple computations
+		case ocp::corrupted:
+		case ocp::elder_item:
+		case ocp::shaper_item:
+		case ocp::any_enchantment:
+		case ocp::blighted_map:
+		case ocp::scourged:
+		case ocp::uber_blighted_map:
+		case ocp::has_implicit_mod:
+		case ocp::has_influence:
+			return 2;
+		// iterates over socket groups
+		case ocp::linked_sockets:
+			return 3;
+		// string comparisons
+		case ocp::transfigured_gem:
+		case ocp::class_:
+		case ocp::base_type:
+		case ocp::enchantment_passive_node:
+		case ocp::archnemesis_mod:
+			return 8;
+		// socket specs have complex rules and are tested against every socket group
+		case ocp::sockets:
+		case ocp::socket_group:
+			return 12;
+		// string comparisons against every mod of the item
+		case ocp::has_explicit_mod:
+		case ocp::has_enchantment:
+			return 20;
+	}
+
+	throw unhandled_switch_case(__FILE__, __LINE__, __func__);
+}
+
+std::vector<std::uint32_t> static_condition_order(const official_conditions& conditions)
+{
+	// same as no sample items in the other overload
+	return make_evaluation_order(conditions, [](std::size_t) { return 0.5; });
+}
+
+void optimize_condition_order(item_filter& filter)
+{
+	optimize_condition_order(filter, {}, 0);
+}
+
+void optimize_condition_order(item_filter& filter, const std::vector<item>& sample_items, int area_level)
+{
+	for (block_variant& bv : filter.blocks) {
+		auto* const block = std::get_if<item_filter_block>(&bv);
+		if (block == nullptr)
+			continue;
+
+		official_conditions& conditions = block->conditions;
+
+		// number of sample items which failed each condition
+		std::vector<std::size_t> num_failures(conditions.conditions.size(), 0u);
+		for (std::size_t i = 0; i < conditions.conditions.size(); ++i) {
+			for (const item& itm : sample_items) {
+				if (!conditions.conditions[i]->test_item(itm, area_level).is_successful())
+					++num_failures[i];
+			}
+		}
+
+		// Laplace smoothing: no samples give 0.5 for every condition,
+		// conditions that never fail in samples still get a small rate
+		conditions.evaluation_order = make_evaluation_order(conditions, [&](std::size_t i) {
+			return (num_failures[i] + 1.0) / (sample_items.size() + 2.0);
+		});
+	}
+}
+
+}
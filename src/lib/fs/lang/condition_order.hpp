@@ -0,0 +1,46 @@
+#pragma once
+
+#include <fs/lang/enum_types.hpp>
+#include <fs/lang/item_filter.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace fs::lang
+{
+
+struct item;
+
+/*
+ * Evaluation-only optimization of item filters.
+ *
+ * A block fails as soon as any of its conditions fails, so it is best to
+ * first test conditions that are cheap and likely to fail. Filters are
+ * written for readability - Class and BaseType usually come first even
+ * though testing Rarity or ItemLevel is much cheaper.
+ *
+ * These functions fill official_conditions::evaluation_order of each block.
+ * Conditions are not moved: printing and match results (filter debug) are
+ * not affected. The order is used by item_filter_block::matches and by
+ * compile_item_filter, which orders blocks without one by static cost itself.
+ */
+
+// relative cost of testing a condition on given property (1 = reading an integer field)
+[[nodiscard]] int condition_test_cost(official_condition_property property);
+
+// evaluation order of given conditions by their static cost only (empty if source order is the best)
+[[nodiscard]] std::vector<std::uint32_t> static_condition_order(const official_conditions& conditions);
+
+// order conditions by their static cost only
+void optimize_condition_order(item_filter& filter);
+
+/*
+ * Order conditions by cost and by how often they fail for given items.
+ * Each condition is tested on all sample items so that its failure rate
+ * does not depend on other conditions in the block. Sample items should
+ * be representative of items which will be filtered (e.g. a loot simulation).
+ * With no sample items this is equivalent to optimize_condition_order(filter).
+ */
+void optimize_condition_order(item_filter& filter, const std::vector<item>& sample_items, int area_level);
+
+}
@@ -1,17 +1,24 @@
 #include <fs/lang/position_tag.hpp>
 #include <fs/lang/primitive_types.hpp>
 #include <fs/lang/conditions.hpp>
+#include <fs/lang/compiled_filter.hpp>
 #include <fs/lang/keywords.hpp>
 #include <fs/utility/assert.hpp>
 #include <fs/utility/string_helpers.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <numeric>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace fs::lang
 {
@@ -237,15 +244,48 @@ test_color_count(int req, comparison_type comparison, int item_stat)
 	return std::nullopt;
 }
 
+[[nodiscard]] int
+color_count(const socket_summary::counts& counts, socket_color c)
+{
+	return counts.colors[static_cast<std::size_t>(c)];
+}
+
+// AND of all requirements, unspecified colors pass
 [[nodiscard]] bool
-test_color_count_all_groups(const socket_info& item_sockets, socket_color c, int req, comparison_type comparison)
+test_all_requirements(socket_spec ss, comparison_type comparison, int num, const socket_summary::counts& counts)
 {
-	for (const linked_sockets& group : item_sockets.groups) {
-		if (test_color_count(req, comparison, group.count_of(c)).value_or(false))
-			return true;
-	}
+	return test_socket_or_link_count(ss.num, comparison, num)
+		&& test_color_count(ss.r, comparison, color_count(counts, socket_color::r)).value_or(true)
+		&& test_color_count(ss.g, comparison, color_count(counts, socket_color::g)).value_or(true)
+		&& test_color_count(ss.b, comparison, color_count(counts, socket_color::b)).value_or(true)
+		&& test_color_count(ss.w, comparison, color_count(counts, socket_color::w)).value_or(true)
+		&& test_color_count(ss.a, comparison, color_count(counts, socket_color::a)).value_or(true)
+		&& test_color_count(ss.d, comparison, color_count(counts, socket_color::d)).value_or(true);
+}
 
-	return false;
+[[nodiscard]] bool
+test_color_count_any_group(
+	socket_color c,
+	int req,
+	comparison_type comparison,
+	const socket_summary::counts* groups_first,
+	const socket_summary::counts* groups_last)
+{
+	return std::any_of(groups_first, groups_last, [&](const socket_summary::counts& group) {
+		return test_color_count(req, comparison, color_count(group, c)).value_or(false);
+	});
+}
+
+// OR of color requirements, unspecified colors fail
+[[nodiscard]] bool
+test_any_color_requirement(socket_spec ss, comparison_type comparison, const socket_summary::counts& counts)
+{
+	return test_color_count(ss.r, comparison, color_count(counts, socket_color::r)).value_or(false)
+		|| test_color_count(ss.g, comparison, color_count(counts, socket_color::g)).value_or(false)
+		|| test_color_count(ss.b, comparison, color_count(counts, socket_color::b)).value_or(false)
+		|| test_color_count(ss.w, comparison, color_count(counts, socket_color::w)).value_or(false)
+		|| test_color_count(ss.a, comparison, color_count(counts, socket_color::a)).value_or(false)
+		|| test_color_count(ss.d, comparison, color_count(counts, socket_color::d)).value_or(false);
 }
 
 [[nodiscard]] bool // (C)
@@ -254,87 +294,112 @@ is_sockets_condition_using_or(comparison_type comparison)
 	return comparison == comparison_type::less || comparison == comparison_type::greater;
 }
 
+template <typename T>
+std::uint32_t pool_size(const std::vector<T>& pool)
+{
+	return static_cast<std::uint32_t>(pool.size());
+}
+
+template <typename T>
+void compile_value_list(
+	official_condition_property property,
+	bool allowed,
+	const condition_values_container<T>& values,
+	compiled_filter& output)
+{
+	compiled_condition cond{compiled_test::integer_list, property};
+	cond.flag = allowed;
+	cond.first = pool_size(output.integers);
+	for (T value : values)
+		output.integers.push_back(static_cast<int>(value.value));
+	cond.count = pool_size(output.integers) - cond.first;
+	output.conditions.push_back(cond);
+}
+
+} // namespace
+
+bool compare_integers(comparison_type cmp_type, int lhs, int rhs)
+{
+	return compare_values(cmp_type, lhs, rhs);
+}
+
 // group_matters: false for Sockets, true for SocketGroup
 // comparison: should not be != because:
 // 1) Correct implementation is not just another switch case.
 // 2) For positive conditions, at least one match is required but
 //    for negative conditions, all matches must fail.
 // Thus, a proper implementation handles != on a higher abstraction layer.
-[[nodiscard]] bool
+bool
 test_sockets_condition(
 	comparison_type comparison,
 	socket_spec ss,
 	bool group_matters,
-	const socket_info& item_sockets)
+	const socket_summary& item_sockets)
 {
 	FS_ASSERT(comparison != comparison_type::not_equal);
 
-	if (item_sockets.groups.empty()) {
-		return test_socket_or_link_count(ss.num, comparison, 0)
-			&& test_color_count(ss.r, comparison, 0).value_or(true)
-			&& test_color_count(ss.g, comparison, 0).value_or(true)
-			&& test_color_count(ss.b, comparison, 0).value_or(true)
-			&& test_color_count(ss.w, comparison, 0).value_or(true)
-			&& test_color_count(ss.a, comparison, 0).value_or(true)
-			&& test_color_count(ss.d, comparison, 0).value_or(true);
-	}
+	if (item_sockets.num_groups == 0)
+		return test_all_requirements(ss, comparison, 0, socket_summary::counts{});
+
+	const socket_summary::counts* const groups_first = item_sockets.groups.data();
+	const socket_summary::counts* const groups_last = groups_first + item_sockets.num_groups;
 
 	if (group_matters) {
 		if (is_sockets_condition_using_or(comparison)) {
-			return test_socket_or_link_count(ss.num, comparison, item_sockets.links())
-				|| test_color_count_all_groups(item_sockets, socket_color::r, ss.r, comparison)
-				|| test_color_count_all_groups(item_sockets, socket_color::g, ss.g, comparison)
-				|| test_color_count_all_groups(item_sockets, socket_color::b, ss.b, comparison)
-				|| test_color_count_all_groups(item_sockets, socket_color::w, ss.w, comparison)
-				|| test_color_count_all_groups(item_sockets, socket_color::a, ss.a, comparison)
-				|| test_color_count_all_groups(item_sockets, socket_color::d, ss.d, comparison);
+			// for SocketGroup, each color may be satisfied by a different group
+			return test_socket_or_link_count(ss.num, comparison, item_sockets.max_links)
+				|| test_color_count_any_group(socket_color::r, ss.r, comparison, groups_first, groups_last)
+				|| test_color_count_any_group(socket_color::g, ss.g, comparison, groups_first, groups_last)
+				|| test_color_count_any_group(socket_color::b, ss.b, comparison, groups_first, groups_last)
+				|| test_color_count_any_group(socket_color::w, ss.w, comparison, groups_first, groups_last)
+				|| test_color_count_any_group(socket_color::a, ss.a, comparison, groups_first, groups_last)
+				|| test_color_count_any_group(socket_color::d, ss.d, comparison, groups_first, groups_last);
 		}
 		else {
-			for (const linked_sockets& group : item_sockets.groups) {
-				const bool result = test_socket_or_link_count(ss.num, comparison, static_cast<int>(group.sockets.size()))
-					&& test_color_count(ss.r, comparison, group.count_of(socket_color::r)).value_or(true)
-					&& test_color_count(ss.g, comparison, group.count_of(socket_color::g)).value_or(true)
-					&& test_color_count(ss.b, comparison, group.count_of(socket_color::b)).value_or(true)
-					&& test_color_count(ss.w, comparison, group.count_of(socket_color::w)).value_or(true)
-					&& test_color_count(ss.a, comparison, group.count_of(socket_color::a)).value_or(true)
-					&& test_color_count(ss.d, comparison, group.count_of(socket_color::d)).value_or(true);
-
-				if (result)
-					return true;
-			}
-
-			return false;
+			return std::any_of(groups_first, groups_last, [&](const socket_summary::counts& group) {
+				return test_all_requirements(ss, comparison, group.sockets, group);
+			});
 		}
 	}
 	else {
 		if (is_sockets_condition_using_or(comparison)) {
-			return test_socket_or_link_count(ss.num, comparison, item_sockets.sockets())
-				|| test_color_count(ss.r, comparison, item_sockets.count_of(socket_color::r)).value_or(false)
-				|| test_color_count(ss.g, comparison, item_sockets.count_of(socket_color::g)).value_or(false)
-				|| test_color_count(ss.b, comparison, item_sockets.count_of(socket_color::b)).value_or(false)
-				|| test_color_count(ss.w, comparison, item_sockets.count_of(socket_color::w)).value_or(false)
-				|| test_color_count(ss.a, comparison, item_sockets.count_of(socket_color::a)).value_or(false)
-				|| test_color_count(ss.d, comparison, item_sockets.count_of(socket_color::d)).value_or(false);
+			return test_socket_or_link_count(ss.num, comparison, item_sockets.total.sockets)
+				|| test_any_color_requirement(ss, comparison, item_sockets.total);
 		}
 		else {
-			return test_socket_or_link_count(ss.num, comparison, item_sockets.sockets())
-				&& test_color_count(ss.r, comparison, item_sockets.count_of(socket_color::r)).value_or(true)
-				&& test_color_count(ss.g, comparison, item_sockets.count_of(socket_color::g)).value_or(true)
-				&& test_color_count(ss.b, comparison, item_sockets.count_of(socket_color::b)).value_or(true)
-				&& test_color_count(ss.w, comparison, item_sockets.count_of(socket_color::w)).value_or(true)
-				&& test_color_count(ss.a, comparison, item_sockets.count_of(socket_color::a)).value_or(true)
-				&& test_color_count(ss.d, comparison, item_sockets.count_of(socket_color::d)).value_or(true);
+			return test_all_requirements(ss, comparison, item_sockets.total.sockets, item_sockets.total);
 		}
 	}
 }
 
-} // namespace
+bool
+test_sockets_condition(
+	comparison_type comparison,
+	socket_spec ss,
+	bool group_matters,
+	const socket_info& item_sockets)
+{
+	return test_sockets_condition(comparison, ss, group_matters, item_sockets.summary());
+}
+
+
+void boolean_condition::compile(compiled_filter& output) const
+{
+	compiled_condition cond{compiled_test::boolean, tested_property()};
+	cond.flag = value().value;
+	output.conditions.push_back(cond);
+}
 
 void boolean_condition::print(std::ostream& os) const
 {
 	print_condition(tested_property(), comparison_type::equal, value(), os);
 }
 
+void alternate_quality_condition::compile(compiled_filter& output) const
+{
+	output.conditions.push_back(compiled_condition{compiled_test::never, tested_property()});
+}
+
 condition_match_result has_influence_condition::test_item(const item& itm, int /* area_level */) const
 {
 	/*
@@ -399,6 +464,15 @@ condition_match_result has_influence_condition::test_item(const item& itm, int /
 	}
 }
 
+void has_influence_condition::compile(compiled_filter& output) const
+{
+	compiled_condition cond{compiled_test::influence, tested_property()};
+	cond.flag = m_exact_match;
+	cond.min = to_influence_mask(m_influence_spec);
+	cond.max = m_influence_spec.is_none() ? 1 : 0;
+	output.conditions.push_back(cond);
+}
+
 void has_influence_condition::print(std::ostream& os) const
 {
 	print_condition(
@@ -418,6 +492,30 @@ void range_bound_condition_base::print_impl(comparison_type comparison, integer
 	print_condition(tested_property(), comparison, bound_value, os);
 }
 
+void range_bound_condition_base::compile_impl(int bound_value, bool inclusive, bool is_lower_bound, compiled_filter& output) const
+{
+	constexpr auto int_min = std::numeric_limits<int>::min();
+	constexpr auto int_max = std::numeric_limits<int>::max();
+
+	// exclusive bounds which exclude all possible values
+	if (!inclusive && bound_value == (is_lower_bound ? int_max : int_min)) {
+		output.conditions.push_back(compiled_condition{compiled_test::never, tested_property()});
+		return;
+	}
+
+	compiled_condition cond{compiled_test::integer_range, tested_property()};
+	if (is_lower_bound) {
+		cond.min = inclusive ? bound_value : bound_value + 1;
+		cond.max = int_max;
+	}
+	else {
+		cond.min = int_min;
+		cond.max = inclusive ? bound_value : bound_value - 1;
+	}
+
+	output.conditions.push_back(cond);
+}
+
 void value_list_condition_base::print_impl(bool allowed, const condition_values_container<rarity>& values, std::ostream& os) const
 {
 	print_condition(tested_property(), allowed ? comparison_type::equal : comparison_type::not_equal, values, os);
@@ -428,28 +526,125 @@ void value_list_condition_base::print_impl(bool allowed, const condition_values_
 	print_condition(tested_property(), allowed ? comparison_type::equal : comparison_type::not_equal, values, os);
 }
 
+void value_list_condition_base::compile_impl(bool allowed, const condition_values_container<rarity>& values, compiled_filter& output) const
+{
+	compile_value_list(tested_property(), allowed, values, output);
+}
+
+void value_list_condition_base::compile_impl(bool allowed, const condition_values_container<integer>& values, compiled_filter& output) const
+{
+	compile_value_list(tested_property(), allowed, values, output);
+}
+
+utility::substring_matcher string_comparison_condition::make_matcher(
+	equality_comparison_type cmp, const container_type& values)
+{
+	if (cmp == equality_comparison_type::exact_match)
+		return {};
+
+	std::vector<std::string_view> patterns;
+	patterns.reserve(values.size());
+	for (const string& value : values)
+		patterns.push_back(value.value);
+
+	return utility::substring_matcher(patterns);
+}
+
+const string* string_comparison_condition::find_match(std::string_view item_field) const
+{
+	if (m_comparison_type == equality_comparison_type::exact_match)
+		return lang::find_match(item_field, m_values, true);
+
+	const std::size_t index = m_matcher.find_first_pattern(item_field);
+	if (index == utility::substring_matcher::npos)
+		return nullptr;
+
+	return &m_values[index];
+}
+
 bool string_comparison_condition::allows_item_class(std::string_view class_name) const
 {
 	if (tested_property() != official_condition_property::class_)
 		return true;
 
-	return find_match(class_name, m_values, m_comparison_type == equality_comparison_type::exact_match) != nullptr;
+	return find_match(class_name) != nullptr;
 }
 
 condition_match_result string_comparison_condition::test_item_impl(const std::string* item_field) const
 {
 	const string* match = nullptr;
 
-	if (item_field != nullptr) {
-		match = find_match(
-			*item_field, m_values, m_comparison_type == equality_comparison_type::exact_match);
-	}
+	if (item_field != nullptr)
+		match = find_match(*item_field);
 
 	const bool success = (match == nullptr) == (m_comparison_type == equality_comparison_type::not_equal);
 	return condition_match_result(
 		success, origin(), match == nullptr ? std::optional<position_tag>() : match->origin);
 }
 
+bool string_comparison_condition::merge_values(const official_condition& other)
+{
+	// != passes items which have none of the values, values can not be simply joined
+	const auto* const other_str = dynamic_cast<const string_comparison_condition*>(&other);
+	if (other_str == nullptr
+		|| other_str->tested_property() != tested_property()
+		|| other_str->m_comparison_type != m_comparison_type
+		|| m_comparison_type == equality_comparison_type::not_equal)
+	{
+		return false;
+	}
+
+	for (const string& value : other_str->m_values) {
+		if (std::find(m_values.begin(), m_values.end(), value) == m_values.end())
+			m_values.push_back(value);
+	}
+
+	m_matcher = make_matcher(m_comparison_type, m_values);
+	return true;
+}
+
+void string_comparison_condition::compile(compiled_filter& output) const
+{
+	// Requirements with diacritics are stricter than string ID equivalence, leave them as strings.
+	const bool can_use_ids = m_comparison_type == equality_comparison_type::exact_match
+		&& std::none_of(m_values.begin(), m_values.end(), [](const string& value) {
+			return utility::has_diacritics(value.value);
+		});
+
+	if (can_use_ids) {
+		compiled_condition cond{compiled_test::string_ids, tested_property()};
+		cond.comparison = comparison_type::exact_match;
+		cond.first = pool_size(output.string_ids);
+		for (const string& value : m_values)
+			output.string_ids.push_back(output.interned_strings.intern(value.value));
+
+		const auto first = output.string_ids.begin() + cond.first;
+		std::sort(first, output.string_ids.end());
+		output.string_ids.erase(std::unique(first, output.string_ids.end()), output.string_ids.end());
+		cond.count = pool_size(output.string_ids) - cond.first;
+		output.conditions.push_back(cond);
+		return;
+	}
+
+	if (m_comparison_type != equality_comparison_type::exact_match) {
+		compiled_condition cond{compiled_test::substrings, tested_property()};
+		cond.comparison = to_comparison_type(m_comparison_type);
+		cond.first = pool_size(output.substring_matchers);
+		output.substring_matchers.push_back(m_matcher);
+		cond.count = 1;
+		output.conditions.push_back(cond);
+		return;
+	}
+
+	compiled_condition cond{compiled_test::strings, tested_property()};
+	cond.comparison = to_comparison_type(m_comparison_type);
+	cond.first = pool_size(output.strings);
+	for (const string& value : m_values)
+		output.strings.push_back(value.value);
+	cond.count = pool_size(output.strings) - cond.first;
+	output.conditions.push_back(cond);
+}
+
 void string_comparison_condition::print(std::ostream& os) const
 {
 	print_condition(tested_property(), to_comparison_type(m_comparison_type), m_values, os);
@@ -460,6 +655,19 @@ void counted_string_comparison_condition::print(std::ostream& os) const
 	print_condition(tested_property(), m_comparison_type, m_count, m_values, os);
 }
 
+void counted_string_comparison_condition::compile(compiled_filter& output) const
+{
+	compiled_condition cond{compiled_test::counted_strings, tested_property()};
+	cond.comparison = m_comparison_type;
+	cond.flag = m_count.has_value();
+	cond.min = m_count ? (*m_count).value : 0;
+	cond.first = pool_size(output.strings);
+	for (const string& value : m_values)
+		output.strings.push_back(value.value);
+	cond.count = pool_size(output.strings) - cond.first;
+	output.conditions.push_back(cond);
+}
+
 condition_match_result counted_string_comparison_condition::test_item(const item& itm, int /* area_level */) const
 {
 	const auto matches = count_matches(itm, m_values, m_comparison_type == comparison_type::exact_match);
@@ -496,14 +704,26 @@ void socket_specification_condition::print(std::ostream& os) const
 	print_condition(tested_property(), m_comparison_type, m_values, os);
 }
 
+void socket_specification_condition::compile(compiled_filter& output) const
+{
+	compiled_condition cond{compiled_test::sockets, tested_property()};
+	cond.comparison = m_comparison_type;
+	cond.first = pool_size(output.socket_specs);
+	for (socket_spec ss : m_values)
+		output.socket_specs.push_back(ss);
+	cond.count = pool_size(output.socket_specs) - cond.first;
+	output.conditions.push_back(cond);
+}
+
 condition_match_result socket_specification_condition::test_item(const item& itm, int /* area_level */) const
 {
 	const bool group_matters = tested_property() == official_condition_property::socket_group;
 	const bool is_negative = m_comparison_type == comparison_type::not_equal;
 	const auto cmp = is_negative ? comparison_type::equal : m_comparison_type;
 
+	const socket_summary summary = itm.sockets.summary();
 	const auto it = std::find_if(m_values.begin(), m_values.end(), [&](socket_spec ss) {
-		return test_sockets_condition(cmp, ss, group_matters, itm.sockets);
+		return test_sockets_condition(cmp, ss, group_matters, summary);
 	});
 
 	const bool is_successful = is_negative == (it == m_values.end());
@@ -511,4 +731,179 @@ condition_match_result socket_specification_condition::test_item(const item& itm
 	return condition_match_result{is_successful, origin(), value_origin};
 }
 
+namespace
+{
+
+[[nodiscard]] std::vector<int>
+sorted_unique(std::vector<int> values)
+{
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	return values;
+}
+
+// normalize_conditions for 1 property, marks conditions which should be removed
+[[nodiscard]] bool
+normalize_property_conditions(
+	std::vector<official_condition_value>& conditions,
+	official_condition_property property,
+	std::vector<bool>& is_removed)
+{
+	// inclusive bounds, 64-bit because exclusive bounds can step outside int
+	std::int64_t min = std::numeric_limits<int>::min();
+	std::int64_t max = std::numeric_limits<int>::max();
+	std::optional<std::size_t> lower_bound;
+	std::optional<std::size_t> upper_bound;
+
+	std::optional<std::vector<int>> allowed; // sorted
+	std::optional<std::size_t> allowed_list;
+	std::vector<int> disallowed; // sorted
+	std::vector<std::size_t> disallowed_lists;
+
+	for (std::size_t i = 0; i < conditions.size(); ++i) {
+		if (conditions[i]->tested_property() != property)
+			continue;
+
+		if (const auto* bound = dynamic_cast<const range_bound_condition_base*>(conditions[i].get()); bound != nullptr) {
+			const std::int64_t value = bound->bound_value();
+
+			if (bound->is_lower_bound()) {
+				const std::int64_t inclusive_value = bound->is_inclusive() ? value : value + 1;
+				if (!lower_bound || inclusive_value > min) {
+					if (lower_bound)
+						is_removed[*lower_bound] = true;
+
+					lower_bound = i;
+					min = std::max(min, inclusive_value);
+				}
+				else {
+					is_removed[i] = true;
+				}
+			}
+			else {
+				const std::int64_t inclusive_value = bound->is_inclusive() ? value : value - 1;
+				if (!upper_bound || inclusive_value < max) {
+					if (upper_bound)
+						is_removed[*upper_bound] = true;
+
+					upper_bound = i;
+					max = std::min(max, inclusive_value);
+				}
+				else {
+					is_removed[i] = true;
+				}
+			}
+		}
+		else if (const auto* list = dynamic_cast<const value_list_condition_base*>(conditions[i].get()); list != nullptr) {
+			const std::vector<int> values = sorted_unique(list->integer_values());
+
+			if (!list->is_allowed_list()) {
+				std::vector<int> sum;
+				std::set_union(disallowed.begin(), disallowed.end(), values.begin(), values.end(), std::back_inserter(sum));
+				disallowed = std::move(sum);
+				disallowed_lists.push_back(i);
+			}
+			else if (allowed) {
+				std::vector<int> intersection;
+				std::set_intersection(allowed->begin(), allowed->end(), values.begin(), values.end(), std::back_inserter(intersection));
+				allowed = std::move(intersection);
+				is_removed[i] = true;
+			}
+			else {
+				allowed = values;
+				allowed_list = i;
+			}
+		}
+	}
+
+	if (min > max)
+		return false;
+
+	const auto is_disallowed = [&](int value) {
+		return value < min || value > max || std::binary_search(disallowed.begin(), disallowed.end(), value);
+	};
+
+	if (allowed) {
+		allowed->erase(std::remove_if(allowed->begin(), allowed->end(), is_disallowed), allowed->end());
+		if (allowed->empty())
+			return false;
+
+		// only listed values pass, bounds and other lists are redundant
+		static_cast<value_list_condition_base&>(*conditions[*allowed_list]).retain_values(*allowed);
+
+		for (std::optional<std::size_t> index : {lower_bound, upper_bound}) {
+			if (index)
+				is_removed[*index] = true;
+		}
+
+		for (std::size_t index : disallowed_lists)
+			is_removed[index] = true;
+
+		return true;
+	}
+
+	// disallowed values outside the range are redundant
+	for (std::size_t index : disallowed_lists) {
+		auto& list = static_cast<value_list_condition_base&>(*conditions[index]);
+		std::vector<int> in_range = sorted_unique(list.integer_values());
+		in_range.erase(std::remove_if(in_range.begin(), in_range.end(), [&](int value) {
+			return value < min || value > max;
+		}), in_range.end());
+
+		list.retain_values(in_range);
+		if (in_range.empty())
+			is_removed[index] = true;
+	}
+
+	// a small range can be entirely disallowed
+	if (max - min < static_cast<std::int64_t>(disallowed.size())) {
+		bool any_value_passes = false;
+		for (std::int64_t value = min; value <= max && !any_value_passes; ++value)
+			any_value_passes = !std::binary_search(disallowed.begin(), disallowed.end(), static_cast<int>(value));
+
+		if (!any_value_passes)
+			return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+bool normalize_conditions(official_conditions& conditions)
+{
+	auto& conds = conditions.conditions;
+	std::vector<bool> is_removed(conds.size(), false);
+	std::vector<official_condition_property> normalized_properties;
+
+	for (const official_condition_value& cond : conds) {
+		if (dynamic_cast<const range_or_list_condition*>(cond.get()) == nullptr)
+			continue;
+
+		const official_condition_property property = cond->tested_property();
+		if (std::find(normalized_properties.begin(), normalized_properties.end(), property) != normalized_properties.end())
+			continue;
+
+		if (!normalize_property_conditions(conds, property, is_removed))
+			return false;
+
+		normalized_properties.push_back(property);
+	}
+
+	std::size_t out = 0;
+	for (std::size_t i = 0; i < conds.size(); ++i) {
+		if (is_removed[i])
+			continue;
+
+		if (out != i)
+			conds[out] = std::move(conds[i]);
+
+		++out;
+	}
+
+	conds.erase(conds.begin() + static_cast<std::ptrdiff_t>(out), conds.end());
+	conditions.evaluation_order.clear();
+	return true;
+}
+
 }
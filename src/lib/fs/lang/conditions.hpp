@@ -5,12 +5,14 @@
 #include <fs/lang/position_tag.hpp>
 #include <fs/lang/item.hpp>
 #include <fs/utility/type_traits.hpp>
+#include <fs/utility/substring_matcher.hpp>
+#include <fs/utility/inline_polymorphic.hpp>
 
 #include <boost/container/small_vector.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <iosfwd>
-#include <memory>
 #include <optional>
 #include <string_view>
 #include <utility>
@@ -18,6 +20,8 @@
 
 namespace fs::lang {
 
+struct compiled_filter;
+
 class condition_match_result
 {
 public:
@@ -91,6 +95,15 @@ public:
 	// For loot generation and filter debug.
 	virtual condition_match_result test_item(const item& itm, int area_level) const = 0;
 
+	// For bulk item evaluation. Should append exactly 1 flat equivalent of this condition.
+	virtual void compile(compiled_filter& output) const = 0;
+
+	// For merging blocks (see merge_adjacent_blocks). If this condition passes items
+	// with any of its values and other condition is of the same kind, adds values of
+	// other so that this condition passes items which pass any of them.
+	// Returns false (and changes nothing) if such merge is not possible.
+	virtual bool merge_values(const official_condition& /* other */) { return false; }
+
 	// Some conditions may have valid state but would not be accepted by the game client.
 	// Examples: invalid operator, empty list of values. Such conditons should not be printed.
 	virtual bool is_valid() const = 0;
@@ -102,10 +115,18 @@ private:
 	position_tag m_origin;
 };
 
+// Conditions are stored by value, inline in their block: building and copying
+// filters does not allocate each condition separately. Capacity fits the largest
+// condition type (string comparisons), make<T> fails to compile if T does not fit.
+using official_condition_value = utility::inline_polymorphic<official_condition, 208>;
+
 // majority of conditions that support multiple values hold just 1
 template <typename T>
 using condition_values_container = boost::container::small_vector<T, 1>;
 
+// numeric comparison as performed by the game client
+[[nodiscard]] bool compare_integers(comparison_type cmp_type, int lhs, int rhs);
+
 // ---- boolean ----
 
 class boolean_condition : public official_condition
@@ -118,9 +139,10 @@ public:
 
 	bool is_valid() const final { return true; }
 
+	void compile(compiled_filter& output) const override;
+
 	void print(std::ostream& os) const final;
 
-protected:
 	boolean value() const { return m_value; }
 
 private:
@@ -146,54 +168,54 @@ private:
 	bool item::* m_tested_field;
 };
 
-inline std::shared_ptr<boolean_condition> make_identified_condition(boolean value, position_tag origin)
+inline official_condition_value make_identified_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::identified, &item::is_identified, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::identified, &item::is_identified, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_mirrored_condition(boolean value, position_tag origin)
+inline official_condition_value make_mirrored_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::mirrored, &item::is_mirrored, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::mirrored, &item::is_mirrored, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_fractured_item_condition(boolean value, position_tag origin)
+inline official_condition_value make_fractured_item_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::fractured_item, &item::is_fractured, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::fractured_item, &item::is_fractured, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_synthesised_item_condition(boolean value, position_tag origin)
+inline official_condition_value make_synthesised_item_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::synthesised_item, &item::is_synthesised, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::synthesised_item, &item::is_synthesised, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_shaped_map_condition(boolean value, position_tag origin)
+inline official_condition_value make_shaped_map_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::shaped_map, &item::is_shaped_map, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::shaped_map, &item::is_shaped_map, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_elder_map_condition(boolean value, position_tag origin)
+inline official_condition_value make_elder_map_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::elder_map, &item::is_elder_map, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::elder_map, &item::is_elder_map, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_replica_condition(boolean value, position_tag origin)
+inline official_condition_value make_replica_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::replica, &item::is_replica, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::replica, &item::is_replica, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_has_crucible_passive_tree_condition(boolean value, position_tag origin)
+inline official_condition_value make_has_crucible_passive_tree_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::has_crucible_passive_tree, &item::has_crucible_passive_tree, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::has_crucible_passive_tree, &item::has_crucible_passive_tree, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_transfigured_gem_condition_boolean_version(boolean value, position_tag origin)
+inline official_condition_value make_transfigured_gem_condition_boolean_version(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::transfigured_gem, &item::is_transfigured_gem, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::transfigured_gem, &item::is_transfigured_gem, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_zana_memory_condition(boolean value, position_tag origin)
+inline official_condition_value make_zana_memory_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_field_test>(official_condition_property::zana_memory, &item::zana_memory, value, origin);
+	return official_condition_value::make<boolean_condition_with_field_test>(official_condition_property::zana_memory, &item::zana_memory, value, origin);
 }
 
 // a boolean_condition which's test_item implementation calls a boolean function in the item struct
@@ -217,44 +239,44 @@ private:
 	test_function_type m_test_func;
 };
 
-inline std::shared_ptr<boolean_condition> make_has_implicit_mod_condition(boolean value, position_tag origin)
+inline official_condition_value make_has_implicit_mod_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::has_implicit_mod, &item::has_implicit_mod, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::has_implicit_mod, &item::has_implicit_mod, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_corrupted_condition(boolean value, position_tag origin)
+inline official_condition_value make_corrupted_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::corrupted, &item::is_corrupted, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::corrupted, &item::is_corrupted, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_scourged_condition(boolean value, position_tag origin)
+inline official_condition_value make_scourged_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::scourged, &item::is_scourged, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::scourged, &item::is_scourged, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_blighted_map_condition(boolean value, position_tag origin)
+inline official_condition_value make_blighted_map_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::blighted_map, &item::is_blighted_map, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::blighted_map, &item::is_blighted_map, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_uber_blighted_map_condition(boolean value, position_tag origin)
+inline official_condition_value make_uber_blighted_map_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::uber_blighted_map, &item::is_uber_blighted_map, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::uber_blighted_map, &item::is_uber_blighted_map, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_any_enchantment_condition(boolean value, position_tag origin)
+inline official_condition_value make_any_enchantment_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::any_enchantment, &item::has_enchantment, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::any_enchantment, &item::has_enchantment, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_elder_item_condition(boolean value, position_tag origin)
+inline official_condition_value make_elder_item_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::elder_item, &item::is_elder_item, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::elder_item, &item::is_elder_item, value, origin);
 }
 
-inline std::shared_ptr<boolean_condition> make_shaper_item_condition(boolean value, position_tag origin)
+inline official_condition_value make_shaper_item_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<boolean_condition_with_function_test>(official_condition_property::shaper_item, &item::is_shaper_item, value, origin);
+	return official_condition_value::make<boolean_condition_with_function_test>(official_condition_property::shaper_item, &item::is_shaper_item, value, origin);
 }
 
 class alternate_quality_condition : public boolean_condition
@@ -269,11 +291,13 @@ public:
 		// dead condition, no item can satisfy it
 		return condition_match_result::failure(origin());
 	}
+
+	void compile(compiled_filter& output) const final;
 };
 
-inline std::shared_ptr<boolean_condition> make_alternate_quality_condition(boolean value, position_tag origin)
+inline official_condition_value make_alternate_quality_condition(boolean value, position_tag origin)
 {
-	return std::make_shared<alternate_quality_condition>(value, origin);
+	return official_condition_value::make<alternate_quality_condition>(value, origin);
 }
 
 // ---- has influence ----
@@ -289,18 +313,23 @@ public:
 
 	condition_match_result test_item(const item& itm, int area_level) const final;
 
+	void compile(compiled_filter& output) const final;
+
 	bool is_valid() const final { return true; }
 
 	void print(std::ostream& os) const final;
 
+	influence_spec spec() const { return m_influence_spec; }
+	bool is_exact_match() const { return m_exact_match; }
+
 private:
 	bool m_exact_match;
 	influence_spec m_influence_spec;
 };
 
-inline auto make_has_influence_condition(influence_spec spec, bool exact_match, position_tag origin)
+inline official_condition_value make_has_influence_condition(influence_spec spec, bool exact_match, position_tag origin)
 {
-	return std::make_shared<has_influence_condition>(spec, exact_match, origin);
+	return official_condition_value::make<has_influence_condition>(spec, exact_match, origin);
 }
 
 // ---- range or list ----
@@ -331,11 +360,18 @@ public:
 
 	bool is_valid() const final { return true; }
 
+	// for normalize_conditions
+	bool is_lower_bound() const { return type() == test_type::lower_bound; }
+	virtual int bound_value() const = 0;
+	virtual bool is_inclusive() const = 0;
+
 protected:
 	// template-less overloads to avoid dragging ostream and other dependencies
 	// (add more overloads if new type instantiations are needed)
 	void print_impl(comparison_type comparison, rarity bound_value, std::ostream& os) const;
 	void print_impl(comparison_type comparison, integer bound_value, std::ostream& os) const;
+
+	void compile_impl(int bound_value, bool inclusive, bool is_lower_bound, compiled_filter& output) const;
 };
 
 class value_list_condition_base : public range_or_list_condition
@@ -343,11 +379,20 @@ class value_list_condition_base : public range_or_list_condition
 public:
 	using range_or_list_condition::range_or_list_condition;
 
+	// for normalize_conditions
+	bool is_allowed_list() const { return type() == test_type::values_equal; }
+	virtual std::vector<int> integer_values() const = 0;
+	// keeps (in the same order) only values which are present in the sorted list
+	virtual void retain_values(const std::vector<int>& sorted_values) = 0;
+
 protected:
 	// template-less overloads to avoid dragging ostream and other dependencies
 	// (add more overloads if new type instantiations are needed)
 	void print_impl(bool allowed, const condition_values_container<rarity>& values, std::ostream& os) const;
 	void print_impl(bool allowed, const condition_values_container<integer>& values, std::ostream& os) const;
+
+	void compile_impl(bool allowed, const condition_values_container<rarity>& values, compiled_filter& output) const;
+	void compile_impl(bool allowed, const condition_values_container<integer>& values, compiled_filter& output) const;
 };
 
 template <typename T>
@@ -403,6 +448,14 @@ public:
 		return condition_match_result(test_property_value(property_value), origin(), m_bound.value.origin);
 	}
 
+	int bound_value() const final { return static_cast<int>(m_bound.value.value); }
+	bool is_inclusive() const final { return m_bound.inclusive; }
+
+	void compile(compiled_filter& output) const final
+	{
+		compile_impl(static_cast<int>(m_bound.value.value), m_bound.inclusive, is_lower_bound(), output);
+	}
+
 	void print(std::ostream& os) const final
 	{
 		const auto cmp_type = is_lower_bound() ?
@@ -411,6 +464,8 @@ public:
 		print_impl(cmp_type, m_bound.value, os);
 	}
 
+	range_bound<T> bound() const { return m_bound; }
+
 protected:
 	virtual value_type get_tested_property_value(const item& itm, int area_level) const = 0;
 
@@ -422,8 +477,6 @@ protected:
 	}
 
 private:
-	bool is_lower_bound() const { return type() == test_type::lower_bound; }
-
 	range_bound<T> m_bound;
 };
 
@@ -541,8 +594,44 @@ public:
 
 	bool is_valid() const final { return !m_values.empty(); }
 
+	std::vector<int> integer_values() const final
+	{
+		std::vector<int> result;
+		result.reserve(m_values.size());
+		for (T value : m_values)
+			result.push_back(static_cast<int>(value.value));
+
+		return result;
+	}
+
+	void retain_values(const std::vector<int>& sorted_values) final
+	{
+		m_values.erase(std::remove_if(m_values.begin(), m_values.end(), [&](T value) {
+			return !std::binary_search(sorted_values.begin(), sorted_values.end(), static_cast<int>(value.value));
+		}), m_values.end());
+	}
+
+	bool merge_values(const official_condition& other) final
+	{
+		const auto* const other_list = dynamic_cast<const value_list_condition<T>*>(&other);
+		if (other_list == nullptr || other_list->tested_property() != tested_property() || !m_allowed || !other_list->m_allowed)
+			return false;
+
+		for (T value : other_list->m_values) {
+			const bool is_present = std::any_of(m_values.begin(), m_values.end(), [&](T v) { return v.value == value.value; });
+			if (!is_present)
+				m_values.push_back(value);
+		}
+
+		return true;
+	}
+
+	void compile(compiled_filter& output) const final { compile_impl(m_allowed, m_values, output); }
+
 	void print(std::ostream& os) const final { print_impl(m_allowed, m_values, os); }
 
+	const container_type& values() const { return m_values; }
+
 protected:
 	virtual value_type get_tested_property_value(const item& itm, int area_level) const = 0;
 
@@ -636,301 +725,301 @@ protected:
 
 // -- field test --
 
-inline std::shared_ptr<range_bound_condition<rarity>> make_rarity_range_bound_condition(
+inline official_condition_value make_rarity_range_bound_condition(
 	range_bound<rarity> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<rarity>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<rarity>>(
 		official_condition_property::rarity, &item::rarity_, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<rarity>> make_rarity_value_list_condition(
+inline official_condition_value make_rarity_value_list_condition(
 	value_list_condition<rarity>::container_type rarities, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<rarity>>(
+	return official_condition_value::make<value_list_condition_with_field_test<rarity>>(
 		official_condition_property::rarity, &item::rarity_, std::move(rarities), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_item_level_range_bound_condition(
+inline official_condition_value make_item_level_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::item_level, &item::item_level, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_item_level_value_list_condition(
+inline official_condition_value make_item_level_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::item_level, &item::item_level, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_drop_level_range_bound_condition(
+inline official_condition_value make_drop_level_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::drop_level, &item::drop_level, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_drop_level_value_list_condition(
+inline official_condition_value make_drop_level_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::drop_level, &item::drop_level, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_quality_range_bound_condition(
+inline official_condition_value make_quality_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::quality, &item::quality, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_quality_value_list_condition(
+inline official_condition_value make_quality_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::quality, &item::quality, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_height_range_bound_condition(
+inline official_condition_value make_height_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::height, &item::height, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_height_value_list_condition(
+inline official_condition_value make_height_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::height, &item::height, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_width_range_bound_condition(
+inline official_condition_value make_width_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::width, &item::width, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_width_value_list_condition(
+inline official_condition_value make_width_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::width, &item::width, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_stack_size_range_bound_condition(
+inline official_condition_value make_stack_size_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::stack_size, &item::stack_size, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_stack_size_value_list_condition(
+inline official_condition_value make_stack_size_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::stack_size, &item::stack_size, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_gem_level_range_bound_condition(
+inline official_condition_value make_gem_level_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::gem_level, &item::gem_level, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_gem_level_value_list_condition(
+inline official_condition_value make_gem_level_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::gem_level, &item::gem_level, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_map_tier_range_bound_condition(
+inline official_condition_value make_map_tier_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::map_tier, &item::map_tier, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_map_tier_value_list_condition(
+inline official_condition_value make_map_tier_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::map_tier, &item::map_tier, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_corrupted_mods_range_bound_condition(
+inline official_condition_value make_corrupted_mods_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::corrupted_mods, &item::corrupted_mods, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_corrupted_mods_value_list_condition(
+inline official_condition_value make_corrupted_mods_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::corrupted_mods, &item::corrupted_mods, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_enchantment_passive_num_range_bound_condition(
+inline official_condition_value make_enchantment_passive_num_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::enchantment_passive_num, &item::enchantment_passive_num, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_enchantment_passive_num_value_list_condition(
+inline official_condition_value make_enchantment_passive_num_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::enchantment_passive_num, &item::enchantment_passive_num, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_base_armour_range_bound_condition(
+inline official_condition_value make_base_armour_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::base_armour, &item::base_armour, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_base_armour_value_list_condition(
+inline official_condition_value make_base_armour_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::base_armour, &item::base_armour, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_base_evasion_range_bound_condition(
+inline official_condition_value make_base_evasion_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::base_evasion, &item::base_evasion, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_base_evasion_value_list_condition(
+inline official_condition_value make_base_evasion_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::base_evasion, &item::base_evasion, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_base_energy_shield_range_bound_condition(
+inline official_condition_value make_base_energy_shield_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::base_energy_shield, &item::base_energy_shield, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_base_energy_shield_value_list_condition(
+inline official_condition_value make_base_energy_shield_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::base_energy_shield, &item::base_energy_shield, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_base_ward_range_bound_condition(
+inline official_condition_value make_base_ward_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::base_ward, &item::base_ward, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_base_ward_value_list_condition(
+inline official_condition_value make_base_ward_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::base_ward, &item::base_ward, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_base_defence_percentile_range_bound_condition(
+inline official_condition_value make_base_defence_percentile_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::base_defence_percentile, &item::base_defence_percentile, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_base_defence_percentile_value_list_condition(
+inline official_condition_value make_base_defence_percentile_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::base_defence_percentile, &item::base_defence_percentile, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_memory_strands_range_bound_condition(
+inline official_condition_value make_memory_strands_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_field_test<integer>>(
+	return official_condition_value::make<range_bound_condition_with_field_test<integer>>(
 		official_condition_property::memory_strands, &item::memory_strands, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_memory_strands_value_list_condition(
+inline official_condition_value make_memory_strands_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_field_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_field_test<integer>>(
 		official_condition_property::memory_strands, &item::memory_strands, std::move(values), allowed, origin);
 }
 
 // -- function test --
 
-inline std::shared_ptr<range_bound_condition<integer>> make_linked_sockets_range_bound_condition(
+inline official_condition_value make_linked_sockets_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_function_test>(
+	return official_condition_value::make<range_bound_condition_with_function_test>(
 		official_condition_property::linked_sockets, &item::linked_sockets, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_linked_sockets_value_list_condition(
+inline official_condition_value make_linked_sockets_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_function_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_function_test<integer>>(
 		official_condition_property::linked_sockets, &item::linked_sockets, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_has_searing_exarch_implicit_range_bound_condition(
+inline official_condition_value make_has_searing_exarch_implicit_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_function_test>(
+	return official_condition_value::make<range_bound_condition_with_function_test>(
 		official_condition_property::has_searing_exarch_implicit, &item::implicit_exarch_value, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_has_searing_exarch_implicit_value_list_condition(
+inline official_condition_value make_has_searing_exarch_implicit_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_function_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_function_test<integer>>(
 		official_condition_property::has_searing_exarch_implicit, &item::implicit_exarch_value, std::move(values), allowed, origin);
 }
 
-inline std::shared_ptr<range_bound_condition<integer>> make_has_eater_of_worlds_implicit_range_bound_condition(
+inline official_condition_value make_has_eater_of_worlds_implicit_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<range_bound_condition_with_function_test>(
+	return official_condition_value::make<range_bound_condition_with_function_test>(
 		official_condition_property::has_eater_of_worlds_implicit, &item::implicit_eater_value, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_has_eater_of_worlds_implicit_value_list_condition(
+inline official_condition_value make_has_eater_of_worlds_implicit_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<value_list_condition_with_function_test<integer>>(
+	return official_condition_value::make<value_list_condition_with_function_test<integer>>(
 		official_condition_property::has_eater_of_worlds_implicit, &item::implicit_eater_value, std::move(values), allowed, origin);
 }
 
 // -- area level --
 
-inline std::shared_ptr<range_bound_condition<integer>> make_area_level_range_bound_condition(
+inline official_condition_value make_area_level_range_bound_condition(
 	range_bound<integer> bound, bool is_lower_bound, position_tag origin)
 {
-	return std::make_shared<area_level_range_bound_condition>(
+	return official_condition_value::make<area_level_range_bound_condition>(
 		official_condition_property::area_level, bound, is_lower_bound, origin);
 }
 
-inline std::shared_ptr<value_list_condition<integer>> make_area_level_value_list_condition(
+inline official_condition_value make_area_level_value_list_condition(
 	value_list_condition<integer>::container_type values, bool allowed, position_tag origin)
 {
-	return std::make_shared<area_level_value_list_condition>(
+	return official_condition_value::make<area_level_value_list_condition>(
 		official_condition_property::area_level, std::move(values), allowed, origin);
 }
 
@@ -961,20 +1050,33 @@ public:
 	: official_condition(tested_property, test_type::values_equal, origin)
 	, m_comparison_type(cmp)
 	, m_values(std::move(values))
+	, m_matcher(make_matcher(m_comparison_type, m_values))
 	{}
 
 	bool is_valid() const final { return !m_values.empty(); }
 
+	bool merge_values(const official_condition& other) final;
+
+	void compile(compiled_filter& output) const final;
+
 	void print(std::ostream& os) const final;
 
 	bool allows_item_class(std::string_view class_name) const final;
 
+	equality_comparison_type comparison() const { return m_comparison_type; }
+	const container_type& values() const { return m_values; }
+
 protected:
 	condition_match_result test_item_impl(const std::string* item_field) const;
 
 private:
+	// non-exact comparisons test all values in 1 pass, exact ones do not need it
+	static utility::substring_matcher make_matcher(equality_comparison_type cmp, const container_type& values);
+	const string* find_match(std::string_view item_field) const;
+
 	equality_comparison_type m_comparison_type;
 	container_type m_values;
+	utility::substring_matcher m_matcher;
 };
 
 // Adds an item test implementation and a protected interface function
@@ -1022,21 +1124,21 @@ private:
 	std::string item::* m_tested_field;
 };
 
-inline std::shared_ptr<string_comparison_condition> make_class_condition(
+inline official_condition_value make_class_condition(
 	equality_comparison_type cmp,
 	string_comparison_condition::container_type values,
 	position_tag origin)
 {
-	return std::make_shared<string_comparison_condition_with_string_field_test>(
+	return official_condition_value::make<string_comparison_condition_with_string_field_test>(
 		official_condition_property::class_, &item::class_, cmp, std::move(values), origin);
 }
 
-inline std::shared_ptr<string_comparison_condition> make_base_type_condition(
+inline official_condition_value make_base_type_condition(
 	equality_comparison_type cmp,
 	string_comparison_condition::container_type values,
 	position_tag origin)
 {
-	return std::make_shared<string_comparison_condition_with_string_field_test>(
+	return official_condition_value::make<string_comparison_condition_with_string_field_test>(
 		official_condition_property::base_type, &item::base_type, cmp, std::move(values), origin);
 }
 
@@ -1067,17 +1169,17 @@ private:
 	std::optional<std::string> item::* m_tested_field;
 };
 
-inline std::shared_ptr<string_comparison_condition> make_enchantment_passive_node_condition(
+inline official_condition_value make_enchantment_passive_node_condition(
 	equality_comparison_type cmp, string_comparison_condition::container_type values, position_tag origin)
 {
-	return std::make_shared<string_comparison_condition_with_optional_string_field_test>(
+	return official_condition_value::make<string_comparison_condition_with_optional_string_field_test>(
 		official_condition_property::enchantment_passive_node, &item::enchantment_cluster_jewel, cmp, std::move(values), origin);
 }
 
-inline std::shared_ptr<string_comparison_condition> make_archnemesis_mod_condition(
+inline official_condition_value make_archnemesis_mod_condition(
 	equality_comparison_type cmp, string_comparison_condition::container_type values, position_tag origin)
 {
-	return std::make_shared<string_comparison_condition_with_optional_string_field_test>(
+	return official_condition_value::make<string_comparison_condition_with_optional_string_field_test>(
 		official_condition_property::archnemesis_mod, &item::archnemesis_mod, cmp, std::move(values), origin);
 }
 
@@ -1103,12 +1205,12 @@ public:
 	}
 };
 
-inline std::shared_ptr<string_comparison_condition> make_transfigured_gem_condition_string_version(
+inline official_condition_value make_transfigured_gem_condition_string_version(
 	equality_comparison_type cmp,
 	string_comparison_condition::container_type values,
 	position_tag origin)
 {
-	return std::make_shared<transfigured_gem_string_comparison_condition>(cmp, std::move(values), origin);
+	return official_condition_value::make<transfigured_gem_string_comparison_condition>(cmp, std::move(values), origin);
 }
 
 // ---- counted string comparison ----
@@ -1141,6 +1243,8 @@ public:
 
 	condition_match_result test_item(const item& itm, int area_level) const final;
 
+	void compile(compiled_filter& output) const final;
+
 	bool is_valid() const final
 	{
 		if (m_values.empty())
@@ -1161,6 +1265,10 @@ public:
 
 	void print(std::ostream& os) const final;
 
+	comparison_type comparison() const { return m_comparison_type; }
+	std::optional<integer> count() const { return m_count; }
+	const container_type& values() const { return m_values; }
+
 protected:
 	virtual int count_matches(const item& itm, const container_type& values, bool exact_match_required) const = 0;
 
@@ -1186,13 +1294,13 @@ protected:
 	int count_matches(const item& itm, const container_type& values, bool exact_match_required) const final;
 };
 
-inline std::shared_ptr<counted_string_comparison_condition> make_has_explicit_mod_condition(
+inline official_condition_value make_has_explicit_mod_condition(
 	comparison_type cmp,
 	std::optional<integer> count,
 	counted_string_comparison_condition::container_type values,
 	position_tag origin)
 {
-	return std::make_shared<has_explicit_mod_condition>(cmp, count, std::move(values), origin);
+	return official_condition_value::make<has_explicit_mod_condition>(cmp, count, std::move(values), origin);
 }
 
 // GGG documents this condition similar to Class but actually it supports counted comparison
@@ -1212,17 +1320,33 @@ protected:
 	int count_matches(const item& itm, const container_type& values, bool exact_match_required) const final;
 };
 
-inline std::shared_ptr<counted_string_comparison_condition> make_has_enchantment_condition(
+inline official_condition_value make_has_enchantment_condition(
 	comparison_type cmp,
 	std::optional<integer> count,
 	counted_string_comparison_condition::container_type values,
 	position_tag origin)
 {
-	return std::make_shared<has_enchantment_condition>(cmp, count, std::move(values), origin);
+	return official_condition_value::make<has_enchantment_condition>(cmp, count, std::move(values), origin);
 }
 
 // ---- socket ----
 
+// comparison should not be != - it has to be implemented on a higher abstraction layer
+[[nodiscard]] bool
+test_sockets_condition(
+	comparison_type comparison,
+	socket_spec ss,
+	bool group_matters,
+	const socket_summary& item_sockets);
+
+// convenience overload, prefer summarizing once when testing multiple specs
+[[nodiscard]] bool
+test_sockets_condition(
+	comparison_type comparison,
+	socket_spec ss,
+	bool group_matters,
+	const socket_info& item_sockets);
+
 class socket_specification_condition : public official_condition
 {
 public:
@@ -1241,21 +1365,26 @@ public:
 
 	condition_match_result test_item(const item& itm, int area_level) const final;
 
+	void compile(compiled_filter& output) const final;
+
 	void print(std::ostream& os) const final;
 
+	comparison_type comparison() const { return m_comparison_type; }
+	const container_type& values() const { return m_values; }
+
 private:
 	comparison_type m_comparison_type;
 	container_type m_values;
 };
 
-inline auto make_sockets_condition(comparison_type cmp, socket_specification_condition::container_type specs, position_tag origin)
+inline official_condition_value make_sockets_condition(comparison_type cmp, socket_specification_condition::container_type specs, position_tag origin)
 {
-	return std::make_shared<socket_specification_condition>(cmp, std::move(specs), false, origin);
+	return official_condition_value::make<socket_specification_condition>(cmp, std::move(specs), false, origin);
 }
 
-inline auto make_socket_group_condition(comparison_type cmp, socket_specification_condition::container_type specs, position_tag origin)
+inline official_condition_value make_socket_group_condition(comparison_type cmp, socket_specification_condition::container_type specs, position_tag origin)
 {
-	return std::make_shared<socket_specification_condition>(cmp, std::move(specs), true, origin);
+	return official_condition_value::make<socket_specification_condition>(cmp, std::move(specs), true, origin);
 }
 
 // ---- spirit filter extensions ----
@@ -1456,7 +1585,28 @@ struct official_conditions
 			cond->print(os);
 	}
 
-	std::vector<std::shared_ptr<official_condition>> conditions; // never null
+	// i-th condition to test when only the overall result matters (see optimize_condition_order)
+	const official_condition& in_evaluation_order(std::size_t i) const
+	{
+		return evaluation_order.empty() ? *conditions[i] : *conditions[evaluation_order[i]];
+	}
+
+	std::vector<official_condition_value> conditions; // never null
+	// Permutation of condition indexes, empty means source order. Conditions are
+	// always printed and reported in source order, this only affects evaluation.
+	// Must be cleared or recomputed whenever conditions change.
+	std::vector<std::uint32_t> evaluation_order;
 };
 
+/*
+ * Folds range and value list conditions on the same property (Rarity, ItemLevel, ...)
+ * into the tightest equivalent set: at most 1 lower and 1 upper bound, or 1 list of
+ * allowed values (bounds and other lists are then redundant), plus lists of disallowed
+ * values trimmed to the remaining range. Conditions which are kept keep their origins.
+ *
+ * Returns false if conditions contradict each other (no item can pass them all),
+ * conditions are then left in an unspecified but valid state.
+ */
+[[nodiscard]] bool normalize_conditions(official_conditions& conditions);
+
 }
@@ -6,6 +6,9 @@
 #include <boost/container/static_vector.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <numeric>
 #include <vector>
@@ -326,6 +329,24 @@ struct linked_sockets
 	svector<socket_color, 6> sockets;
 };
 
+// Socket counts of an item, in the form tested by Sockets and SocketGroup conditions.
+// Computing it once per item avoids repeated traversal of socket groups.
+struct socket_summary
+{
+	static constexpr std::size_t num_colors = 6; // in the order of socket_color
+
+	struct counts
+	{
+		std::uint8_t sockets = 0;
+		std::array<std::uint8_t, num_colors> colors = {};
+	};
+
+	counts total;
+	std::uint8_t max_links = 0;
+	std::uint8_t num_groups = 0; // 0 for items without sockets
+	std::array<counts, 6> groups = {};
+};
+
 // represents item sockets state
 struct socket_info
 {
@@ -395,6 +416,28 @@ struct socket_info
 		throw std::invalid_argument("invalid socket index: " + std::to_string(n));
 	}
 
+	socket_summary summary() const noexcept
+	{
+		socket_summary result;
+		result.num_groups = static_cast<std::uint8_t>(groups.size());
+
+		for (std::size_t i = 0; i < groups.size(); ++i) {
+			socket_summary::counts& group_counts = result.groups[i];
+			group_counts.sockets = static_cast<std::uint8_t>(groups[i].sockets.size());
+
+			for (socket_color c : groups[i].sockets)
+				++group_counts.colors[static_cast<std::size_t>(c)];
+
+			result.total.sockets += group_counts.sockets;
+			for (std::size_t c = 0; c < socket_summary::num_colors; ++c)
+				result.total.colors[c] += group_counts.colors[c];
+
+			result.max_links = std::max(result.max_links, group_counts.sockets);
+		}
+
+		return result;
+	}
+
 	// any item has at most 6 distinct socket groups
 	svector<linked_sockets, 6> groups;
 };
@@ -0,0 +1,332 @@
+#include <fs/lang/item_batch.hpp>
+#include <fs/lang/item.hpp>
+#include <fs/utility/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+template <typename Column>
+[[nodiscard]] const Column*
+find_column(const std::vector<Column>& columns, official_condition_property property)
+{
+	const auto it = std::find_if(columns.begin(), columns.end(), [&](const Column& column) {
+		return column.property == property;
+	});
+
+	return it != columns.end() ? &*it : nullptr;
+}
+
+// Items are processed in chunks of this many mask words so that items which
+// need an item-by-item test stay in cache across all blocks of the filter.
+constexpr std::size_t words_per_chunk = 16;
+
+// range of mask words
+struct word_range
+{
+	template <typename Container>
+	auto first_in(Container& c) const
+	{
+		return c.begin() + static_cast<std::ptrdiff_t>(first);
+	}
+
+	template <typename Container>
+	auto last_in(Container& c) const
+	{
+		return c.begin() + static_cast<std::ptrdiff_t>(last);
+	}
+
+	std::size_t first;
+	std::size_t last;
+};
+
+[[nodiscard]] bool
+has_any_bit(const item_batch::mask_type& mask, word_range words)
+{
+	return std::any_of(words.first_in(mask), words.last_in(mask), [](item_batch::mask_word word) { return word != 0; });
+}
+
+// index of the lowest set bit, word must not be 0
+[[nodiscard]] std::size_t
+lowest_set_bit(item_batch::mask_word word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+	std::size_t result = 0;
+	while ((word & 1u) == 0) {
+		word >>= 1;
+		++result;
+	}
+	return result;
+#endif
+}
+
+// calls f(item_index) for each set bit
+template <typename F>
+void for_each_set_bit(item_batch::mask_word word, std::size_t word_index, F f)
+{
+	for (; word != 0; word &= word - 1)
+		f(word_index * item_batch::word_bits + lowest_set_bit(word));
+}
+
+// Tests items [word_index * word_bits, +word_bits) with a per-value predicate.
+// The loop has no branches and no dependencies between items (except the
+// final OR) so that it can be vectorized.
+template <typename T, typename Predicate>
+[[nodiscard]] item_batch::mask_word
+test_column_word(const std::vector<T>& column, std::size_t word_index, Predicate pred)
+{
+	const std::size_t first = word_index * item_batch::word_bits;
+	const std::size_t count = std::min(item_batch::word_bits, column.size() - first);
+	const T* const values = column.data() + first;
+
+	item_batch::mask_word result = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		result |= static_cast<item_batch::mask_word>(pred(values[i])) << i;
+
+	return result;
+}
+
+// clears bits of items which do not satisfy the condition
+void apply_condition(
+	const item_batch& batch,
+	const compiled_condition& cond,
+	const compiled_filter& filter,
+	int area_level,
+	word_range words,
+	item_batch::mask_type& mask)
+{
+	const auto words_first = words.first_in(mask);
+	const auto words_last = words.last_in(mask);
+
+	const bool is_integer_test = cond.test == compiled_test::integer_range || cond.test == compiled_test::integer_list;
+
+	// area level is the same for all items, the condition either keeps or clears everything
+	if (is_integer_test && cond.property == official_condition_property::area_level) {
+		if (!test_compiled_condition(batch.source(0), batch.prepared(0), cond, filter, area_level))
+			std::fill(words_first, words_last, 0u);
+
+		return;
+	}
+
+	if (cond.test == compiled_test::integer_range) {
+		const std::vector<int>* const column = batch.integer_column(cond.property);
+		FS_ASSERT(column != nullptr);
+
+		for (std::size_t w = words.first; w < words.last; ++w) {
+			if (mask[w] != 0)
+				mask[w] &= test_column_word(*column, w, [&](int value) { return cond.min <= value && value <= cond.max; });
+		}
+
+		return;
+	}
+
+	if (cond.test == compiled_test::integer_list) {
+		const std::vector<int>* const column = batch.integer_column(cond.property);
+		FS_ASSERT(column != nullptr);
+		const auto first = filter.integers.begin() + cond.first;
+		const auto last = first + cond.count;
+
+		for (std::size_t w = words.first; w < words.last; ++w) {
+			if (mask[w] != 0)
+				mask[w] &= test_column_word(*column, w, [&](int value) { return cond.flag == (std::find(first, last, value) != last); });
+		}
+
+		return;
+	}
+
+	if (cond.test == compiled_test::boolean || cond.test == compiled_test::flags) {
+		const std::vector<std::uint32_t>& column = batch.flags_column();
+		std::uint32_t care = static_cast<std::uint32_t>(cond.min);
+		std::uint32_t want = static_cast<std::uint32_t>(cond.max);
+
+		if (cond.test == compiled_test::boolean) {
+			care = item_flag_mask(cond.property);
+			want = cond.flag ? care : 0u;
+		}
+
+		for (std::size_t w = words.first; w < words.last; ++w) {
+			if (mask[w] != 0)
+				mask[w] &= test_column_word(column, w, [&](std::uint32_t flags) { return (flags & care) == want; });
+		}
+
+		return;
+	}
+
+	if (cond.test == compiled_test::influence) {
+		const std::vector<std::uint32_t>& column = batch.flags_column();
+		const auto required = static_cast<std::uint32_t>(cond.min);
+		const bool is_none = cond.max == 1;
+		const bool exact_match = cond.flag;
+
+		for (std::size_t w = words.first; w < words.last; ++w) {
+			if (mask[w] == 0)
+				continue;
+
+			mask[w] &= test_column_word(column, w, [&](std::uint32_t flags) {
+				const std::uint32_t item_mask = flags & influence_flags_mask;
+
+				if (is_none)
+					return item_mask == 0;
+
+				if (exact_match)
+					return (item_mask & required) == required;
+				else
+					return (item_mask & required) != 0;
+			});
+		}
+
+		return;
+	}
+
+	if (cond.test == compiled_test::string_ids
+		&& (cond.property == official_condition_property::class_ || cond.property == official_condition_property::base_type))
+	{
+		const auto first = filter.string_ids.begin() + cond.first;
+		const auto last = first + cond.count;
+		const bool is_class = cond.property == official_condition_property::class_;
+
+		for (std::size_t w = words.first; w < words.last; ++w) {
+			for_each_set_bit(mask[w], w, [&](std::size_t i) {
+				const prepared_item& prepared = batch.prepared(i);
+				const string_id id = is_class ? prepared.class_ : prepared.base_type;
+				if (id == string_table::npos || !std::binary_search(first, last, id))
+					mask[w] &= ~(item_batch::mask_word(1) << (i % item_batch::word_bits));
+			});
+		}
+
+		return;
+	}
+
+	if (cond.test == compiled_test::never) {
+		std::fill(words_first, words_last, 0u);
+		return;
+	}
+
+	// no column for this property, test remaining candidates one by one
+	for (std::size_t w = words.first; w < words.last; ++w) {
+		for_each_set_bit(mask[w], w, [&](std::size_t i) {
+			if (!test_compiled_condition(batch.source(i), batch.prepared(i), cond, filter, area_level))
+				mask[w] &= ~(item_batch::mask_word(1) << (i % item_batch::word_bits));
+		});
+	}
+}
+
+// clears bits of items which do not match the block, mask is the set of candidates
+void match_block(
+	const item_batch& batch,
+	const compiled_filter& filter,
+	const compiled_block& block,
+	int area_level,
+	word_range words,
+	item_batch::mask_type& mask)
+{
+	const auto first = filter.conditions.begin() + block.first_condition;
+	const auto last = first + block.num_conditions;
+
+	for (auto it = first; it != last; ++it) {
+		if (!has_any_bit(mask, words))
+			return;
+
+		apply_condition(batch, *it, filter, area_level, words, mask);
+	}
+}
+
+} // namespace
+
+item_batch::item_batch(const item* items_first, const item* items_last, const compiled_filter& filter)
+: m_items(items_first)
+, m_num_items(static_cast<std::size_t>(items_last - items_first))
+{
+	m_prepared.reserve(m_num_items);
+	m_flags.reserve(m_num_items);
+	for (std::size_t i = 0; i < m_num_items; ++i) {
+		m_prepared.push_back(prepare_item(m_items[i], filter));
+		m_flags.push_back(m_prepared.back().flags);
+	}
+
+	for (const compiled_condition& cond : filter.conditions) {
+		if (cond.test != compiled_test::integer_range && cond.test != compiled_test::integer_list)
+			continue;
+
+		if (cond.property == official_condition_property::area_level
+			|| find_column(m_integer_columns, cond.property) != nullptr)
+		{
+			continue;
+		}
+
+		auto& column = m_integer_columns.emplace_back();
+		column.property = cond.property;
+		column.values.reserve(m_num_items);
+		for (std::size_t i = 0; i < m_num_items; ++i)
+			column.values.push_back(read_integer_property(m_items[i], cond.property, 0));
+	}
+}
+
+const std::vector<int>* item_batch::integer_column(official_condition_property property) const
+{
+	const auto* const column = find_column(m_integer_columns, property);
+	return column != nullptr ? &column->values : nullptr;
+}
+
+item_batch::mask_type item_batch::all_items() const
+{
+	mask_type result(num_words(), ~mask_word(0));
+
+	if (const std::size_t remainder = m_num_items % word_bits; remainder != 0)
+		result.back() = (mask_word(1) << remainder) - 1u;
+
+	return result;
+}
+
+item_batch::mask_type
+match_compiled_block(const item_batch& batch, const compiled_filter& filter, std::size_t block_index, int area_level)
+{
+	item_batch::mask_type result = batch.all_items();
+	match_block(batch, filter, filter.blocks[block_index], area_level, word_range{0, result.size()}, result);
+	return result;
+}
+
+void pass_item_batch_through_compiled_filter(
+	const item_batch& batch,
+	const compiled_filter& filter,
+	int area_level,
+	item_style* results_first)
+{
+	for (std::size_t i = 0; i < batch.size(); ++i)
+		results_first[i] = default_item_style(batch.source(i));
+
+	// items which have not yet matched a non-Continue block
+	item_batch::mask_type pending = batch.all_items();
+	item_batch::mask_type matched(pending.size());
+
+	for (std::size_t first_word = 0; first_word < pending.size(); first_word += words_per_chunk) {
+		const word_range words{first_word, std::min(first_word + words_per_chunk, pending.size())};
+
+		for (const compiled_block& block : filter.blocks) {
+			if (!has_any_bit(pending, words))
+				break;
+
+			std::copy(words.first_in(pending), words.last_in(pending), words.first_in(matched));
+			match_block(batch, filter, block, area_level, words, matched);
+
+			for (std::size_t w = words.first; w < words.last; ++w) {
+				for_each_set_bit(matched[w], w, [&](std::size_t i) {
+					results_first[i].override_with(block.actions);
+					results_first[i].visibility = block.visibility;
+				});
+
+				if (!block.is_continue)
+					pending[w] &= ~matched[w];
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <fs/lang/compiled_filter.hpp>
+#include <fs/lang/enum_types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fs::lang
+{
+
+struct item;
+
+/*
+ * Structure-of-arrays view of many items, for filtering them with a compiled filter.
+ *
+ * lang::item is large and its integer fields are spread across multiple cache lines.
+ * A batch copies properties tested by the filter into contiguous columns: integers
+ * and item flags (booleans and influences, see prepared_item), plus interned string IDs.
+ * Block conditions are then evaluated for the whole batch at once, 1 column per
+ * condition, producing a bit mask of matching items. Conditions without a column
+ * (non-exact strings, counted strings, sockets) are tested item by item, only for
+ * items which are still candidates for the block.
+ *
+ * Only properties used by the filter get columns. A batch must be used with the
+ * filter it was created for. Items are referenced, not copied - they must outlive
+ * the batch.
+ */
+class item_batch
+{
+public:
+	using mask_word = std::uint64_t;
+	static constexpr std::size_t word_bits = 64;
+
+	// bit i (in word i / word_bits) is set if item i passes the test
+	using mask_type = std::vector<mask_word>;
+
+	item_batch(const item* items_first, const item* items_last, const compiled_filter& filter);
+
+	std::size_t size() const { return m_num_items; }
+	std::size_t num_words() const { return (m_num_items + word_bits - 1) / word_bits; }
+
+	const item& source(std::size_t i) const { return m_items[i]; }
+	const prepared_item& prepared(std::size_t i) const { return m_prepared[i]; }
+
+	// nullptr if the filter does not test this property
+	const std::vector<int>* integer_column(official_condition_property property) const;
+
+	const std::vector<std::uint32_t>& flags_column() const { return m_flags; }
+
+	// mask with bits set for all items
+	mask_type all_items() const;
+
+private:
+	struct integer_property_column
+	{
+		official_condition_property property;
+		std::vector<int> values;
+	};
+
+	const item* m_items;
+	std::size_t m_num_items;
+	std::vector<prepared_item> m_prepared;
+	std::vector<integer_property_column> m_integer_columns;
+	std::vector<std::uint32_t> m_flags;
+};
+
+// bit i set = item i of the batch matches conditions of filter.blocks[block_index]
+[[nodiscard]] item_batch::mask_type
+match_compiled_block(const item_batch& batch, const compiled_filter& filter, std::size_t block_index, int area_level);
+
+/*
+ * Equivalent of results_first[i] = pass_item_through_compiled_filter(batch.source(i), filter, area_level)
+ * for each item in the batch. The output range must have at least batch.size() elements.
+ */
+void pass_item_batch_through_compiled_filter(
+	const item_batch& batch,
+	const compiled_filter& filter,
+	int area_level,
+	item_style* results_first);
+
+}
@@ -1,6 +1,7 @@
 #include <fs/lang/item_filter.hpp>
 #include <fs/lang/keywords.hpp>
 #include <fs/utility/assert.hpp>
+#include <fs/utility/thread_pool.hpp>
 #include <fs/utility/type_traits.hpp>
 #include <fs/utility/visitor.hpp>
 
@@ -20,6 +21,8 @@ integer make_int(int val)
 	return integer{val, no_origin()};
 }
 
+} // namespace
+
 item_style default_item_style(const item& itm)
 {
 	/*
@@ -59,8 +62,6 @@ item_visibility_style to_item_visibility_style(item_visibility visibility)
 	return {visibility.policy == item_visibility_policy::show, visibility.origin};
 }
 
-} // namespace
-
 void import_block::print(std::ostream& output_stream) const
 {
 	output_stream << keywords::rf::import_ << " \"" << path.value << '\"';
@@ -199,6 +200,20 @@ block_match_result item_filter_block::test_item(const item& itm, int area_level)
 		return block_match_result::failure_mismatch(visibility.origin, continuation.origin, std::move(match_results));
 }
 
+bool item_filter_block::matches(const item& itm, int area_level) const
+{
+	if (!is_valid())
+		return false;
+
+	FS_ASSERT(conditions.evaluation_order.empty() || conditions.evaluation_order.size() == conditions.conditions.size());
+
+	for (std::size_t i = 0; i < conditions.conditions.size(); ++i)
+		if (!conditions.in_evaluation_order(i).test_item(itm, area_level).is_successful())
+			return false;
+
+	return true;
+}
+
 item_filtering_result pass_item_through_filter(const item& itm, const item_filter& filter, int area_level)
 {
 	std::vector<block_match_result> match_history;
@@ -241,4 +256,53 @@ item_filtering_result pass_item_through_filter(const item& itm, const item_filte
 	return item_filtering_result{style, std::move(match_history)};
 }
 
+item_style pass_item_through_filter_style_only(const item& itm, const item_filter& filter, int area_level)
+{
+	item_style style = default_item_style(itm);
+
+	for (const block_variant& block_variant : filter.blocks) {
+		const auto* const block = std::get_if<item_filter_block>(&block_variant);
+		if (block == nullptr || !block->matches(itm, area_level))
+			continue;
+
+		style.override_with(block->actions);
+		style.visibility = to_item_visibility_style(block->visibility);
+
+		if (!block->continuation.origin)
+			break;
+	}
+
+	return style;
+}
+
+void pass_items_through_filter(
+	const item* items_first,
+	const item* items_last,
+	item_filtering_result* results_first,
+	const item_filter& filter,
+	int area_level,
+	utility::parallel_settings settings)
+{
+	FS_ASSERT(items_first <= items_last);
+	const auto num_items = static_cast<std::size_t>(items_last - items_first);
+	utility::parallel_for(num_items, settings, [&](std::size_t i) {
+		results_first[i] = pass_item_through_filter(items_first[i], filter, area_level);
+	});
+}
+
+void pass_items_through_filter_style_only(
+	const item* items_first,
+	const item* items_last,
+	item_style* results_first,
+	const item_filter& filter,
+	int area_level,
+	utility::parallel_settings settings)
+{
+	FS_ASSERT(items_first <= items_last);
+	const auto num_items = static_cast<std::size_t>(items_last - items_first);
+	utility::parallel_for(num_items, settings, [&](std::size_t i) {
+		results_first[i] = pass_item_through_filter_style_only(items_first[i], filter, area_level);
+	});
+}
+
 } // namespace fs::lang
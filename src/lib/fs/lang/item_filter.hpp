@@ -2,6 +2,7 @@
 
 #include <fs/lang/conditions.hpp>
 #include <fs/lang/action_set.hpp>
+#include <fs/utility/parallel_settings.hpp>
 
 #include <functional>
 #include <iosfwd>
@@ -123,6 +124,10 @@ struct item_filter_block
 
 	block_match_result test_item(const item& itm, int area_level) const;
 
+	// same as test_item(...).is_successful() but stops on first failed
+	// condition and does not record match results (no allocations)
+	bool matches(const item& itm, int area_level) const;
+
 	void print(std::ostream& output_stream, style_overrides overrides, bool filter_is_ruthless) const;
 
 	item_visibility visibility;
@@ -148,7 +153,12 @@ struct item_filter
 
 // ---- pieces for spirit filter ----
 
-namespace market { struct item_price_data; }
+namespace market {
+
+struct item_price_data;
+struct item_price_indexes;
+
+}
 
 struct block_generation_info
 {
@@ -172,6 +182,7 @@ struct generated_blocks_consumer
 using blocks_generator_func_type = void (
 	const block_generation_info&,
 	const market::item_price_data&,
+	const market::item_price_indexes&, // built from the item_price_data above
 	generated_blocks_consumer
 );
 
@@ -179,6 +190,7 @@ struct autogen_extension
 {
 	std::function<blocks_generator_func_type> blocks_generator; // should never be empty
 	price_range_condition price_range;
+	autogen_category category;
 	position_tag origin;
 };
 
@@ -243,6 +255,37 @@ struct item_filtering_result
 	std::vector<block_match_result> match_history;
 };
 
+// style of an item when no filter block matches it
+item_style default_item_style(const item& itm);
+
+item_visibility_style to_item_visibility_style(item_visibility visibility);
+
 item_filtering_result pass_item_through_filter(const item& itm, const item_filter& filter, int area_level);
 
+// equivalent of pass_item_through_filter(...).style, use when match history is not needed
+item_style pass_item_through_filter_style_only(const item& itm, const item_filter& filter, int area_level);
+
+/*
+ * Batch versions, for filtering large amounts of items. Work is split across
+ * threads of settings.pool (if any) but results are always written to the same
+ * positions as their items:
+ * results_first[i] = pass_item_through_filter(items_first[i], filter, area_level)
+ * The output range must have at least as many elements as the input range.
+ */
+void pass_items_through_filter(
+	const item* items_first,
+	const item* items_last,
+	item_filtering_result* results_first,
+	const item_filter& filter,
+	int area_level,
+	utility::parallel_settings settings = {});
+
+void pass_items_through_filter_style_only(
+	const item* items_first,
+	const item* items_last,
+	item_style* results_first,
+	const item_filter& filter,
+	int area_level,
+	utility::parallel_settings settings = {});
+
 }
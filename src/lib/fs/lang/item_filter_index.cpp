@@ -0,0 +1,128 @@
+#include <fs/lang/item_filter_index.hpp>
+#include <fs/lang/item.hpp>
+#include <fs/utility/string_helpers.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+// nullptr if the condition does not limit the property to a set of exact strings
+const string_comparison_condition*
+find_exact_string_condition(const official_conditions& conditions, official_condition_property property)
+{
+	for (const auto& cond : conditions.conditions) {
+		if (cond->tested_property() != property)
+			continue;
+
+		const auto* const str_cond = dynamic_cast<const string_comparison_condition*>(cond.get());
+		if (str_cond != nullptr && str_cond->comparison() == equality_comparison_type::exact_match)
+			return str_cond;
+	}
+
+	return nullptr;
+}
+
+using bucket_map = std::map<std::string, std::vector<item_filter_index::block_index>, std::less<>>;
+
+void add_to_buckets(const string_comparison_condition& cond, item_filter_index::block_index index, bucket_map& buckets)
+{
+	for (const string& value : cond.values()) {
+		std::vector<item_filter_index::block_index>& blocks = buckets[utility::remove_diacritics(value.value)];
+
+		// multiple values can produce the same key
+		if (blocks.empty() || blocks.back() != index)
+			blocks.push_back(index);
+	}
+}
+
+} // namespace
+
+item_filter_index::item_filter_index(const item_filter& filter)
+{
+	bucket_map class_buckets;
+	bucket_map base_type_buckets;
+
+	for (std::size_t i = 0; i < filter.blocks.size(); ++i) {
+		const auto* const block = std::get_if<item_filter_block>(&filter.blocks[i]);
+		if (block == nullptr || !block->is_valid())
+			continue;
+
+		const auto index = static_cast<block_index>(i);
+
+		// prefer BaseType as it produces smaller buckets
+		if (const auto* cond = find_exact_string_condition(block->conditions, official_condition_property::base_type); cond != nullptr)
+			add_to_buckets(*cond, index, base_type_buckets);
+		else if (const auto* cond = find_exact_string_condition(block->conditions, official_condition_property::class_); cond != nullptr)
+			add_to_buckets(*cond, index, class_buckets);
+		else
+			m_wildcard_blocks.push_back(index);
+	}
+
+	// std::map is already sorted
+	const auto flatten = [](bucket_map& map, std::vector<bucket>& output) {
+		output.reserve(map.size());
+		for (auto& [key, blocks] : map)
+			output.push_back(bucket{key, std::move(blocks)});
+	};
+
+	flatten(class_buckets, m_class_buckets);
+	flatten(base_type_buckets, m_base_type_buckets);
+}
+
+const std::vector<item_filter_index::block_index>&
+item_filter_index::find_blocks(const std::vector<bucket>& buckets, std::string_view item_property)
+{
+	static const std::vector<block_index> empty;
+
+	// item properties with diacritics are rare - only then pay for the conversion
+	std::string converted;
+	if (utility::has_diacritics(item_property)) {
+		converted = utility::remove_diacritics(item_property);
+		item_property = converted;
+	}
+
+	const auto it = std::lower_bound(buckets.begin(), buckets.end(), item_property,
+		[](const bucket& b, std::string_view key) { return std::string_view(b.key) < key; });
+
+	if (it == buckets.end() || it->key != item_property)
+		return empty;
+
+	return it->blocks;
+}
+
+std::size_t item_filter_index::num_candidate_blocks(std::string_view item_class, std::string_view item_base_type) const
+{
+	std::size_t result = 0;
+	for_each_candidate_block(item_class, item_base_type, [&](block_index) {
+		++result;
+		return false;
+	});
+	return result;
+}
+
+item_style pass_item_through_filter_style_only(
+	const item& itm, const item_filter& filter, const item_filter_index& index, int area_level)
+{
+	item_style style = default_item_style(itm);
+
+	index.for_each_candidate_block(itm.class_, itm.base_type, [&](item_filter_index::block_index i) {
+		const auto& block = std::get<item_filter_block>(filter.blocks[i]);
+		if (!block.matches(itm, area_level))
+			return false;
+
+		style.override_with(block.actions);
+		style.visibility = to_item_visibility_style(block.visibility);
+
+		// stop unless this is a Continue block
+		return !block.continuation.origin.has_value();
+	});
+
+	return style;
+}
+
+}
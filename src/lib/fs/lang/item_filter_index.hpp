@@ -0,0 +1,107 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs::lang
+{
+
+struct item;
+
+/*
+ * Optional acceleration structure for item filtering.
+ *
+ * Most blocks in real filters test Class or BaseType. A block with an exact (==)
+ * Class or BaseType condition can only match items which have one of listed strings.
+ * Such blocks are put into buckets keyed by these strings, all other blocks land in
+ * the wildcard bucket. An item then only visits blocks from its class bucket, its
+ * base type bucket and the wildcard bucket, merged in the filter order - this keeps
+ * first-match and Continue semantics intact.
+ *
+ * Keys have diacritics removed so bucket lookup can only produce false positives
+ * (eliminated by the actual block test), never false negatives.
+ *
+ * Import blocks and invalid blocks are not indexed because they never match.
+ *
+ * The index refers to blocks by their position in item_filter::blocks.
+ * It must be rebuilt whenever the filter changes.
+ */
+class item_filter_index
+{
+public:
+	using block_index = std::uint32_t;
+
+	item_filter_index() = default;
+	explicit item_filter_index(const item_filter& filter);
+
+	// Calls f(block_index) for each block that may match an item with specified
+	// class and base type, in the filter order. Stops when f returns true.
+	template <typename F>
+	void for_each_candidate_block(std::string_view item_class, std::string_view item_base_type, F f) const
+	{
+		const std::vector<block_index>& by_class = find_blocks(m_class_buckets, item_class);
+		const std::vector<block_index>& by_base_type = find_blocks(m_base_type_buckets, item_base_type);
+
+		// each block is in exactly 1 bucket - merge 3 sorted disjoint lists
+		auto it1 = by_class.begin();
+		auto it2 = by_base_type.begin();
+		auto it3 = m_wildcard_blocks.begin();
+		const auto last1 = by_class.end();
+		const auto last2 = by_base_type.end();
+		const auto last3 = m_wildcard_blocks.end();
+
+		constexpr auto none = static_cast<block_index>(-1);
+		while (true) {
+			const block_index b1 = it1 != last1 ? *it1 : none;
+			const block_index b2 = it2 != last2 ? *it2 : none;
+			const block_index b3 = it3 != last3 ? *it3 : none;
+
+			block_index next = b1;
+			if (b2 < next)
+				next = b2;
+			if (b3 < next)
+				next = b3;
+
+			if (next == none)
+				return;
+
+			if (next == b1)
+				++it1;
+			else if (next == b2)
+				++it2;
+			else
+				++it3;
+
+			if (f(next))
+				return;
+		}
+	}
+
+	// for statistics
+	std::size_t num_candidate_blocks(std::string_view item_class, std::string_view item_base_type) const;
+	std::size_t num_wildcard_blocks() const { return m_wildcard_blocks.size(); }
+
+private:
+	struct bucket
+	{
+		std::string key;
+		std::vector<block_index> blocks;
+	};
+
+	// buckets must be sorted by key
+	static const std::vector<block_index>& find_blocks(const std::vector<bucket>& buckets, std::string_view item_property);
+
+	std::vector<bucket> m_class_buckets;
+	std::vector<bucket> m_base_type_buckets;
+	std::vector<block_index> m_wildcard_blocks;
+};
+
+// equivalent of pass_item_through_filter_style_only but only visits blocks that can match the item
+item_style pass_item_through_filter_style_only(
+	const item& itm, const item_filter& filter, const item_filter_index& index, int area_level);
+
+}
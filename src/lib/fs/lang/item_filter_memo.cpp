@@ -0,0 +1,151 @@
+#include <fs/lang/item_filter_memo.hpp>
+#include <fs/lang/item.hpp>
+#include <fs/utility/assert.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+// Fixed-size binary encoding, only needs to be unambiguous within one process.
+template <typename T>
+void append_value(std::string& key, T value)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append_string(std::string& key, std::string_view str)
+{
+	append_value(key, static_cast<std::uint32_t>(str.size()));
+	key.append(str);
+}
+
+void append_optional_string(std::string& key, const std::optional<std::string>& str)
+{
+	append_value(key, str.has_value());
+	if (str)
+		append_string(key, *str);
+}
+
+void append_strings(std::string& key, const std::vector<std::string>& strings)
+{
+	append_value(key, static_cast<std::uint32_t>(strings.size()));
+	for (const std::string& str : strings)
+		append_string(key, str);
+}
+
+void append_sockets(std::string& key, const socket_info& sockets)
+{
+	append_value(key, static_cast<std::uint8_t>(sockets.groups.size()));
+	for (const linked_sockets& group : sockets.groups) {
+		append_value(key, static_cast<std::uint8_t>(group.sockets.size()));
+		for (socket_color c : group.sockets)
+			append_value(key, static_cast<std::uint8_t>(c));
+	}
+}
+
+// Every field that any condition or default_item_style() reads.
+// Fields which filters do not support (name, description, max stack size,
+// max gem level) are skipped so that they do not split equivalent items.
+void make_key(std::string& key, const item& itm, int area_level)
+{
+	key.clear();
+	append_value(key, area_level);
+
+	append_string(key, itm.class_);
+	append_string(key, itm.base_type);
+	append_value(key, itm.height);
+	append_value(key, itm.width);
+
+	append_value(key, itm.item_level);
+	append_value(key, itm.drop_level);
+	append_value(key, itm.quality);
+	append_value(key, itm.stack_size);
+	append_value(key, itm.rarity_);
+	append_sockets(key, itm.sockets);
+	append_value(key, itm.memory_strands);
+
+	append_value(key, itm.base_armour);
+	append_value(key, itm.base_evasion);
+	append_value(key, itm.base_energy_shield);
+	append_value(key, itm.base_ward);
+	append_value(key, itm.base_defence_percentile);
+
+	append_value(key, itm.corruption_status);
+	append_value(key, itm.corrupted_mods);
+	append_value(key, itm.has_non_atlas_implicit_mod);
+	append_value(key, itm.exarch_implicit);
+	append_value(key, itm.eater_implicit);
+	append_strings(key, itm.explicit_mods);
+	append_optional_string(key, itm.archnemesis_mod);
+	append_value(key, itm.influence);
+
+	append_optional_string(key, itm.enchantment_labyrinth);
+	append_optional_string(key, itm.enchantment_cluster_jewel);
+	append_strings(key, itm.enchantments_other);
+	append_value(key, itm.enchantment_passive_num);
+
+	append_value(key, itm.gem_level);
+	append_value(key, itm.map_tier);
+	append_value(key, itm.blight_map_status);
+
+	append_value(key, itm.is_identified);
+	append_value(key, itm.is_mirrored);
+	append_value(key, itm.is_fractured);
+	append_value(key, itm.is_synthesised);
+	append_value(key, itm.is_shaped_map);
+	append_value(key, itm.is_elder_map);
+	append_value(key, itm.is_replica);
+	append_value(key, itm.has_crucible_passive_tree);
+	append_value(key, itm.is_transfigured_gem);
+	append_value(key, itm.zana_memory);
+}
+
+} // namespace
+
+item_filter_memo::item_filter_memo(std::shared_ptr<const item_filter> filter)
+: m_filter(std::move(filter))
+{
+	FS_ASSERT(m_filter != nullptr);
+}
+
+item_style item_filter_memo::pass_item(const item& itm, int area_level)
+{
+	make_key(m_key, itm, area_level);
+
+	if (const auto it = m_styles.find(m_key); it != m_styles.end()) {
+		++m_statistics.hits;
+		return it->second;
+	}
+
+	++m_statistics.misses;
+	item_style style = pass_item_through_filter_style_only(itm, *m_filter, area_level);
+	m_styles.emplace(m_key, style);
+	return style;
+}
+
+void item_filter_memo::reset(std::shared_ptr<const item_filter> filter)
+{
+	FS_ASSERT(filter != nullptr);
+
+	// same object is still the same filter - it is immutable and kept alive by the memo
+	if (filter == m_filter)
+		return;
+
+	if (!m_styles.empty())
+		++m_statistics.invalidations;
+
+	m_styles.clear();
+	m_filter = std::move(filter);
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace fs::lang
+{
+
+struct item;
+
+struct item_filter_memo_statistics
+{
+	double hit_rate() const
+	{
+		const std::size_t lookups = hits + misses;
+		return lookups == 0u ? 0.0 : static_cast<double>(hits) / lookups;
+	}
+
+	std::size_t hits = 0;
+	std::size_t misses = 0;
+	std::size_t invalidations = 0;
+};
+
+/*
+ * Optional cache for filtering many items with the same filter.
+ *
+ * Loot simulations generate a lot of items that are identical in every property
+ * a filter can test (currency stacks, divination cards, gems). Items are keyed by
+ * a canonical encoding of all filter-relevant fields (name, description and other
+ * properties that filters do not support are skipped) plus area level. A repeated
+ * key returns the previously computed style without walking filter blocks.
+ *
+ * The memo is bound to 1 immutable filter which it co-owns, so the filter can
+ * neither change nor be replaced by another object at the same address while
+ * cached styles exist. Create the filter as const (std::make_shared<const item_filter>)
+ * - modifying it through another pointer is not detected.
+ *
+ * Not thread-safe, use 1 memo per thread.
+ */
+class item_filter_memo
+{
+public:
+	explicit item_filter_memo(std::shared_ptr<const item_filter> filter);
+
+	// same result as pass_item_through_filter_style_only(itm, filter(), area_level)
+	item_style pass_item(const item& itm, int area_level);
+
+	// binds the memo to a different filter, drops all cached styles (statistics are kept)
+	void reset(std::shared_ptr<const item_filter> filter);
+
+	const item_filter& filter() const { return *m_filter; }
+	std::size_t size() const { return m_styles.size(); }
+	const item_filter_memo_statistics& statistics() const { return m_statistics; }
+	void reset_statistics() { m_statistics = {}; }
+
+private:
+	std::shared_ptr<const item_filter> m_filter;
+	std::unordered_map<std::string, item_style> m_styles;
+	std::string m_key; // reused buffer, avoids an allocation on each hit
+	item_filter_memo_statistics m_statistics;
+};
+
+}
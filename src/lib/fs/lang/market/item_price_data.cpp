@@ -376,6 +376,57 @@ void item_price_data::sort()
 	std::sort(bases.begin(),            bases.end(),            compare_by_name_asc);
 }
 
+item_price_indexes::item_price_indexes(const item_price_data& ipd)
+{
+	for (autogen_category category : autogen_category::_values())
+		build(ipd, category);
+}
+
+void item_price_indexes::build(const item_price_data& ipd, autogen_category category)
+{
+	switch (category) {
+		case autogen_category::currency:
+			currency.build(ipd.currency);
+			return;
+		case autogen_category::fragments:
+			fragments.build(ipd.fragments);
+			return;
+		case autogen_category::delirium_orbs:
+			delirium_orbs.build(ipd.delirium_orbs);
+			return;
+		case autogen_category::cards:
+			divination_cards.build(ipd.divination_cards);
+			return;
+		case autogen_category::essences:
+			essences.build(ipd.essences);
+			return;
+		case autogen_category::fossils:
+			fossils.build(ipd.fossils);
+			return;
+		case autogen_category::resonators:
+			resonators.build(ipd.resonators);
+			return;
+		case autogen_category::scarabs:
+			scarabs.build(ipd.scarabs);
+			return;
+		case autogen_category::incubators:
+			incubators.build(ipd.incubators);
+			return;
+		case autogen_category::oils:
+			oils.build(ipd.oils);
+			return;
+		case autogen_category::vials:
+			vials.build(ipd.vials);
+			return;
+		case autogen_category::tattoos:
+			tattoos.build(ipd.tattoos);
+			return;
+		case autogen_category::gems:
+			gems.build(ipd.gems);
+			return;
+	}
+}
+
 void compare_item_price_reports(
 	const item_price_report& lhs,
 	const item_price_report& rhs,
@@ -2,12 +2,15 @@
 
 #include <fs/log/logger.hpp>
 #include <fs/lang/data_source_type.hpp>
+#include <fs/lang/enum_types.hpp>
 #include <fs/lang/influence_info.hpp>
 
 #include <nlohmann/json.hpp>
 
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -84,6 +87,74 @@ struct unique_item_price_data
 	ambiguous_container_type ambiguous;
 };
 
+/**
+ * @brief items of 1 category ordered by price
+ *
+ * Low-confidence items are excluded. Autogen finds items of a price range
+ * with a binary search instead of testing every item of the category.
+ * Indexes refer to positions in the category container - they are only
+ * valid for the exact container they were built from, see item_price_indexes.
+ */
+struct price_index
+{
+	template <typename Item>
+	void build(const std::vector<Item>& items)
+	{
+		indexes.clear();
+		for (std::size_t i = 0; i < items.size(); ++i)
+			if (!items[i].price.is_low_confidence)
+				indexes.push_back(i);
+
+		std::stable_sort(indexes.begin(), indexes.end(), [&](std::size_t lhs, std::size_t rhs) {
+			return items[lhs].price.chaos_value < items[rhs].price.chaos_value;
+		});
+
+		prices.clear();
+		prices.reserve(indexes.size());
+		for (std::size_t i : indexes)
+			prices.push_back(items[i].price.chaos_value);
+	}
+
+	std::vector<double> prices;       // ascending
+	std::vector<std::size_t> indexes; // positions of items with corresponding prices
+};
+
+struct item_price_data;
+
+/**
+ * @brief price indexes of categories used by autogen
+ *
+ * Not stored in item_price_data (its containers are modified freely). Owners of
+ * data which does not change (a loaded report) build them once and pass them to
+ * each filter generation, otherwise generation builds the ones it needs.
+ * The data must not change while the indexes are in use.
+ */
+struct item_price_indexes
+{
+	item_price_indexes() = default;
+	// builds indexes of all categories
+	explicit item_price_indexes(const item_price_data& ipd);
+
+	// builds the index used by autogen of given category (others are untouched)
+	void build(const item_price_data& ipd, autogen_category category);
+
+	price_index divination_cards;
+
+	price_index currency;
+	price_index fragments;
+	price_index delirium_orbs;
+	price_index vials;
+	price_index oils;
+	price_index incubators;
+	price_index essences;
+	price_index fossils;
+	price_index resonators;
+	price_index scarabs;
+	price_index tattoos;
+
+	price_index gems;
+};
+
 struct item_price_metadata;
 
 struct item_price_data
@@ -0,0 +1,121 @@
+#include <fs/lang/merge_blocks.hpp>
+
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+// Conditions which print the same are the same for the game client.
+[[nodiscard]] std::string
+to_string(const official_condition& cond)
+{
+	std::ostringstream ss;
+	cond.print(ss);
+	return ss.str();
+}
+
+[[nodiscard]] std::size_t
+printed_size(const item_filter_block& block, bool filter_is_ruthless)
+{
+	std::ostringstream ss;
+	block.print(ss, style_overrides{}, filter_is_ruthless);
+	return ss.str().size();
+}
+
+// index of the only condition which differs, conditions.size() if none differ,
+// nothing if blocks are not compatible
+[[nodiscard]] std::optional<std::size_t>
+find_differing_condition(const item_filter_block& lhs, const item_filter_block& rhs)
+{
+	if (!lhs.is_valid()
+		|| !rhs.is_valid()
+		|| lhs.visibility.policy != rhs.visibility.policy
+		|| lhs.continuation.origin.has_value() != rhs.continuation.origin.has_value()
+		|| lhs.actions != rhs.actions)
+	{
+		return std::nullopt;
+	}
+
+	const auto& lhs_conditions = lhs.conditions.conditions;
+	const auto& rhs_conditions = rhs.conditions.conditions;
+	if (lhs_conditions.size() != rhs_conditions.size())
+		return std::nullopt;
+
+	std::optional<std::size_t> result;
+	for (std::size_t i = 0; i < lhs_conditions.size(); ++i) {
+		const official_condition& lhs_cond = *lhs_conditions[i];
+		const official_condition& rhs_cond = *rhs_conditions[i];
+
+		if (lhs_cond.tested_property() != rhs_cond.tested_property() || lhs_cond.type() != rhs_cond.type())
+			return std::nullopt;
+
+		if (to_string(lhs_cond) == to_string(rhs_cond))
+			continue;
+
+		if (result) // more than 1 condition differs
+			return std::nullopt;
+
+		result = i;
+	}
+
+	return result.value_or(lhs_conditions.size());
+}
+
+// returns whether source was merged into target
+bool merge_block(item_filter_block& target, const item_filter_block& source, std::size_t differing_condition)
+{
+	// Identical blocks: the second one matches the same items and applies the same
+	// actions (again, if the first one had Continue) so it can be simply dropped.
+	if (differing_condition == target.conditions.conditions.size())
+		return true;
+
+	official_condition& target_cond = *target.conditions.conditions[differing_condition];
+	if (!target_cond.merge_values(*source.conditions.conditions[differing_condition]))
+		return false;
+
+	target.conditions.evaluation_order.clear();
+	return true;
+}
+
+} // namespace
+
+block_merge_statistics merge_adjacent_blocks(item_filter& filter)
+{
+	block_merge_statistics result;
+
+	std::vector<block_variant> merged_blocks;
+	merged_blocks.reserve(filter.blocks.size());
+
+	for (block_variant& bv : filter.blocks) {
+		auto* const previous = merged_blocks.empty() ? nullptr : std::get_if<item_filter_block>(&merged_blocks.back());
+		const auto* const current = std::get_if<item_filter_block>(&bv);
+
+		if (previous != nullptr && current != nullptr) {
+			if (const auto differing = find_differing_condition(*previous, *current); differing) {
+				const std::size_t size_before =
+					printed_size(*previous, filter.is_ruthless) + printed_size(*current, filter.is_ruthless);
+
+				if (merge_block(*previous, *current, *differing)) {
+					++result.merged_blocks;
+					result.saved_bytes += size_before - printed_size(*previous, filter.is_ruthless);
+					continue;
+				}
+			}
+		}
+
+		merged_blocks.push_back(std::move(bv));
+	}
+
+	filter.blocks = std::move(merged_blocks);
+	return result;
+}
+
+}
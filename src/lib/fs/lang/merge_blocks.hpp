@@ -0,0 +1,34 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+#include <cstddef>
+
+namespace fs::lang
+{
+
+/*
+ * Merging of adjacent blocks which differ only in values of 1 condition.
+ *
+ * Generated blocks often have identical actions and conditions except for a
+ * value list (e.g. BaseType of items of a specific price). 2 adjacent blocks:
+ * - with the same visibility, actions and Continue
+ * - with the same conditions, except 1 which passes items with any of its
+ *   values (value lists without !=, string comparisons without !=)
+ * are replaced by 1 block with values of both. Every item which matched
+ * either block matches the merged one (and receives the same actions) and
+ * there is no block between them that could catch any item first.
+ *
+ * Blocks are compared in source order of conditions. Merged blocks keep the
+ * position and origins of the first one, the order of evaluation is reset.
+ */
+
+struct block_merge_statistics
+{
+	std::size_t merged_blocks = 0; // blocks removed by merging them into previous ones
+	std::size_t saved_bytes = 0;   // of printed filter, when printed without style overrides
+};
+
+block_merge_statistics merge_adjacent_blocks(item_filter& filter);
+
+}
@@ -0,0 +1,54 @@
+#include <fs/lang/string_table.hpp>
+#include <fs/utility/assert.hpp>
+#include <fs/utility/string_helpers.hpp>
+
+namespace fs::lang
+{
+
+string_table::string_table(const string_table& other)
+: m_strings(other.m_strings)
+{
+	m_ids.reserve(m_strings.size());
+	for (std::size_t i = 0; i < m_strings.size(); ++i)
+		m_ids.emplace(m_strings[i], static_cast<string_id>(i));
+}
+
+string_table& string_table::operator=(const string_table& other)
+{
+	if (this != &other)
+		*this = string_table(other);
+
+	return *this;
+}
+
+string_id string_table::intern(std::string_view str)
+{
+	if (utility::has_diacritics(str)) {
+		const std::string normalized = utility::remove_diacritics(str);
+		return intern(normalized);
+	}
+
+	if (const auto it = m_ids.find(str); it != m_ids.end())
+		return it->second;
+
+	const auto id = static_cast<string_id>(m_strings.size());
+	FS_ASSERT(id != npos);
+	m_strings.emplace_back(str);
+	m_ids.emplace(m_strings.back(), id);
+	return id;
+}
+
+string_id string_table::find(std::string_view str) const
+{
+	if (utility::has_diacritics(str)) {
+		const std::string normalized = utility::remove_diacritics(str);
+		return find(normalized);
+	}
+
+	if (const auto it = m_ids.find(str); it != m_ids.end())
+		return it->second;
+
+	return npos;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs::lang
+{
+
+using string_id = std::uint32_t;
+
+/*
+ * Maps strings to compact integer IDs so that exact (==) string tests
+ * can be done as integer comparisons.
+ *
+ * Strings are stored with diacritics removed (see utility::remove_diacritics)
+ * so "Maelström" and "Maelstrom" get the same ID. This is the game's (and
+ * compare_strings_ignore_diacritics) equivalence for requirements that have
+ * no diacritics. Requirements that do have diacritics are stricter (ö in the
+ * requirement only matches ö) - such strings should not be tested by IDs.
+ */
+class string_table
+{
+public:
+	static constexpr string_id npos = static_cast<string_id>(-1);
+
+	string_table() = default;
+	string_table(const string_table& other);
+	string_table(string_table&& other) noexcept = default;
+	string_table& operator=(const string_table& other);
+	string_table& operator=(string_table&& other) noexcept = default;
+
+	// returns ID of the string, adds it if it is not present
+	string_id intern(std::string_view str);
+
+	// returns ID of the string or npos if it is not present
+	[[nodiscard]] string_id find(std::string_view str) const;
+
+	// the string as stored (with diacritics removed)
+	[[nodiscard]] const std::string& str(string_id id) const { return m_strings[id]; }
+
+	[[nodiscard]] std::size_t size() const { return m_strings.size(); }
+
+private:
+	// deque never relocates its elements so map keys can point into it
+	std::deque<std::string> m_strings;
+	std::unordered_map<std::string_view, string_id> m_ids;
+};
+
+}
@@ -0,0 +1,418 @@
+#include <fs/lang/unreachable_blocks.hpp>
+#include <fs/lang/compiled_filter.hpp>
+#include <fs/utility/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <variant>
+
+namespace fs::lang
+{
+
+namespace
+{
+
+// intervals with at most this many values are expanded to value sets
+constexpr std::int64_t max_expanded_interval = 64;
+
+// everything that conditions of 1 block require from 1 integer property
+struct integer_constraint
+{
+	official_condition_property property = {};
+	int min = std::numeric_limits<int>::min();
+	int max = std::numeric_limits<int>::max();
+	std::optional<std::vector<int>> allowed; // sorted, if only specific values pass
+	std::vector<int> disallowed;             // sorted
+};
+
+struct block_constraints
+{
+	std::vector<integer_constraint> integers;
+	std::uint32_t flags_care = 0;
+	std::uint32_t flags_want = 0;
+	// conditions which are not integer or flags tests
+	std::vector<const compiled_condition*> others;
+	bool is_contradiction = false;
+};
+
+[[nodiscard]] std::vector<int>
+sorted_pool(const std::vector<int>& pool, const compiled_condition& cond)
+{
+	const auto first = pool.begin() + cond.first;
+	std::vector<int> result(first, first + cond.count);
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+[[nodiscard]] integer_constraint&
+find_or_add(std::vector<integer_constraint>& constraints, official_condition_property property)
+{
+	const auto it = std::find_if(constraints.begin(), constraints.end(), [&](const integer_constraint& c) {
+		return c.property == property;
+	});
+
+	if (it != constraints.end())
+		return *it;
+
+	integer_constraint& result = constraints.emplace_back();
+	result.property = property;
+	return result;
+}
+
+[[nodiscard]] const integer_constraint*
+find(const std::vector<integer_constraint>& constraints, official_condition_property property)
+{
+	const auto it = std::find_if(constraints.begin(), constraints.end(), [&](const integer_constraint& c) {
+		return c.property == property;
+	});
+
+	return it != constraints.end() ? &*it : nullptr;
+}
+
+void add_flags_requirement(block_constraints& constraints, std::uint32_t care, std::uint32_t want)
+{
+	if (((constraints.flags_want ^ want) & constraints.flags_care & care) != 0)
+		constraints.is_contradiction = true;
+
+	constraints.flags_care |= care;
+	constraints.flags_want |= want;
+}
+
+// intersects the interval with value lists, returns false if no value remains
+[[nodiscard]] bool normalize(integer_constraint& c)
+{
+	if (c.min > c.max)
+		return false;
+
+	if (!c.allowed && static_cast<std::int64_t>(c.max) - static_cast<std::int64_t>(c.min) < max_expanded_interval) {
+		c.allowed.emplace();
+		for (std::int64_t value = c.min; value <= c.max; ++value)
+			c.allowed->push_back(static_cast<int>(value));
+	}
+
+	if (!c.allowed)
+		return true;
+
+	auto& allowed = *c.allowed;
+	allowed.erase(std::remove_if(allowed.begin(), allowed.end(), [&](int value) {
+		return value < c.min || value > c.max || std::binary_search(c.disallowed.begin(), c.disallowed.end(), value);
+	}), allowed.end());
+
+	return !allowed.empty();
+}
+
+[[nodiscard]] block_constraints
+make_block_constraints(const compiled_filter& filter, const compiled_block& block)
+{
+	block_constraints result;
+
+	const auto first = filter.conditions.begin() + block.first_condition;
+	const auto last = first + block.num_conditions;
+	for (auto it = first; it != last; ++it) {
+		const compiled_condition& cond = *it;
+
+		switch (cond.test) {
+			case compiled_test::integer_range: {
+				integer_constraint& c = find_or_add(result.integers, cond.property);
+				c.min = std::max(c.min, cond.min);
+				c.max = std::min(c.max, cond.max);
+				break;
+			}
+			case compiled_test::integer_list: {
+				integer_constraint& c = find_or_add(result.integers, cond.property);
+				std::vector<int> values = sorted_pool(filter.integers, cond);
+
+				if (cond.flag) {
+					if (c.allowed) {
+						std::vector<int> intersection;
+						std::set_intersection(
+							c.allowed->begin(), c.allowed->end(),
+							values.begin(), values.end(),
+							std::back_inserter(intersection));
+						c.allowed = std::move(intersection);
+					}
+					else {
+						c.allowed = std::move(values);
+					}
+				}
+				else {
+					std::vector<int> sum;
+					std::set_union(
+						c.disallowed.begin(), c.disallowed.end(),
+						values.begin(), values.end(),
+						std::back_inserter(sum));
+					c.disallowed = std::move(sum);
+				}
+
+				break;
+			}
+			case compiled_test::boolean: {
+				const std::uint32_t bit = item_flag_mask(cond.property);
+				add_flags_requirement(result, bit, cond.flag ? bit : 0u);
+				break;
+			}
+			case compiled_test::flags: {
+				add_flags_requirement(result, static_cast<std::uint32_t>(cond.min), static_cast<std::uint32_t>(cond.max));
+				break;
+			}
+			case compiled_test::never: {
+				result.is_contradiction = true;
+				break;
+			}
+			case compiled_test::influence:
+			case compiled_test::strings:
+			case compiled_test::string_ids:
+			case compiled_test::substrings:
+			case compiled_test::counted_strings:
+			case compiled_test::sockets: {
+				result.others.push_back(&cond);
+				break;
+			}
+		}
+	}
+
+	for (integer_constraint& c : result.integers) {
+		if (!normalize(c))
+			result.is_contradiction = true;
+	}
+
+	return result;
+}
+
+template <typename T>
+[[nodiscard]] bool
+equal_pool_ranges(const std::vector<T>& pool, const compiled_condition& lhs, const compiled_condition& rhs)
+{
+	return lhs.count == rhs.count
+		&& std::equal(pool.begin() + lhs.first, pool.begin() + lhs.first + lhs.count, pool.begin() + rhs.first);
+}
+
+// whether 2 conditions test exactly the same thing (not necessarily the only way to be equivalent)
+[[nodiscard]] bool
+are_identical(const compiled_filter& filter, const compiled_condition& lhs, const compiled_condition& rhs)
+{
+	if (lhs.test != rhs.test
+		|| lhs.property != rhs.property
+		|| lhs.comparison != rhs.comparison
+		|| lhs.flag != rhs.flag
+		|| lhs.min != rhs.min
+		|| lhs.max != rhs.max)
+	{
+		return false;
+	}
+
+	switch (lhs.test) {
+		case compiled_test::strings:
+		case compiled_test::counted_strings:
+			return equal_pool_ranges(filter.strings, lhs, rhs);
+		case compiled_test::string_ids:
+			return equal_pool_ranges(filter.string_ids, lhs, rhs);
+		case compiled_test::sockets:
+			return equal_pool_ranges(filter.socket_specs, lhs, rhs);
+		case compiled_test::influence:
+			return true;
+		default:
+			// substring matchers can not be compared, other tests are not stored as "others"
+			return false;
+	}
+}
+
+[[nodiscard]] bool
+implies_integer_condition(const block_constraints& constraints, const compiled_filter& filter, const compiled_condition& cond)
+{
+	const integer_constraint* const c = find(constraints.integers, cond.property);
+	if (c == nullptr)
+		return false;
+
+	if (cond.test == compiled_test::integer_range) {
+		if (c->allowed) {
+			return std::all_of(c->allowed->begin(), c->allowed->end(), [&](int value) {
+				return cond.min <= value && value <= cond.max;
+			});
+		}
+
+		return cond.min <= c->min && c->max <= cond.max;
+	}
+
+	const std::vector<int> values = sorted_pool(filter.integers, cond);
+	const auto is_listed = [&](int value) { return std::binary_search(values.begin(), values.end(), value); };
+
+	if (cond.flag) // allowed values
+		return c->allowed && std::all_of(c->allowed->begin(), c->allowed->end(), is_listed);
+
+	// disallowed values
+	if (c->allowed)
+		return std::none_of(c->allowed->begin(), c->allowed->end(), is_listed);
+
+	return std::all_of(values.begin(), values.end(), [&](int value) {
+		return value < c->min || value > c->max || std::binary_search(c->disallowed.begin(), c->disallowed.end(), value);
+	});
+}
+
+[[nodiscard]] bool
+implies_influence_condition(const block_constraints& constraints, const compiled_condition& cond)
+{
+	const auto influences = static_cast<std::uint32_t>(cond.min);
+	const std::uint32_t required = constraints.flags_care & constraints.flags_want;
+
+	if (cond.max == 1) // None
+		return (constraints.flags_care & influence_flags_mask) == influence_flags_mask
+			&& (constraints.flags_want & influence_flags_mask) == 0;
+
+	if (cond.flag) // all listed influences
+		return (required & influences) == influences;
+
+	// any of listed influences
+	return (required & influences) != 0;
+}
+
+// whether an exact string condition of the constraints guarantees the string condition
+[[nodiscard]] bool
+implies_string_condition(const block_constraints& constraints, const compiled_filter& filter, const compiled_condition& cond)
+{
+	if (cond.test == compiled_test::substrings && cond.comparison == comparison_type::not_equal)
+		return false;
+
+	return std::any_of(constraints.others.begin(), constraints.others.end(), [&](const compiled_condition* other) {
+		if (other->test != compiled_test::string_ids || other->property != cond.property)
+			return false;
+
+		const auto first = filter.string_ids.begin() + other->first;
+		const auto last = first + other->count;
+
+		if (cond.test == compiled_test::string_ids) {
+			const auto cond_first = filter.string_ids.begin() + cond.first;
+			return std::includes(cond_first, cond_first + cond.count, first, last);
+		}
+
+		// each string which passes the exact test contains one of the substrings
+		const utility::substring_matcher& matcher = filter.substring_matchers[cond.first];
+		return std::all_of(first, last, [&](string_id id) {
+			return matcher.matches_any(filter.interned_strings.str(id));
+		});
+	});
+}
+
+// whether every item which satisfies constraints also passes the condition
+[[nodiscard]] bool
+implies(const block_constraints& constraints, const compiled_filter& filter, const compiled_condition& cond)
+{
+	switch (cond.test) {
+		case compiled_test::integer_range:
+		case compiled_test::integer_list:
+			return implies_integer_condition(constraints, filter, cond);
+		case compiled_test::boolean: {
+			const std::uint32_t bit = item_flag_mask(cond.property);
+			return (constraints.flags_care & bit) != 0 && ((constraints.flags_want & bit) != 0) == cond.flag;
+		}
+		case compiled_test::flags: {
+			const auto care = static_cast<std::uint32_t>(cond.min);
+			const auto want = static_cast<std::uint32_t>(cond.max);
+			return (care & ~constraints.flags_care) == 0 && (constraints.flags_want & care) == want;
+		}
+		case compiled_test::influence:
+			if (implies_influence_condition(constraints, cond))
+				return true;
+			break;
+		case compiled_test::string_ids:
+		case compiled_test::substrings:
+			if (implies_string_condition(constraints, filter, cond))
+				return true;
+			break;
+		case compiled_test::never:
+			return false;
+		case compiled_test::strings:
+		case compiled_test::counted_strings:
+		case compiled_test::sockets:
+			break;
+	}
+
+	return std::any_of(constraints.others.begin(), constraints.others.end(), [&](const compiled_condition* other) {
+		return are_identical(filter, *other, cond);
+	});
+}
+
+[[nodiscard]] bool
+catches_all_items_of(
+	const compiled_filter& filter,
+	const compiled_block& earlier,
+	const block_constraints& later_constraints)
+{
+	const auto first = filter.conditions.begin() + earlier.first_condition;
+	const auto last = first + earlier.num_conditions;
+	return std::all_of(first, last, [&](const compiled_condition& cond) {
+		return implies(later_constraints, filter, cond);
+	});
+}
+
+} // namespace
+
+std::vector<unreachable_block> find_unreachable_blocks(const item_filter& filter)
+{
+	// compile_item_filter drops import blocks and invalid blocks, remember where others were
+	std::vector<std::size_t> source_indexes;
+	for (std::size_t i = 0; i < filter.blocks.size(); ++i) {
+		const auto* const block = std::get_if<item_filter_block>(&filter.blocks[i]);
+		if (block != nullptr && block->is_valid())
+			source_indexes.push_back(i);
+	}
+
+	const compiled_filter compiled = compile_item_filter(filter);
+	FS_ASSERT(compiled.blocks.size() == source_indexes.size());
+
+	std::vector<block_constraints> constraints;
+	constraints.reserve(compiled.blocks.size());
+	for (const compiled_block& block : compiled.blocks)
+		constraints.push_back(make_block_constraints(compiled, block));
+
+	std::vector<unreachable_block> result;
+	for (std::size_t i = 0; i < compiled.blocks.size(); ++i) {
+		if (constraints[i].is_contradiction) {
+			result.push_back(unreachable_block{source_indexes[i], std::nullopt});
+			continue;
+		}
+
+		for (std::size_t j = 0; j < i; ++j) {
+			if (compiled.blocks[j].is_continue || constraints[j].is_contradiction)
+				continue;
+
+			if (catches_all_items_of(compiled, compiled.blocks[j], constraints[i])) {
+				result.push_back(unreachable_block{source_indexes[i], source_indexes[j]});
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<unreachable_block> remove_unreachable_blocks(item_filter& filter)
+{
+	std::vector<unreachable_block> unreachable = find_unreachable_blocks(filter);
+
+	// Removing all at once is safe: a removed block never matched, so it did not
+	// affect which items reached other blocks (including other removed ones).
+	std::size_t out = 0;
+	auto it = unreachable.begin();
+	for (std::size_t i = 0; i < filter.blocks.size(); ++i) {
+		if (it != unreachable.end() && it->block_index == i) {
+			++it;
+			continue;
+		}
+
+		if (out != i)
+			filter.blocks[out] = std::move(filter.blocks[i]);
+
+		++out;
+	}
+
+	filter.blocks.erase(filter.blocks.begin() + static_cast<std::ptrdiff_t>(out), filter.blocks.end());
+	return unreachable;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <fs/lang/item_filter.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace fs::lang
+{
+
+/*
+ * Detection of blocks which can never match any item.
+ *
+ * A block is unreachable if:
+ * - its conditions contradict each other (e.g. ItemLevel > 80 and ItemLevel < 60)
+ * - it is shadowed: an earlier non-Continue block catches every item which
+ *   would match it, e.g. (BaseType == "Chaos Orb", StackSize >= 10) after
+ *   (Class "Currency", StackSize >= 5). Generated blocks commonly overlap
+ *   hand-written ones this way.
+ *
+ * The analysis works on compiled conditions (see compiled_filter) where
+ * range bounds are intervals, value lists and exact strings are sets and
+ * boolean conditions are bit masks. A block shadows a later one if each of
+ * its conditions is implied by conditions of the later block on the same
+ * property. Implications which can not be proven this way (e.g. between
+ * 2 non-exact string conditions) are treated as absent - the analysis may
+ * miss some unreachable blocks but never reports a reachable one.
+ *
+ * Invalid blocks are not reported - they are never printed anyway.
+ */
+
+struct unreachable_block
+{
+	std::size_t block_index; // in item_filter::blocks
+
+	// earlier block which catches every item that this block would match,
+	// nothing if conditions of this block contradict each other
+	std::optional<std::size_t> shadowed_by;
+};
+
+// in the order of blocks
+[[nodiscard]] std::vector<unreachable_block> find_unreachable_blocks(const item_filter& filter);
+
+/*
+ * Removes blocks reported by find_unreachable_blocks. This does not change the
+ * result for any item. Returns removed blocks with indexes from before removal.
+ */
+std::vector<unreachable_block> remove_unreachable_blocks(item_filter& filter);
+
+}
@@ -11,9 +11,12 @@
 #include <boost/optional.hpp>
 #include <boost/spirit/home/x3/support/ast/variant.hpp>
 #include <boost/spirit/home/x3/support/ast/position_tagged.hpp>
+#include <boost/range/iterator_range_core.hpp>
 
+#include <cstddef>
 #include <utility>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 /*
@@ -85,7 +88,19 @@ namespace common
 		double value;
 	};
 
-	struct string_literal : std::string, x3::position_tagged {};
+	// text between quotes, refers to the parsed input (which must outlive the AST)
+	struct string_literal : x3::position_tagged
+	{
+		string_literal& operator=(boost::iterator_range<const char*> text)
+		{
+			value = std::string_view(text.begin(), static_cast<std::size_t>(text.size()));
+			return *this;
+		}
+
+		std::string_view get_value() const { return value; }
+
+		std::string_view value;
+	};
 
 	struct socket_spec_literal : x3::position_tagged
 	{
@@ -258,23 +273,24 @@ namespace rf
 	using none_literal = common::none_literal;
 
 	// TODO test that real filters support unquoted strings
+	// quoted or unquoted, refers to the parsed input (which must outlive the AST)
 	struct string : x3::position_tagged
 	{
 		auto& operator=(common::string_literal str)
 		{
-			value = std::move(static_cast<std::string&>(str));
+			value = str.value;
 			return *this;
 		}
 
-		auto& operator=(common::identifier str)
+		auto& operator=(boost::iterator_range<const char*> unquoted_text)
 		{
-			value = std::move(str.value);
+			value = std::string_view(unquoted_text.begin(), static_cast<std::size_t>(unquoted_text.size()));
 			return *this;
 		}
 
-		const auto& get_value() const { return value; }
+		std::string_view get_value() const { return value; }
 
-		std::string value;
+		std::string_view value;
 	};
 
 	using literal_expression = common::literal_expression;
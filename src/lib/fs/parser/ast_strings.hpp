@@ -0,0 +1,124 @@
+#pragma once
+
+#include <fs/parser/ast.hpp>
+#include <fs/parser/ast_adapted.hpp> // required adaptation info to visit members of AST types
+#include <fs/utility/type_traits.hpp>
+
+#include <boost/fusion/include/for_each.hpp>
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace fs::parser
+{
+
+/**
+ * @class visitor of all strings and all position-tagged nodes in an AST
+ *
+ * @details AST strings are views of the parsed input. This calls on_string(std::string_view&)
+ * for each of them, in the order of appearance. Each node which derives from x3::position_tagged
+ * is passed to on_node(x3::position_tagged&) before its members are visited. Recursion follows
+ * log::structure_printer which also has to handle every AST type.
+ */
+template <typename OnString, typename OnNode>
+struct ast_visitor
+{
+	// required by boost's Visitor concept
+	using result_type = void;
+
+	template <typename T>
+	void operator()(T& ast) const
+	{
+		if constexpr (std::is_base_of_v<x3::position_tagged, T>)
+			on_node(static_cast<x3::position_tagged&>(ast));
+
+		visit_members(ast);
+	}
+
+	void visit_members(ast::common::string_literal& sl) const { on_string(sl.value); }
+	void visit_members(ast::rf::string& str) const { on_string(str.value); }
+
+	// owned strings (identifiers) do not refer to the input
+	void visit_members(std::string& /* text */) const {}
+
+	template <typename T>
+	std::enable_if_t<fs::traits::is_iterable_v<T>>
+	visit_members(T& ast) const
+	{
+		for (auto& elem : ast)
+			(*this)(elem);
+	}
+
+	template <typename T>
+	std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>
+	visit_members(T& /* value */) const {}
+
+	template <typename T>
+	std::enable_if_t<std::is_empty_v<T> || traits::has_void_get_value_v<T>>
+	visit_members(T& /* ast */) const {}
+
+	template <typename T>
+	std::enable_if_t<fs::traits::has_pointer_semantics_v<T>>
+	visit_members(T& obj) const
+	{
+		if (obj)
+			(*this)(*obj);
+	}
+
+	template <typename T>
+	std::enable_if_t<boost::fusion::traits::is_sequence<T>::value>
+	visit_members(T& seq) const
+	{
+		boost::fusion::for_each(seq, [this](auto& arg) { (*this)(arg); });
+	}
+
+	template <typename T>
+	std::enable_if_t<traits::has_non_void_get_value_v<T>>
+	visit_members(T& obj) const
+	{
+		using value_type = decltype(obj.get_value());
+		static_assert(!std::is_same_v<std::decay_t<value_type>, std::string_view>,
+			"AST type which refers to the input needs its own overload");
+
+		// wrappers of other ASTs (e.g. definition) only expose them through const get_value()
+		if constexpr (std::is_reference_v<value_type>)
+			(*this)(const_cast<std::decay_t<value_type>&>(obj.get_value()));
+	}
+
+	template <typename... T>
+	void visit_members(boost::spirit::x3::variant<T...>& v) const
+	{
+		boost::apply_visitor(*this, v);
+	}
+
+	template <typename T>
+	void visit_members(boost::spirit::x3::forward_ast<T>& ast) const
+	{
+		(*this)(ast.get());
+	}
+
+	// lowest priority overload for unmatched Ts
+	template <typename T = void>
+	void visit_members(...) const
+	{
+		static_assert(sizeof(T) == 0, "Missing overload for some T or missing include for fusion types adaptations");
+	}
+
+	OnString on_string;
+	OnNode on_node;
+};
+
+template <typename Ast, typename OnString, typename OnNode>
+void visit_ast(Ast& ast, OnString on_string, OnNode on_node)
+{
+	ast_visitor<OnString, OnNode>{std::move(on_string), std::move(on_node)}(ast);
+}
+
+template <typename Ast, typename F>
+void for_each_ast_string(Ast& ast, F f)
+{
+	visit_ast(ast, std::move(f), [](x3::position_tagged& /* node */) {});
+}
+
+}
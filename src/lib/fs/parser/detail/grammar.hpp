@@ -224,6 +224,9 @@ namespace common
 	using integer_literal_type = x3::rule<integer_literal_class, ast::common::integer_literal>;
 	BOOST_SPIRIT_DECLARE(integer_literal_type)
 
+	// text is matched as a range of the input so that no string is built during parsing
+	using string_literal_text_type = x3::rule<struct string_literal_text_class, range_type>;
+	BOOST_SPIRIT_DECLARE(string_literal_text_type)
 	using string_literal_type = x3::rule<string_literal_class, ast::common::string_literal>;
 	BOOST_SPIRIT_DECLARE(string_literal_type)
 
@@ -292,6 +295,9 @@ namespace rf
 {
 	// ---- literal types ----
 
+	// same grammar as identifier, matched as a range of the input
+	using unquoted_string_type = x3::rule<struct unquoted_string_class, range_type>;
+	BOOST_SPIRIT_DECLARE(unquoted_string_type)
 	using string_type = x3::rule<string_class, ast::rf::string>;
 	BOOST_SPIRIT_DECLARE(string_type)
 
@@ -94,8 +94,12 @@ namespace common
 	const auto integer_literal_def = x3::int_;
 	BOOST_SPIRIT_DEFINE(integer_literal)
 
+	const string_literal_text_type string_literal_text = "string";
+	const auto string_literal_text_def = x3::raw[*(x3::char_ - (x3::lit('"') | '\n' | '\r'))];
+	BOOST_SPIRIT_DEFINE(string_literal_text)
+
 	const string_literal_type string_literal = "string";
-	const auto string_literal_def = x3::lexeme['"' > *(x3::char_ - (x3::lit('"') | '\n' | '\r')) > '"'];
+	const auto string_literal_def = x3::lexeme['"' > string_literal_text > '"'];
 	BOOST_SPIRIT_DEFINE(string_literal)
 
 	const socket_spec_literal_type socket_spec_literal = "socket spec literal";
@@ -218,8 +222,12 @@ namespace rf
 
 	// ---- literal types ----
 
+	const unquoted_string_type unquoted_string = "identifier";
+	const auto unquoted_string_def = x3::raw[x3::lexeme[(x3::alpha | x3::char_('_')) > *(x3::alnum | x3::char_('_'))]];
+	BOOST_SPIRIT_DEFINE(unquoted_string)
+
 	const string_type string = "string";
-	const auto string_def = common::string_literal | common::identifier;
+	const auto string_def = common::string_literal | unquoted_string;
 	BOOST_SPIRIT_DEFINE(string)
 
 	// ---- expressions ----
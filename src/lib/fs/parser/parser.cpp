@@ -1,8 +1,13 @@
 #include <fs/parser/parser.hpp>
+#include <fs/parser/ast_strings.hpp>
 #include <fs/parser/detail/grammar.hpp>
 #include <fs/log/logger.hpp>
 
 #include <algorithm>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace fs::parser {
 namespace {
@@ -53,6 +58,202 @@ parse_impl(
 	};
 }
 
+// moves positions from the text before the edit to the text after it
+class position_mapping
+{
+public:
+	position_mapping(iterator_type previous_first, iterator_type first, iterator_type last, text_edit edit)
+	: _previous_first(previous_first), _first(first), _last(last), _edit(edit)
+	{
+	}
+
+	std::size_t previous_offset(iterator_type previous_pos) const
+	{
+		return static_cast<std::size_t>(previous_pos - _previous_first);
+	}
+
+	bool is_before_edit(iterator_type previous_pos) const
+	{
+		return previous_offset(previous_pos) < _edit.offset;
+	}
+
+	iterator_type operator()(iterator_type previous_pos) const
+	{
+		const std::size_t offset = previous_offset(previous_pos);
+
+		if (offset <= _edit.offset)
+			return _first + offset;
+
+		if (offset >= _edit.offset + _edit.removed_size)
+			return _first + (offset - _edit.removed_size + _edit.inserted_size);
+
+		// position inside removed text - only possible for ASTs which are not used anymore
+		return _first + _edit.offset;
+	}
+
+	iterator_type first() const { return _first; }
+	iterator_type last() const { return _last; }
+
+private:
+	iterator_type _previous_first;
+	iterator_type _first;
+	iterator_type _last;
+	text_edit _edit;
+};
+
+/*
+ * Top-level ASTs are parsed independently of each other, which makes them
+ * natural points of resynchronization. Top-level ASTs that end before the edit
+ * and start after it are kept, everything between is parsed again. 1 unchanged
+ * AST on each side is parsed again too - if the new parse reproduces them
+ * exactly, it agrees with the rest of the previous parse.
+ *
+ * Position cache of the result contains positions of the new parse followed by
+ * positions of kept ASTs, which get new IDs while their strings are moved to
+ * the new text. Positions of replaced ASTs are dropped, so the cache does not
+ * grow with the number of edits.
+ */
+template <
+	typename ParsedFilterType,
+	typename Ast,
+	typename Grammar,
+	typename Skipper,
+	typename TopLevelAsts,
+	typename RegionFirst,
+	typename RegionValidator
+>
+std::optional<ParsedFilterType>
+reparse_impl(
+	std::string_view input,
+	ParsedFilterType& previous,
+	text_edit edit,
+	Grammar grammar,
+	Skipper skipper,
+	TopLevelAsts top_level_asts, // Ast& => std::vector<T>&
+	RegionFirst region_first_if_no_kept_asts, // (const ParsedFilterType&, const position_mapping&) => optional<iterator_type>
+	RegionValidator is_valid_region) // (const Ast&) => bool
+{
+	const range_type previous_range = previous.metadata.lookup.whole_range();
+	const auto previous_size = static_cast<std::size_t>(previous_range.size());
+
+	if (edit.offset + edit.removed_size > previous_size
+		|| previous_size - edit.removed_size + edit.inserted_size != input.size())
+	{
+		return std::nullopt;
+	}
+
+	const position_mapping map(previous_range.begin(), input.data(), input.data() + input.size(), edit);
+	const lookup_data& previous_lookup = previous.metadata.lookup;
+	auto& previous_asts = top_level_asts(previous.ast);
+
+	const auto begin_offset = [&](const x3::position_tagged& ast) {
+		return map.previous_offset(previous_lookup.range_of(ast).begin());
+	};
+	const auto end_offset = [&](const x3::position_tagged& ast) {
+		return map.previous_offset(previous_lookup.range_of(ast).end());
+	};
+
+	// [first_affected, first_unaffected) touch the edit, [first_reparsed, last_reparsed) are parsed again
+	const auto first_affected = std::partition_point(previous_asts.begin(), previous_asts.end(),
+		[&](const auto& ast) { return end_offset(ast) < edit.offset; });
+	const auto first_reparsed = first_affected == previous_asts.begin() ? first_affected : first_affected - 1;
+
+	const auto first_unaffected = std::partition_point(first_affected, previous_asts.end(),
+		[&](const auto& ast) { return begin_offset(ast) <= edit.offset + edit.removed_size; });
+	const auto last_reparsed = first_unaffected == previous_asts.end() ? first_unaffected : first_unaffected + 1;
+
+	iterator_type region_first = nullptr;
+	if (first_reparsed != previous_asts.begin()) {
+		region_first = map(previous_lookup.range_of(*(first_reparsed - 1)).end());
+	}
+	else {
+		const std::optional<iterator_type> first = region_first_if_no_kept_asts(previous, map);
+		if (!first)
+			return std::nullopt;
+
+		region_first = *first;
+	}
+
+	const iterator_type region_last = last_reparsed == previous_asts.end()
+		? map.last()
+		: map(previous_lookup.range_of(*last_reparsed).begin());
+
+	if (region_first > region_last)
+		return std::nullopt;
+
+	detail::position_cache_type position_cache(map.first(), map.last());
+
+	error_holder_type error_holder;
+	const auto parser = x3::with<detail::position_cache_tag>(std::ref(position_cache))
+	[
+		x3::with<detail::error_holder_tag>(std::ref(error_holder))[grammar]
+	];
+
+	Ast region_ast;
+	const char* it = region_first;
+	const bool result = x3::phrase_parse(it, region_last, parser, skipper, region_ast);
+
+	if (it != region_last || !result || !is_valid_region(region_ast))
+		return std::nullopt;
+
+	auto& region_asts = top_level_asts(region_ast);
+	const auto same_range = [&](const x3::position_tagged& previous_ast, const x3::position_tagged& ast) {
+		const range_type previous_ast_range = previous_lookup.range_of(previous_ast);
+		const range_type ast_range = position_cache.position_of(ast);
+		return map(previous_ast_range.begin()) == ast_range.begin() && map(previous_ast_range.end()) == ast_range.end();
+	};
+
+	if (first_reparsed != first_affected) {
+		if (region_asts.empty() || !same_range(*first_reparsed, region_asts.front()))
+			return std::nullopt;
+	}
+
+	if (last_reparsed != first_unaffected) {
+		if (region_asts.empty() || !same_range(*first_unaffected, region_asts.back()))
+			return std::nullopt;
+	}
+
+	// the root spans all top-level ASTs, its ends can be in the parsed region
+	const x3::position_tagged* root_node = nullptr;
+	if constexpr (std::is_base_of_v<x3::position_tagged, Ast>) {
+		root_node = &previous.ast;
+		const range_type previous_root_range = previous_lookup.range_of(previous.ast);
+		const range_type region_root_range = position_cache.position_of(region_ast);
+		position_cache.annotate(
+			previous.ast,
+			region_first == map.first() ? region_root_range.begin() : map(previous_root_range.begin()),
+			region_last == map.last() ? region_root_range.end() : map(previous_root_range.end()));
+	}
+
+	const auto replaced_first = previous_asts.erase(first_reparsed, last_reparsed);
+	// kept ASTs refer to the previous input, they do not touch the edit so their strings are moved as a whole
+	visit_ast(
+		previous.ast,
+		[&](std::string_view& str) {
+			str = std::string_view(map(str.data()), str.size());
+		},
+		[&](x3::position_tagged& node) {
+			// not every position-tagged node is annotated by the grammar, the root has been done above
+			if (node.id_first < 0 || &node == root_node)
+				return;
+
+			const range_type previous_node_range = previous_lookup.range_of(node);
+			position_cache.annotate(node, map(previous_node_range.begin()), map(previous_node_range.end()));
+		});
+	previous_asts.insert(
+		replaced_first,
+		std::make_move_iterator(region_asts.begin()),
+		std::make_move_iterator(region_asts.end()));
+
+	return ParsedFilterType{
+		std::move(previous.ast),
+		parse_metadata{
+			lookup_data(std::move(position_cache)),
+			line_lookup(previous.metadata.lines, previous_range.begin(), map.first(), map.last(), edit)
+		},
+	};
+}
+
 void print_error(
 	const parse_error& error,
 	const parse_metadata& metadata,
@@ -90,6 +291,50 @@ std::vector<range_type> line_lookup::split_lines(iterator_type first, iterator_t
 	return result;
 }
 
+line_lookup::line_lookup(
+	const line_lookup& previous,
+	iterator_type previous_first,
+	iterator_type first,
+	iterator_type last,
+	text_edit edit)
+{
+	const auto offset_of = [&](iterator_type pos) {
+		return static_cast<std::size_t>(pos - previous_first);
+	};
+
+	// Lines start after LF. Lines which start before the edit and lines which
+	// start after LF that follows the edit are not affected by it.
+	const auto first_affected = std::partition_point(previous._lines.begin(), previous._lines.end(),
+		[&](range_type line) { return offset_of(line.begin()) <= edit.offset; });
+	const auto first_kept = std::partition_point(first_affected, previous._lines.end(),
+		[&](range_type line) { return offset_of(line.begin()) <= edit.offset + edit.removed_size; });
+
+	// the line that contains the edit is split again (if it started before the edit)
+	const auto first_split = first_affected == previous._lines.begin() ? first_affected : first_affected - 1;
+	const iterator_type split_first = first_split == previous._lines.begin()
+		? first
+		: first + offset_of(first_split->begin());
+
+	const auto move_line = [&](range_type line) {
+		const std::size_t line_offset = offset_of(line.begin()) - edit.removed_size + edit.inserted_size;
+		return range_type(first + line_offset, first + line_offset + line.size());
+	};
+
+	const iterator_type split_last = first_kept == previous._lines.end()
+		? last
+		: move_line(*first_kept).begin();
+
+	_lines.reserve(previous._lines.size());
+	for (auto it = previous._lines.begin(); it != first_split; ++it)
+		_lines.emplace_back(first + offset_of(it->begin()), first + offset_of(it->end()));
+
+	const std::vector<range_type> split_lines_result = split_lines(split_first, split_last);
+	_lines.insert(_lines.end(), split_lines_result.begin(), split_lines_result.end());
+
+	for (auto it = first_kept; it != previous._lines.end(); ++it)
+		_lines.push_back(move_line(*it));
+}
+
 std::vector<range_type>::const_iterator line_lookup::find_line(iterator_type pos) const
 {
 	return std::lower_bound(_lines.begin(), _lines.end(), pos,
@@ -138,6 +383,59 @@ std::variant<parsed_real_filter, parse_failure_data> parse_real_filter(std::stri
 	return parse_impl<parsed_real_filter, ast::rf::ast_type>(input, detail::rf_grammar(), detail::rf_skipper());
 }
 
+std::variant<parsed_spirit_filter, parse_failure_data>
+parse_spirit_filter(std::string_view input, parsed_spirit_filter previous, text_edit edit)
+{
+	std::optional<parsed_spirit_filter> result = reparse_spirit_filter(input, previous, edit);
+	if (result)
+		return std::move(*result);
+
+	return parse_spirit_filter(input);
+}
+
+std::optional<parsed_spirit_filter>
+reparse_spirit_filter(std::string_view input, parsed_spirit_filter& previous, text_edit edit)
+{
+	return reparse_impl<parsed_spirit_filter, ast::sf::ast_type>(
+		input, previous, edit, detail::sf_grammar(), detail::sf_skipper(),
+		[](ast::sf::ast_type& ast) -> std::vector<ast::sf::statement>& { return ast.statements; },
+		[](const parsed_spirit_filter& previous, const position_mapping& map) -> std::optional<iterator_type> {
+			// definitions are not parsed again - the edit must be after them
+			if (previous.ast.definitions.empty())
+				return map.first();
+
+			const iterator_type definitions_last = previous.metadata.lookup.range_of(previous.ast.definitions.back()).end();
+			if (!map.is_before_edit(definitions_last))
+				return std::nullopt;
+
+			return map(definitions_last);
+		},
+		// definitions can not follow statements
+		[](const ast::sf::ast_type& region_ast) { return region_ast.definitions.empty(); });
+}
+
+std::variant<parsed_real_filter, parse_failure_data>
+parse_real_filter(std::string_view input, parsed_real_filter previous, text_edit edit)
+{
+	std::optional<parsed_real_filter> result = reparse_real_filter(input, previous, edit);
+	if (result)
+		return std::move(*result);
+
+	return parse_real_filter(input);
+}
+
+std::optional<parsed_real_filter>
+reparse_real_filter(std::string_view input, parsed_real_filter& previous, text_edit edit)
+{
+	return reparse_impl<parsed_real_filter, ast::rf::ast_type>(
+		input, previous, edit, detail::rf_grammar(), detail::rf_skipper(),
+		[](ast::rf::ast_type& ast) -> ast::rf::ast_type& { return ast; },
+		[](const parsed_real_filter& /* previous */, const position_mapping& map) -> std::optional<iterator_type> {
+			return map.first();
+		},
+		[](const ast::rf::ast_type& /* region_ast */) { return true; });
+}
+
 void print_parse_errors(const parse_failure_data& parse_data, log::logger& logger)
 {
 	if (parse_data.errors.empty()) {
@@ -6,6 +6,7 @@
 #include <fs/utility/string_helpers.hpp>
 #include <fs/utility/assert.hpp>
 
+#include <optional>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -44,6 +45,18 @@ struct underlined_text
 	std::string_view underline;
 };
 
+/*
+ * A single change of text: removed_size characters starting at offset
+ * were replaced by inserted_size characters. Offsets are in characters
+ * (bytes), not lines/columns.
+ */
+struct text_edit
+{
+	std::size_t offset = 0;
+	std::size_t removed_size = 0;
+	std::size_t inserted_size = 0;
+};
+
 inline std::string_view range_to_text(range_type range)
 {
 	return utility::make_string_view(range.begin(), range.end());
@@ -57,6 +70,15 @@ public:
 	{
 	}
 
+	// lines of edited text: only lines affected by the edit are split again,
+	// remaining ones are moved to the new text
+	line_lookup(
+		const line_lookup& previous,
+		iterator_type previous_first,
+		iterator_type first,
+		iterator_type last,
+		text_edit edit);
+
 	text_context text_context_for(range_type range) const;
 
 	text_position text_position_for(iterator_type pos) const;
@@ -128,7 +150,7 @@ public:
 		return result;
 	}
 
-private:
+	// exact range of the AST, without any trimming
 	[[nodiscard]]
 	range_type range_of(const x3::position_tagged& ast) const
 	{
@@ -141,6 +163,13 @@ private:
 		return range_type(_position_cache.first(), _position_cache.last());
 	}
 
+	[[nodiscard]]
+	const detail::position_cache_type& position_cache() const
+	{
+		return _position_cache;
+	}
+
+private:
 	detail::position_cache_type _position_cache;
 };
 
@@ -174,6 +203,30 @@ struct parsed_spirit_filter
 [[nodiscard]]
 std::variant<parsed_spirit_filter, parse_failure_data> parse_spirit_filter(std::string_view input);
 
+/*
+ * Incremental parsing: input is the text after the edit, previous is the
+ * result of parsing the text before the edit. Only top-level statements
+ * (blocks for real filters) around the edit are parsed again, the rest of
+ * AST is reused (with positions moved to the new text). When the edit can
+ * not be handled this way (e.g. it touches definitions or parsed statements
+ * do not line up with unchanged ones) the whole input is parsed again.
+ *
+ * The result is the same as parsing the whole input. Text of the previous
+ * parse is never read, only positions within it are used.
+ */
+[[nodiscard]]
+std::variant<parsed_spirit_filter, parse_failure_data>
+parse_spirit_filter(std::string_view input, parsed_spirit_filter previous, text_edit edit);
+
+/*
+ * Only the incremental part of the above: returns nothing (and leaves previous
+ * untouched) if the edit can not be handled without parsing the whole input.
+ * On success previous is moved into the result.
+ */
+[[nodiscard]]
+std::optional<parsed_spirit_filter>
+reparse_spirit_filter(std::string_view input, parsed_spirit_filter& previous, text_edit edit);
+
 struct parsed_real_filter
 {
 	ast::rf::ast_type ast;
@@ -183,4 +236,12 @@ struct parsed_real_filter
 [[nodiscard]]
 std::variant<parsed_real_filter, parse_failure_data> parse_real_filter(std::string_view input);
 
+[[nodiscard]]
+std::variant<parsed_real_filter, parse_failure_data>
+parse_real_filter(std::string_view input, parsed_real_filter previous, text_edit edit);
+
+[[nodiscard]]
+std::optional<parsed_real_filter>
+reparse_real_filter(std::string_view input, parsed_real_filter& previous, text_edit edit);
+
 } // namespace fs::parser
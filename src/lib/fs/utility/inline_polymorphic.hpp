@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fs::utility
+{
+
+/**
+ * @brief value-semantic holder of an object from a polymorphic class hierarchy
+ *
+ * @details Stores any type derived from Base directly inside (no heap allocation),
+ * as long as it fits into the Capacity. Copying and moving copy/move the held
+ * object itself (no sharing, no reference counting). Can be empty, which is
+ * similar to a null pointer - the interface mimics smart pointers.
+ *
+ * Base does not need any virtual cloning functions. Object operations are
+ * captured when the holder is created (the concrete type is known only then).
+ * Moves are assumed not to throw (held types may only allocate when copied).
+ */
+template <typename Base, std::size_t Capacity, std::size_t Alignment = alignof(std::max_align_t)>
+class inline_polymorphic
+{
+public:
+	static constexpr std::size_t capacity = Capacity;
+
+	inline_polymorphic() noexcept {}
+	inline_polymorphic(std::nullptr_t) noexcept {}
+
+	template <typename T, typename... Args>
+	static inline_polymorphic make(Args&&... args)
+	{
+		static_assert(std::is_base_of_v<Base, T>);
+		static_assert(sizeof(T) <= Capacity, "type is too big for this holder, increase the capacity");
+		static_assert(Alignment % alignof(T) == 0, "type alignment is not supported by this holder");
+
+		inline_polymorphic result;
+		result.m_ptr = ::new (static_cast<void*>(&result.m_storage)) T(std::forward<Args>(args)...);
+		result.m_ops = &ops_for<T>;
+		return result;
+	}
+
+	inline_polymorphic(const inline_polymorphic& other)
+	{
+		if (other.m_ops != nullptr) {
+			m_ptr = other.m_ops->copy(&other.m_storage, &m_storage);
+			m_ops = other.m_ops;
+		}
+	}
+
+	inline_polymorphic(inline_polymorphic&& other) noexcept
+	{
+		take(other);
+	}
+
+	inline_polymorphic& operator=(const inline_polymorphic& other)
+	{
+		if (this != &other) {
+			inline_polymorphic copy(other);
+			*this = std::move(copy);
+		}
+
+		return *this;
+	}
+
+	inline_polymorphic& operator=(inline_polymorphic&& other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			take(other);
+		}
+
+		return *this;
+	}
+
+	~inline_polymorphic()
+	{
+		reset();
+	}
+
+	void reset() noexcept
+	{
+		if (m_ops != nullptr) {
+			m_ops->destroy(&m_storage);
+			m_ops = nullptr;
+			m_ptr = nullptr;
+		}
+	}
+
+	Base* get() noexcept { return m_ptr; }
+	const Base* get() const noexcept { return m_ptr; }
+
+	Base* operator->() noexcept { return m_ptr; }
+	const Base* operator->() const noexcept { return m_ptr; }
+
+	Base& operator*() noexcept { return *m_ptr; }
+	const Base& operator*() const noexcept { return *m_ptr; }
+
+	explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+	friend bool operator==(const inline_polymorphic& lhs, std::nullptr_t) noexcept { return lhs.m_ptr == nullptr; }
+	friend bool operator!=(const inline_polymorphic& lhs, std::nullptr_t) noexcept { return lhs.m_ptr != nullptr; }
+
+private:
+	// leaves other empty
+	void take(inline_polymorphic& other) noexcept
+	{
+		if (other.m_ops != nullptr) {
+			m_ptr = other.m_ops->move(&other.m_storage, &m_storage);
+			m_ops = other.m_ops;
+			other.m_ptr = nullptr;
+			other.m_ops = nullptr;
+		}
+	}
+
+	using storage_type = std::aligned_storage_t<Capacity, Alignment>;
+
+	struct operations
+	{
+		Base* (*copy)(const void* source, void* destination);
+		Base* (*move)(void* source, void* destination) noexcept;
+		void (*destroy)(void* object) noexcept;
+	};
+
+	template <typename T>
+	static Base* copy_object(const void* source, void* destination)
+	{
+		return ::new (destination) T(*static_cast<const T*>(source));
+	}
+
+	// moved-from source is destroyed immediately
+	template <typename T>
+	static Base* move_object(void* source, void* destination) noexcept
+	{
+		T* const source_object = static_cast<T*>(source);
+		Base* const result = ::new (destination) T(std::move(*source_object));
+		source_object->~T();
+		return result;
+	}
+
+	template <typename T>
+	static void destroy_object(void* object) noexcept
+	{
+		static_cast<T*>(object)->~T();
+	}
+
+	template <typename T>
+	static constexpr operations ops_for = { &copy_object<T>, &move_object<T>, &destroy_object<T> };
+
+	storage_type m_storage;
+	// always points into m_storage or is null, saves recomputing base class offset on each access
+	Base* m_ptr = nullptr;
+	const operations* m_ops = nullptr;
+};
+
+}
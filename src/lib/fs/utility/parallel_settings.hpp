@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fs::utility {
+
+class thread_pool;
+
+// how utility::parallel_for (fs/utility/thread_pool.hpp) should split work
+struct parallel_settings
+{
+	// threads which help the calling thread, null means the calling thread does all work
+	thread_pool* pool = nullptr;
+	// number of consecutive indexes taken by a thread at once
+	std::size_t chunk_size = 256;
+};
+
+}
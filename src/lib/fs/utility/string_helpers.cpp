@@ -2,6 +2,22 @@
 #include <fs/utility/assert.hpp>
 
 #include <algorithm>
+#include <cstring>
+
+// x86-64 always has SSE2, AVX2 is selected at runtime (requires GCC/Clang target attributes)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FS_STRING_HELPERS_SSE2
+	#include <emmintrin.h>
+
+	#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		#define FS_STRING_HELPERS_AVX2
+		#include <immintrin.h>
+	#endif
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
 
 namespace
 {
@@ -69,23 +85,21 @@ const char* skip(const char* first, const char* last) noexcept
 			continue;
 		}
 
-		for (auto letter : letters) {
-			if (*req_it == letter.ascii && static_cast<unsigned char>(*val_it) == letter.utf8_first_byte) {
-				if (++val_it == val_last)
-					return false;
-
-				if (static_cast<unsigned char>(*val_it) == letter.utf8_second_byte) {
-					++req_it;
-					++val_it;
-					continue;
-				}
-				else {
-					return false;
-				}
-			}
-		}
+		const auto it = std::find_if(letters.begin(), letters.end(), [&](two_byte_letter letter) {
+			return *req_it == letter.ascii && static_cast<unsigned char>(*val_it) == letter.utf8_first_byte;
+		});
 
-		return false;
+		if (it == letters.end())
+			return false;
+
+		if (++val_it == val_last)
+			return false;
+
+		if (static_cast<unsigned char>(*val_it) != it->utf8_second_byte)
+			return false;
+
+		++req_it;
+		++val_it;
 	}
 
 	FS_ASSERT_MSG(req_it == req_last || val_it == val_last, "at least one of iterators should hit end");
@@ -100,6 +114,136 @@ const char* skip(const char* first, const char* last) noexcept
 	return allow_starts_with_match;
 }
 
+// Scanning functions below search for a position in value at which requirement starts.
+// Only positions [0, value.size() - requirement.size()] can start a match.
+// Requirement must not be empty.
+
+[[nodiscard]] std::size_t num_start_positions(std::string_view value, std::string_view requirement) noexcept
+{
+	return value.size() - requirement.size() + 1u;
+}
+
+// letters with diacritics start with this byte - see compare_strings_ignore_diacritics_impl
+constexpr auto utf8_lead_byte = static_cast<char>(0xC3);
+
+// whether requirement's first letter can also match a letter with diacritics
+[[nodiscard]] bool first_letter_folds(std::string_view requirement) noexcept
+{
+	return requirement.front() == 'o' || requirement.front() == 'O';
+}
+
+[[nodiscard]] bool
+find_ignore_diacritics_scalar(std::string_view value, std::string_view requirement, std::size_t first_position = 0)
+{
+	const std::size_t num_positions = num_start_positions(value, requirement);
+
+	for (std::size_t i = first_position; i < num_positions; ++i) {
+		if (compare_strings_ignore_diacritics_impl(value.substr(i), requirement, true))
+			return true;
+	}
+
+	return false;
+}
+
+#ifdef FS_STRING_HELPERS_SSE2
+
+[[nodiscard]] unsigned count_trailing_zeros(unsigned mask) noexcept
+{
+	FS_ASSERT(mask != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// test each candidate position (set bit) of the block starting at value[offset]
+[[nodiscard]] bool
+test_candidates(std::string_view value, std::string_view requirement, std::size_t offset, unsigned mask)
+{
+	while (mask != 0u) {
+		if (compare_strings_ignore_diacritics_impl(value.substr(offset + count_trailing_zeros(mask)), requirement, true))
+			return true;
+
+		mask &= mask - 1u;
+	}
+
+	return false;
+}
+
+[[nodiscard]] bool
+find_ignore_diacritics_sse2(std::string_view value, std::string_view requirement)
+{
+	constexpr std::size_t block_size = 16;
+	const std::size_t num_positions = num_start_positions(value, requirement);
+	const bool folds = first_letter_folds(requirement);
+	const __m128i first_letter = _mm_set1_epi8(requirement.front());
+	const __m128i lead_byte = _mm_set1_epi8(utf8_lead_byte);
+
+	std::size_t i = 0;
+	for (; i + block_size <= num_positions; i += block_size) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data() + i));
+		__m128i candidates = _mm_cmpeq_epi8(block, first_letter);
+		if (folds)
+			candidates = _mm_or_si128(candidates, _mm_cmpeq_epi8(block, lead_byte));
+
+		if (test_candidates(value, requirement, i, static_cast<unsigned>(_mm_movemask_epi8(candidates))))
+			return true;
+	}
+
+	return find_ignore_diacritics_scalar(value, requirement, i);
+}
+
+#endif // FS_STRING_HELPERS_SSE2
+
+#ifdef FS_STRING_HELPERS_AVX2
+
+__attribute__((target("avx2"))) [[nodiscard]] bool
+find_ignore_diacritics_avx2(std::string_view value, std::string_view requirement)
+{
+	constexpr std::size_t block_size = 32;
+	const std::size_t num_positions = num_start_positions(value, requirement);
+	const bool folds = first_letter_folds(requirement);
+	const __m256i first_letter = _mm256_set1_epi8(requirement.front());
+	const __m256i lead_byte = _mm256_set1_epi8(utf8_lead_byte);
+
+	std::size_t i = 0;
+	for (; i + block_size <= num_positions; i += block_size) {
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value.data() + i));
+		__m256i candidates = _mm256_cmpeq_epi8(block, first_letter);
+		if (folds)
+			candidates = _mm256_or_si256(candidates, _mm256_cmpeq_epi8(block, lead_byte));
+
+		if (test_candidates(value, requirement, i, static_cast<unsigned>(_mm256_movemask_epi8(candidates))))
+			return true;
+	}
+
+	// remaining positions are fewer than 32, let SSE2 and scalar code handle them
+	return find_ignore_diacritics_sse2(value.substr(i), requirement);
+}
+
+#endif // FS_STRING_HELPERS_AVX2
+
+using find_function_type = bool (*)(std::string_view, std::string_view);
+
+[[nodiscard]] find_function_type select_find_function() noexcept
+{
+#if defined(FS_STRING_HELPERS_AVX2)
+	if (__builtin_cpu_supports("avx2"))
+		return &find_ignore_diacritics_avx2;
+#endif
+
+#if defined(FS_STRING_HELPERS_SSE2)
+	return &find_ignore_diacritics_sse2;
+#else
+	return [](std::string_view value, std::string_view requirement) {
+		return find_ignore_diacritics_scalar(value, requirement);
+	};
+#endif
+}
+
 } // namespace
 
 namespace fs::utility
@@ -111,6 +255,27 @@ bool compare_strings_ignore_diacritics(
 	if (requirement.size() > value.size())
 		return false;
 
+	if (exact_match_required) {
+		// without diacritics in the value this is a plain comparison
+		if (std::memchr(value.data(), utf8_lead_byte, value.size()) == nullptr)
+			return value == requirement;
+
+		return compare_strings_ignore_diacritics_impl(value, requirement, false);
+	}
+
+	if (requirement.empty())
+		return true;
+
+	static const find_function_type find_function = select_find_function();
+	return find_function(value, requirement);
+}
+
+bool compare_strings_ignore_diacritics_scalar(
+	std::string_view value, std::string_view requirement, bool exact_match_required)
+{
+	if (requirement.size() > value.size())
+		return false;
+
 	if (exact_match_required)
 		return compare_strings_ignore_diacritics_impl(value, requirement, false);
 
@@ -124,6 +289,39 @@ bool compare_strings_ignore_diacritics(
 	return false;
 }
 
+std::string remove_diacritics(std::string_view str)
+{
+	std::string result;
+	result.reserve(str.size());
+
+	for (std::size_t i = 0; i < str.size(); ++i) {
+		if (static_cast<unsigned char>(str[i]) == 0xC3 && i + 1 < str.size()) {
+			const auto next = static_cast<unsigned char>(str[i + 1]);
+
+			if (next == 0xB6) { // ö
+				result.push_back('o');
+				++i;
+				continue;
+			}
+
+			if (next == 0x96) { // Ö
+				result.push_back('O');
+				++i;
+				continue;
+			}
+		}
+
+		result.push_back(str[i]);
+	}
+
+	return result;
+}
+
+bool has_diacritics(std::string_view str) noexcept
+{
+	return str.find(static_cast<char>(0xC3)) != std::string_view::npos;
+}
+
 const char* find_line_end(const char* first, const char* last) noexcept
 {
 	for (; first != last; ++first) {
@@ -58,6 +58,23 @@ namespace fs::utility
 compare_strings_ignore_diacritics(
 	std::string_view value, std::string_view requirement, bool exact_match_required);
 
+/**
+ * @brief same as compare_strings_ignore_diacritics but never uses SIMD
+ * @details reference implementation for tests and benchmarks, compare_strings_ignore_diacritics
+ * finds candidate positions in blocks of 16 or 32 bytes (SSE2 / AVX2 if the CPU supports it)
+ */
+[[nodiscard]] bool
+compare_strings_ignore_diacritics_scalar(
+	std::string_view value, std::string_view requirement, bool exact_match_required);
+
+/**
+ * @brief replace diacritics supported by compare_strings_ignore_diacritics with ASCII letters
+ * @details compare_strings_ignore_diacritics(value, requirement, true) implies
+ * remove_diacritics(value) == remove_diacritics(requirement). The reverse is not true.
+ */
+[[nodiscard]] std::string remove_diacritics(std::string_view str);
+[[nodiscard]] bool has_diacritics(std::string_view str) noexcept;
+
 /**
  * @brief find line break in range [@p first, @p last)
  * @return iterator pointing to '\n' or '\r' or last if no line break was found
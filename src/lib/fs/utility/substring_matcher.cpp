@@ -0,0 +1,176 @@
+#include <fs/utility/substring_matcher.hpp>
+#include <fs/utility/string_helpers.hpp>
+#include <fs/utility/assert.hpp>
+
+#include <algorithm>
+
+namespace
+{
+
+[[nodiscard]] bool is_ascii(std::string_view str) noexcept
+{
+	return std::all_of(str.begin(), str.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+}
+
+namespace fs::utility
+{
+
+substring_matcher::substring_matcher(const std::vector<std::string_view>& patterns)
+{
+	// build the trie, edges of each node are kept separately until the trie is complete
+	std::vector<std::vector<edge>> trie_edges(1);
+	m_nodes.emplace_back();
+
+	for (std::size_t i = 0; i < patterns.size(); ++i) {
+		const std::string_view pattern = patterns[i];
+		const auto pattern_index = static_cast<std::uint32_t>(i);
+		FS_ASSERT(pattern_index != none);
+
+		if (!is_ascii(pattern)) {
+			m_other_patterns.emplace_back(pattern, pattern_index);
+			continue;
+		}
+
+		state_type state = 0;
+		for (char c : pattern) {
+			auto& edges = trie_edges[state];
+			const auto it = std::find_if(edges.begin(), edges.end(), [c](edge e) { return e.symbol == c; });
+
+			if (it != edges.end()) {
+				state = it->target;
+			}
+			else {
+				const auto new_state = static_cast<state_type>(m_nodes.size());
+				edges.push_back(edge{c, new_state});
+				m_nodes.emplace_back();
+				trie_edges.emplace_back();
+				state = new_state;
+			}
+		}
+
+		m_nodes[state].output = std::min(m_nodes[state].output, pattern_index);
+	}
+
+	// flatten edges, sorted for binary search
+	for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+		auto& edges = trie_edges[i];
+		std::sort(edges.begin(), edges.end(), [](edge lhs, edge rhs) { return lhs.symbol < rhs.symbol; });
+		m_nodes[i].first_edge = static_cast<std::uint32_t>(m_edges.size());
+		m_nodes[i].num_edges = static_cast<std::uint32_t>(edges.size());
+		m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+	}
+
+	if (!trie_edges[0].empty())
+		m_root_transitions.resize(128, 0);
+
+	for (edge e : trie_edges[0])
+		m_root_transitions[static_cast<unsigned char>(e.symbol)] = e.target;
+
+	// breadth-first traversal guarantees that fail links of shorter suffixes are already computed
+	std::vector<state_type> queue;
+	queue.reserve(m_nodes.size());
+	queue.push_back(0);
+
+	for (std::size_t q = 0; q < queue.size(); ++q) {
+		const state_type state = queue[q];
+		const node& n = m_nodes[state];
+
+		for (std::uint32_t i = n.first_edge; i < n.first_edge + n.num_edges; ++i) {
+			const edge e = m_edges[i];
+			node& child = m_nodes[e.target];
+			child.fail = state == 0 ? 0 : next_state(n.fail, e.symbol);
+			child.output = std::min(child.output, m_nodes[child.fail].output);
+			queue.push_back(e.target);
+		}
+	}
+}
+
+substring_matcher::state_type substring_matcher::find_edge(state_type state, char symbol) const
+{
+	const node& n = m_nodes[state];
+	const auto first = m_edges.begin() + n.first_edge;
+	const auto last = first + n.num_edges;
+	const auto it = std::lower_bound(first, last, symbol, [](edge e, char c) { return e.symbol < c; });
+
+	if (it == last || it->symbol != symbol)
+		return none;
+
+	return it->target;
+}
+
+substring_matcher::state_type substring_matcher::next_state(state_type state, char symbol) const
+{
+	while (state != 0) {
+		if (const state_type target = find_edge(state, symbol); target != none)
+			return target;
+
+		state = m_nodes[state].fail;
+	}
+
+	const auto c = static_cast<unsigned char>(symbol);
+	return c < m_root_transitions.size() ? m_root_transitions[c] : 0;
+}
+
+template <bool StopOnAnyMatch>
+std::size_t substring_matcher::scan(std::string_view value) const
+{
+	std::uint32_t result = none;
+
+	for (const auto& [pattern, index] : m_other_patterns) {
+		if (index < result && compare_strings_ignore_diacritics(value, pattern, false)) {
+			if constexpr (StopOnAnyMatch)
+				return index;
+
+			result = index;
+		}
+	}
+
+	if (m_nodes.empty())
+		return result == none ? npos : result;
+
+	// empty pattern matches everything
+	result = std::min(result, m_nodes[0].output);
+
+	state_type state = 0;
+	for (std::size_t i = 0; i < value.size() && result != 0; ++i) {
+		if constexpr (StopOnAnyMatch) {
+			if (result != none)
+				break;
+		}
+
+		char c = value[i];
+
+		// fold letters with diacritics into ASCII, same as compare_strings_ignore_diacritics
+		if (static_cast<unsigned char>(c) == 0xC3 && i + 1 < value.size()) {
+			const auto next = static_cast<unsigned char>(value[i + 1]);
+
+			if (next == 0xB6) { // ö
+				c = 'o';
+				++i;
+			}
+			else if (next == 0x96) { // Ö
+				c = 'O';
+				++i;
+			}
+		}
+
+		state = next_state(state, c);
+		result = std::min(result, m_nodes[state].output);
+	}
+
+	return result == none ? npos : result;
+}
+
+std::size_t substring_matcher::find_first_pattern(std::string_view value) const
+{
+	return scan<false>(value);
+}
+
+bool substring_matcher::matches_any(std::string_view value) const
+{
+	return scan<true>(value) != npos;
+}
+
+}
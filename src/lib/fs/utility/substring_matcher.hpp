@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace fs::utility
+{
+
+/**
+ * @brief Aho-Corasick automaton for testing multiple substring patterns at once
+ *
+ * @details Equivalent to calling compare_strings_ignore_diacritics(value, pattern, false)
+ * for each pattern, but the value is scanned only once regardless of the number
+ * of patterns. The diacritic equivalence is folded into the scan: letters
+ * supported by compare_strings_ignore_diacritics are read from the value as
+ * their ASCII counterparts.
+ *
+ * Only ASCII patterns are put into the automaton. Other patterns (which contain
+ * diacritics and therefore are stricter than the folded equivalence) are rare
+ * and tested separately, one by one.
+ */
+class substring_matcher
+{
+public:
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	substring_matcher() = default;
+	explicit substring_matcher(const std::vector<std::string_view>& patterns);
+
+	// index (in the construction order) of the first pattern found in the value or npos
+	[[nodiscard]] std::size_t find_first_pattern(std::string_view value) const;
+	// faster than find_first_pattern(value) != npos because it stops on any match
+	[[nodiscard]] bool matches_any(std::string_view value) const;
+
+private:
+	using state_type = std::uint32_t;
+	static constexpr state_type none = static_cast<state_type>(-1);
+
+	struct edge
+	{
+		char symbol;
+		state_type target;
+	};
+
+	struct node
+	{
+		std::uint32_t first_edge = 0;
+		std::uint32_t num_edges = 0;
+		state_type fail = 0;
+		// lowest index of patterns that end in this node or in any of its suffixes
+		std::uint32_t output = none;
+	};
+
+	template <bool StopOnAnyMatch>
+	std::size_t scan(std::string_view value) const;
+
+	state_type find_edge(state_type state, char symbol) const;
+	state_type next_state(state_type state, char symbol) const;
+
+	std::vector<node> m_nodes;
+	std::vector<edge> m_edges;
+	// transitions from the root, indexed by ASCII code (0 = stay in the root),
+	// empty when there are no ASCII patterns; not an std::array to keep the
+	// matcher (and conditions which hold it inline) small
+	std::vector<state_type> m_root_transitions;
+	// non-ASCII patterns with their indexes
+	std::vector<std::pair<std::string, std::uint32_t>> m_other_patterns;
+};
+
+}
@@ -0,0 +1,119 @@
+#include <fs/utility/thread_pool.hpp>
+
+#include <exception>
+#include <utility>
+
+namespace fs::utility {
+
+struct thread_pool::job
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	const std::function<void()>* work; // null once the calling thread has finished
+	std::size_t num_running = 0;
+	std::exception_ptr error;
+};
+
+thread_pool::thread_pool(unsigned num_threads)
+{
+	if (num_threads == 0u)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_workers.reserve(num_threads - 1u);
+	for (unsigned i = 1; i < num_threads; ++i)
+		m_workers.emplace_back([this]() { worker_loop(); });
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		const auto _ = std::lock_guard<std::mutex>(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+void thread_pool::run(std::size_t max_helpers, const std::function<void()>& work)
+{
+	const std::size_t num_helpers = std::min(max_helpers, m_workers.size());
+	if (num_helpers == 0u) {
+		work();
+		return;
+	}
+
+	const auto state = std::make_shared<job>();
+	state->work = &work;
+
+	{
+		const auto _ = std::lock_guard<std::mutex>(m_mutex);
+		for (std::size_t i = 0; i < num_helpers; ++i)
+			m_jobs.push_back(state);
+	}
+	m_cv.notify_all();
+
+	std::exception_ptr error;
+	try {
+		work();
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+
+	auto lock = std::unique_lock<std::mutex>(state->mutex);
+	state->work = nullptr;
+	state->cv.wait(lock, [&]() { return state->num_running == 0u; });
+
+	if (!error)
+		error = state->error;
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void thread_pool::worker_loop()
+{
+	while (true) {
+		std::shared_ptr<job> state;
+		{
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			m_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+			if (m_jobs.empty())
+				return;
+
+			state = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		const std::function<void()>* work = nullptr;
+		{
+			const auto _ = std::lock_guard<std::mutex>(state->mutex);
+			work = state->work;
+			if (work == nullptr)
+				continue;
+
+			++state->num_running;
+		}
+
+		std::exception_ptr error;
+		try {
+			(*work)();
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		{
+			const auto _ = std::lock_guard<std::mutex>(state->mutex);
+			if (error && !state->error)
+				state->error = error;
+
+			--state->num_running;
+		}
+		state->cv.notify_all();
+	}
+}
+
+}
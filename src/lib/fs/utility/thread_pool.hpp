@@ -0,0 +1,87 @@
+#pragma once
+
+#include <fs/utility/parallel_settings.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fs::utility {
+
+/**
+ * @class fixed set of threads for parallel_for, reused by all its calls
+ *
+ * @details The calling thread always participates in the work, so the pool
+ * starts 1 thread less than requested. Pools can be shared by nested calls:
+ * a call waits only for helpers which have already started its work, helpers
+ * which have not started when the work ran out skip it. Nesting therefore
+ * neither multiplies threads nor deadlocks when all threads are busy.
+ */
+class thread_pool
+{
+public:
+	// 0 means std::thread::hardware_concurrency()
+	explicit thread_pool(unsigned num_threads = 0);
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	// including the calling thread
+	[[nodiscard]] std::size_t num_threads() const
+	{
+		return m_workers.size() + 1u;
+	}
+
+	// Calls work() on the calling thread and on at most max_helpers threads
+	// of the pool. Returns when all started calls have finished. The first
+	// exception thrown from any call is propagated.
+	void run(std::size_t max_helpers, const std::function<void()>& work);
+
+private:
+	struct job;
+
+	void worker_loop();
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::deque<std::shared_ptr<job>> m_jobs;
+	bool m_stop = false;
+	std::vector<std::thread> m_workers;
+};
+
+// Calls f(i) for each i in [0, size), potentially from multiple threads.
+// Threads take chunks of indexes until there are none left so uneven work
+// is balanced. Exceptions thrown by f are propagated after all threads have
+// finished.
+template <typename F>
+void parallel_for(std::size_t size, parallel_settings settings, F f)
+{
+	const std::size_t chunk_size = std::max<std::size_t>(settings.chunk_size, 1u);
+	const std::size_t num_chunks = (size + chunk_size - 1u) / chunk_size;
+
+	std::atomic<std::size_t> next_chunk{0};
+	const auto worker = [&]() {
+		for (std::size_t chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+			const std::size_t last = std::min(size, (chunk + 1u) * chunk_size);
+			for (std::size_t i = chunk * chunk_size; i < last; ++i)
+				f(i);
+		}
+	};
+
+	if (settings.pool == nullptr || num_chunks <= 1u) {
+		worker();
+		return;
+	}
+
+	settings.pool->run(num_chunks - 1u, worker);
+}
+
+}
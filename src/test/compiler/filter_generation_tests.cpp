@@ -2,9 +2,11 @@
 #include "common/string_operations.hpp"
 
 #include <fs/compiler/compiler.hpp>
+#include <fs/compiler/template_cache.hpp>
 #include <fs/log/string_logger.hpp>
 #include <fs/lang/market/item_price_data.hpp>
 #include <fs/utility/file.hpp>
+#include <fs/utility/thread_pool.hpp>
 
 #include <boost/test/unit_test.hpp>
 
@@ -12,6 +14,7 @@
 #include <string_view>
 #include <stdexcept>
 #include <filesystem>
+#include <vector>
 
 namespace ut = boost::unit_test;
 
@@ -21,11 +24,12 @@ namespace {
 std::string generate_filter(
 	std::string_view input,
 	compiler::settings st = {},
-	const lang::market::item_price_data& ipd = {})
+	const lang::market::item_price_data& ipd = {},
+	utility::parallel_settings parallel = {})
 {
 	log::string_logger logger;
 	std::optional<std::string> filter = compiler::parse_compile_generate_spirit_filter_without_preamble(
-		input, ipd, st, logger);
+		input, ipd, st, logger, parallel);
 	BOOST_TEST_REQUIRE(filter.has_value(), "test written incorrectly: filter generation failed:\n" << logger.str());
 	return *filter;
 }
@@ -126,6 +130,11 @@ BOOST_AUTO_TEST_CASE(range_condition_min_max)
 	BOOST_TEST(compile_from_files("common/range_condition_min_max"));
 }
 
+BOOST_AUTO_TEST_CASE(range_condition_normalization)
+{
+	BOOST_TEST(compile_from_files("common/range_condition_normalization"));
+}
+
 BOOST_AUTO_TEST_CASE(strings_condition)
 {
 	BOOST_TEST(compile_from_files("poe1/strings_condition"));
@@ -286,6 +295,240 @@ BOOST_AUTO_TEST_CASE(simple_price_queries)
 	ipd.divination_cards.push_back(divination_card{price_data{100, false}, "Abandoned Wealth", 5});
 	ipd.divination_cards.push_back(divination_card{price_data{1000, false}, "The Doctor", 8});
 	BOOST_TEST(compile_from_files("common/simple_price_queries", {}, ipd));
+
+	// prices changed in place (same number of items) are seen by the next generation
+	std::swap(ipd.divination_cards.front().price, ipd.divination_cards.back().price);
+	std::error_code ec;
+	const std::string input = utility::load_file("test_files/common/simple_price_queries.filtertemplate", ec);
+	BOOST_TEST_REQUIRE(!ec);
+	const std::string output = generate_filter(input, {}, ipd);
+	BOOST_TEST(output.find("BaseType == \"Rain of Chaos\" \"Abandoned Wealth\"") != std::string::npos, output);
+	BOOST_TEST(output.find("Hide\n\tClass == \"Divination Card\"\n\tBaseType == \"The Doctor\"") != std::string::npos, output);
+}
+
+BOOST_AUTO_TEST_CASE(gem_price_queries)
+{
+	using lang::market::elementary_item;
+	using lang::market::gem;
+	using lang::market::price_data;
+
+	lang::market::item_price_data ipd;
+	ipd.gems.push_back(gem{elementary_item{price_data{50, false}, "Empower Support"}, 4, 0, true});
+	ipd.gems.push_back(gem{elementary_item{price_data{20, false}, "Enlighten Support"}, 3, 0, false});
+	ipd.gems.push_back(gem{elementary_item{price_data{15, false}, "Arc"}, 21, 20, true});
+	ipd.gems.push_back(gem{elementary_item{price_data{30, false}, "Enhance Support"}, 3, 0, false});
+	ipd.gems.push_back(gem{elementary_item{price_data{1, false}, "Fireball"}, 20, 20, false});
+	ipd.gems.push_back(gem{elementary_item{price_data{2, false}, "Arc"}, 20, 20, false});
+	ipd.gems.push_back(gem{elementary_item{price_data{100, true}, "Vaal Arc"}, 20, 20, true});
+	BOOST_TEST(compile_from_files("common/gem_price_queries", {}, ipd));
+}
+
+BOOST_AUTO_TEST_CASE(multiple_autogen_blocks)
+{
+	using lang::market::divination_card;
+	using lang::market::elementary_item;
+	using lang::market::gem;
+	using lang::market::price_data;
+
+	lang::market::item_price_data ipd;
+	ipd.divination_cards.push_back(divination_card{price_data{0.125, false}, "Rain of Chaos", 8});
+	ipd.divination_cards.push_back(divination_card{price_data{10, false}, "A Dab of Ink", 9});
+	ipd.divination_cards.push_back(divination_card{price_data{5, false}, "Humility", 9});
+	ipd.divination_cards.push_back(divination_card{price_data{100, false}, "Abandoned Wealth", 5});
+	ipd.gems.push_back(gem{elementary_item{price_data{50, false}, "Empower Support"}, 4, 0, true});
+	ipd.gems.push_back(gem{elementary_item{price_data{20, false}, "Enlighten Support"}, 3, 0, false});
+	ipd.gems.push_back(gem{elementary_item{price_data{1, false}, "Fireball"}, 20, 20, false});
+	BOOST_TEST(compile_from_files("common/multiple_autogen_blocks", {}, ipd));
+
+	// autogen blocks generated concurrently must still appear in template order
+	std::error_code ec;
+	const std::string input = utility::load_file("test_files/common/multiple_autogen_blocks.filtertemplate", ec);
+	BOOST_TEST_REQUIRE(!ec);
+
+	const std::string sequential = generate_filter(input, {}, ipd);
+	utility::thread_pool pool(4);
+	for (int i = 0; i < 10; ++i)
+		BOOST_TEST(compare_strings(sequential, generate_filter(input, {}, ipd, utility::parallel_settings{&pool, 1})));
+}
+
+BOOST_AUTO_TEST_CASE(prerendered_filter_template)
+{
+	using lang::market::divination_card;
+	using lang::market::price_data;
+
+	std::error_code ec;
+	const std::string input = utility::load_file("test_files/common/multiple_autogen_blocks.filtertemplate", ec);
+	BOOST_TEST_REQUIRE(!ec);
+
+	log::string_logger logger;
+	const std::optional<lang::spirit_item_filter> filter_template =
+		compiler::parse_and_compile_spirit_filter(input, {}, logger);
+	BOOST_TEST_REQUIRE(filter_template.has_value(), logger.str());
+
+	lang::style_overrides overrides;
+	overrides.font.show_size_min = 26;
+	const compiler::prerendered_filter_template prerendered(*filter_template, overrides);
+
+	utility::thread_pool pool(4);
+	lang::market::item_price_data ipd;
+	for (double price : {1.0, 10.0, 5.0, 100.0}) {
+		ipd.divination_cards.push_back(divination_card{price_data{price, false}, "Card " + std::to_string(price), 1});
+
+		const std::string expected = compiler::item_filter_to_string_without_preamble(
+			compiler::make_item_filter(*filter_template, ipd), overrides);
+		const std::string actual = prerendered.to_string_without_preamble(
+			compiler::materialize_item_filter(*filter_template, ipd, utility::parallel_settings{&pool, 1}));
+		BOOST_TEST(compare_strings(expected, actual));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(shared_price_indexes)
+{
+	using lang::market::divination_card;
+	using lang::market::elementary_item;
+	using lang::market::gem;
+	using lang::market::price_data;
+
+	std::error_code ec;
+	const std::string input = utility::load_file("test_files/common/multiple_autogen_blocks.filtertemplate", ec);
+	BOOST_TEST_REQUIRE(!ec);
+
+	log::string_logger logger;
+	const std::optional<lang::spirit_item_filter> filter_template =
+		compiler::parse_and_compile_spirit_filter(input, {}, logger);
+	BOOST_TEST_REQUIRE(filter_template.has_value(), logger.str());
+
+	lang::market::item_price_data ipd;
+	ipd.currency.push_back(elementary_item{price_data{150, false}, "Divine Orb"});
+	ipd.divination_cards.push_back(divination_card{price_data{10, false}, "A Dab of Ink", 9});
+	ipd.divination_cards.push_back(divination_card{price_data{5, false}, "Humility", 9});
+	ipd.gems.push_back(gem{elementary_item{price_data{50, false}, "Empower Support"}, 4, 0, true});
+
+	// only categories of autogen blocks in the template are indexed
+	const lang::market::item_price_indexes template_indexes = compiler::make_item_price_indexes(*filter_template, ipd);
+	BOOST_TEST(template_indexes.divination_cards.prices.size() == 2u);
+	BOOST_TEST(template_indexes.gems.prices.size() == 1u);
+	BOOST_TEST(template_indexes.currency.prices.empty());
+
+	// indexes of the whole report built by its owner give the same filter
+	const lang::market::item_price_indexes report_indexes(ipd);
+	BOOST_TEST(report_indexes.currency.prices.size() == 1u);
+	BOOST_TEST(compare_strings(
+		compiler::item_filter_to_string_without_preamble(compiler::make_item_filter(*filter_template, ipd), {}),
+		compiler::item_filter_to_string_without_preamble(compiler::make_item_filter(*filter_template, ipd, report_indexes), {})));
+}
+
+BOOST_AUTO_TEST_CASE(refresh_item_filter)
+{
+	using lang::market::divination_card;
+	using lang::market::price_data;
+
+	std::error_code ec;
+	const std::string input = utility::load_file("test_files/common/multiple_autogen_blocks.filtertemplate", ec);
+	BOOST_TEST_REQUIRE(!ec);
+
+	log::string_logger logger;
+	const std::optional<lang::spirit_item_filter> filter_template =
+		compiler::parse_and_compile_spirit_filter(input, {}, logger);
+	BOOST_TEST_REQUIRE(filter_template.has_value(), logger.str());
+
+	lang::market::item_price_data ipd;
+	compiler::item_filter_layout layout;
+	lang::item_filter filter = compiler::make_item_filter(
+		compiler::materialize_item_filter(*filter_template, ipd), layout);
+	BOOST_TEST(compare_strings(
+		compiler::item_filter_to_string_without_preamble(compiler::make_item_filter(*filter_template, ipd), {}),
+		compiler::item_filter_to_string_without_preamble(filter, {})));
+
+	// prices both appear and disappear so that autogen parts grow and shrink
+	for (double price : {1.0, 10.0, 5.0, 100.0, 0.5}) {
+		if (price < 1.0)
+			ipd.divination_cards.clear();
+		else
+			ipd.divination_cards.push_back(divination_card{price_data{price, false}, "Card " + std::to_string(price), 1});
+
+		compiler::refresh_item_filter(filter, layout, compiler::materialize_item_filter(*filter_template, ipd));
+		const std::string expected = compiler::item_filter_to_string_without_preamble(
+			compiler::make_item_filter(*filter_template, ipd), {});
+		const std::string actual = compiler::item_filter_to_string_without_preamble(filter, {});
+		BOOST_TEST(compare_strings(expected, actual));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(template_cache_roundtrip)
+{
+	using lang::market::divination_card;
+	using lang::market::elementary_item;
+	using lang::market::gem;
+	using lang::market::price_data;
+
+	lang::market::item_price_data ipd;
+	ipd.divination_cards.push_back(divination_card{price_data{0.125, false}, "Rain of Chaos", 8});
+	ipd.divination_cards.push_back(divination_card{price_data{10, false}, "A Dab of Ink", 9});
+	ipd.divination_cards.push_back(divination_card{price_data{100, false}, "Abandoned Wealth", 5});
+	ipd.gems.push_back(gem{elementary_item{price_data{50, false}, "Empower Support"}, 4, 0, true});
+	ipd.gems.push_back(gem{elementary_item{price_data{15, false}, "Arc"}, 21, 20, true});
+	ipd.gems.push_back(gem{elementary_item{price_data{1, false}, "Fireball"}, 20, 20, false});
+
+	std::vector<std::filesystem::path> paths;
+	for (const char* dir : {"test_files/common", "test_files/poe1"})
+		for (const auto& entry : std::filesystem::directory_iterator(dir))
+			if (entry.path().extension() == lang::constants::file_extension_filter_template)
+				paths.push_back(entry.path());
+
+	BOOST_TEST_REQUIRE(!paths.empty());
+	for (const std::filesystem::path& path : paths) {
+		BOOST_TEST_CONTEXT("template: " << path.generic_string()) {
+			compiler::settings st;
+			st.ruthless_mode = path.stem().generic_string().find("ruthless") != std::string::npos;
+
+			std::error_code ec;
+			const std::string input = utility::load_file(path, ec);
+			BOOST_TEST_REQUIRE(!ec);
+
+			log::string_logger logger;
+			const std::optional<compiler::spirit_filter_compilation> compilation =
+				compiler::parse_and_compile_spirit_filter_with_metadata(input, st, logger);
+			BOOST_TEST_REQUIRE(compilation.has_value(), logger.str());
+
+			const std::uint64_t key = compiler::make_template_cache_key(input, st);
+			const std::optional<std::string> cache_data = compiler::serialize_spirit_filter(*compilation, key);
+			BOOST_TEST_REQUIRE(cache_data.has_value());
+
+			BOOST_TEST(!compiler::deserialize_spirit_filter(*cache_data, input, key + 1, st, logger).has_value());
+			BOOST_TEST(!compiler::deserialize_spirit_filter(
+				std::string_view(*cache_data).substr(0, (*cache_data).size() - 1), input, key, st, logger).has_value());
+
+			const std::optional<compiler::spirit_filter_compilation> cached =
+				compiler::deserialize_spirit_filter(*cache_data, input, key, st, logger);
+			BOOST_TEST_REQUIRE(cached.has_value(), logger.str());
+
+			const std::string expected = compiler::generate_item_filter_without_preamble((*compilation).filter, ipd, st, logger);
+			const std::string actual = compiler::generate_item_filter_without_preamble((*cached).filter, ipd, st, logger);
+			BOOST_TEST(compare_strings(expected, actual));
+
+			// warnings of the original compilation are kept, pointing at the same text
+			log::string_logger expected_diagnostics;
+			(*compilation).diagnostics.output_messages((*compilation).metadata, expected_diagnostics);
+			log::string_logger actual_diagnostics;
+			(*cached).diagnostics.output_messages((*cached).metadata, actual_diagnostics);
+			BOOST_TEST(compare_strings(expected_diagnostics.str(), actual_diagnostics.str()));
+
+			BOOST_TEST_REQUIRE((*compilation).filter.blocks.size() == (*cached).filter.blocks.size());
+			for (std::size_t i = 0; i < (*cached).filter.blocks.size(); ++i) {
+				const auto* const expected_block = std::get_if<lang::spirit_item_filter_block>(&(*compilation).filter.blocks[i]);
+				const auto* const actual_block = std::get_if<lang::spirit_item_filter_block>(&(*cached).filter.blocks[i]);
+				BOOST_TEST_REQUIRE((expected_block == nullptr) == (actual_block == nullptr));
+				if (expected_block == nullptr)
+					continue;
+
+				BOOST_TEST(
+					(*compilation).metadata.lookup.text_of((*expected_block).block.visibility.origin) ==
+					(*cached).metadata.lookup.text_of((*actual_block).block.visibility.origin));
+				BOOST_TEST((*expected_block).autogen.has_value() == (*actual_block).autogen.has_value());
+			}
+		}
+	}
 }
 
 BOOST_AUTO_TEST_CASE(override_settings_font_min)
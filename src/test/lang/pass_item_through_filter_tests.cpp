@@ -1,12 +1,23 @@
 #include <fs/lang/item_filter.hpp>
+#include <fs/lang/compiled_filter.hpp>
+#include <fs/lang/condition_order.hpp>
+#include <fs/lang/item_filter_index.hpp>
+#include <fs/lang/item_filter_memo.hpp>
+#include <fs/lang/item_batch.hpp>
+#include <fs/lang/unreachable_blocks.hpp>
+#include <fs/lang/merge_blocks.hpp>
+#include <fs/lang/string_table.hpp>
 #include <fs/parser/parser.hpp>
 #include <fs/compiler/compiler.hpp>
 #include <fs/log/string_logger.hpp>
+#include <fs/utility/thread_pool.hpp>
 
 #include <boost/test/unit_test.hpp>
 
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace fs::test {
 
@@ -42,6 +53,22 @@ test_condition(std::string condition, const lang::item& itm)
 	const std::string filter_source = "Show\n\t" + condition + "\n\tPlayEffect Yellow";
 	const lang::item_filter filter = parse_real_filter(filter_source);
 	const lang::item_filtering_result result = lang::pass_item_through_filter(itm, filter, 1);
+
+	// faster variants must always agree with the full one
+	const lang::item_style style_only = lang::pass_item_through_filter_style_only(itm, filter, 1);
+	BOOST_TEST(style_only.effect.has_value() == result.style.effect.has_value());
+	BOOST_TEST(style_only.visibility.show == result.style.visibility.show);
+
+	const lang::item_filter_index index(filter);
+	const lang::item_style indexed = lang::pass_item_through_filter_style_only(itm, filter, index, 1);
+	BOOST_TEST(indexed.effect.has_value() == result.style.effect.has_value());
+	BOOST_TEST(indexed.visibility.show == result.style.visibility.show);
+
+	const lang::compiled_filter compiled = lang::compile_item_filter(filter);
+	const lang::item_style compiled_style = lang::pass_item_through_compiled_filter(itm, compiled, 1);
+	BOOST_TEST(compiled_style.effect.has_value() == result.style.effect.has_value());
+	BOOST_TEST(compiled_style.visibility.show == result.style.visibility.show);
+
 	return result.style.effect.has_value();
 }
 
@@ -104,6 +131,690 @@ BOOST_AUTO_TEST_SUITE(generic_suite)
 		BOOST_TEST(!test_item_level_condition(">= 3", 2));
 	}
 
+	BOOST_AUTO_TEST_CASE(exact_string_condition)
+	{
+		const auto make_item = [](std::string base_type) {
+			lang::item itm;
+			itm.base_type = std::move(base_type);
+			return itm;
+		};
+
+		BOOST_TEST( test_condition("BaseType == \"Maelstrom Staff\"", make_item("Maelstrom Staff")));
+		BOOST_TEST( test_condition("BaseType == \"Maelstrom Staff\"", make_item("Maelström Staff")));
+		BOOST_TEST( test_condition("BaseType == \"Maelström Staff\"", make_item("Maelström Staff")));
+		BOOST_TEST(!test_condition("BaseType == \"Maelström Staff\"", make_item("Maelstrom Staff")));
+		BOOST_TEST(!test_condition("BaseType == \"Maelstrom\"", make_item("Maelstrom Staff")));
+		BOOST_TEST( test_condition("BaseType == \"Chaos Orb\" \"Maelstrom Staff\"", make_item("Maelstrom Staff")));
+		BOOST_TEST(!test_condition("BaseType == \"Chaos Orb\" \"Exalted Orb\"", make_item("Maelstrom Staff")));
+	}
+
+	BOOST_AUTO_TEST_CASE(flag_conditions)
+	{
+		const std::string conditions = "Identified True\n\tCorrupted False\n\tItemLevel > 10\n\tHasInfluence == Shaper Elder\n\tMirrored False";
+		const std::string contradiction = "Identified True\n\tHasInfluence None\n\tIdentified False";
+
+		const lang::compiled_filter compiled = lang::compile_item_filter(parse_real_filter(
+			"Show\n\t" + conditions + "\n\nShow\n\t" + contradiction + "\n\nShow\n\tHasInfluence Crusader\n\tHasInfluence None"));
+		BOOST_TEST_REQUIRE(compiled.blocks.size() == 3u);
+		// booleans and HasInfluence folded into 1 test placed where the first of them was
+		BOOST_TEST_REQUIRE(compiled.blocks[0].num_conditions == 2u);
+		BOOST_TEST((compiled.conditions[0].test == lang::compiled_test::flags));
+		BOOST_TEST((compiled.conditions[1].test == lang::compiled_test::integer_range));
+		BOOST_TEST_REQUIRE(compiled.blocks[1].num_conditions == 1u);
+		BOOST_TEST((compiled.conditions[2].test == lang::compiled_test::never));
+		// single influence without == is the same as with ==, None excludes it
+		BOOST_TEST_REQUIRE(compiled.blocks[2].num_conditions == 1u);
+		BOOST_TEST((compiled.conditions[3].test == lang::compiled_test::never));
+
+		lang::item itm;
+		itm.item_level = 20;
+		itm.is_identified = true;
+		itm.influence.shaper = true;
+		itm.influence.elder = true;
+		BOOST_TEST(test_condition(conditions, itm));
+		BOOST_TEST(!test_condition(contradiction, itm));
+
+		itm.influence.elder = false;
+		BOOST_TEST(!test_condition(conditions, itm));
+
+		itm.influence.elder = true;
+		itm.corruption_status = lang::corruption_status_t::corrupted;
+		BOOST_TEST(!test_condition(conditions, itm));
+
+		itm.corruption_status = lang::corruption_status_t::normal;
+		itm.is_mirrored = true;
+		BOOST_TEST(!test_condition(conditions, itm));
+
+		itm.is_mirrored = false;
+		itm.is_identified = false;
+		BOOST_TEST(!test_condition(conditions, itm));
+		BOOST_TEST(!test_condition(contradiction, itm));
+	}
+
+	BOOST_AUTO_TEST_CASE(string_table)
+	{
+		lang::string_table table;
+		const lang::string_id id1 = table.intern("Maelstrom Staff");
+		const lang::string_id id2 = table.intern("Chaos Orb");
+		BOOST_TEST(id1 != id2);
+		BOOST_TEST(table.intern("Maelström Staff") == id1);
+		BOOST_TEST(table.find("Maelström Staff") == id1);
+		BOOST_TEST(table.find("Chaos Orb") == id2);
+		BOOST_TEST(table.find("Exalted Orb") == lang::string_table::npos);
+
+		const lang::string_table copy = table;
+		BOOST_TEST(copy.find("Maelstrom Staff") == id1);
+		BOOST_TEST(copy.str(id2) == "Chaos Orb");
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(item_filter_index_suite)
+
+	constexpr auto indexed_filter_source = R"(
+Show
+	BaseType == "Exalted Orb" "Chaos Orb"
+	SetFontSize 45
+
+Show
+	Class == "Currency"
+	BaseType "Orb"
+	SetTextColor 1 1 1
+	Continue
+
+Show
+	Class == "Stackable Currency"
+	BaseType == "Maelstrom"
+	SetFontSize 40
+
+Hide
+	Class "Currency"
+	SetBackgroundColor 2 2 2
+
+Show
+	BaseType == "Maelström Staff"
+	SetFontSize 30
+
+Show
+	ItemLevel > 80
+	SetFontSize 20
+)";
+
+	void check_indexed_style(const lang::item_filter& filter, const lang::item_filter_index& index, const lang::item& itm)
+	{
+		const lang::item_style expected = lang::pass_item_through_filter(itm, filter, 1).style;
+		const lang::item_style actual = lang::pass_item_through_filter_style_only(itm, filter, index, 1);
+		BOOST_TEST(actual.visibility.show == expected.visibility.show);
+		BOOST_TEST(actual.font_size.size.value == expected.font_size.size.value);
+		BOOST_TEST(actual.text_color.c.r.value == expected.text_color.c.r.value);
+		BOOST_TEST(actual.background_color.c.r.value == expected.background_color.c.r.value);
+	}
+
+	BOOST_AUTO_TEST_CASE(candidate_blocks)
+	{
+		const lang::item_filter filter = parse_real_filter(indexed_filter_source);
+		const lang::item_filter_index index(filter);
+
+		// blocks without exact Class or BaseType: "Currency" (not exact) and ItemLevel
+		BOOST_TEST(index.num_wildcard_blocks() == 2u);
+		BOOST_TEST(index.num_candidate_blocks("Stackable Currency", "Exalted Orb") == 3u);
+		BOOST_TEST(index.num_candidate_blocks("Currency", "Chaos Orb") == 4u);
+		BOOST_TEST(index.num_candidate_blocks("Staves", "Maelstrom Staff") == 3u);
+		BOOST_TEST(index.num_candidate_blocks("Staves", "Maelström Staff") == 3u);
+		BOOST_TEST(index.num_candidate_blocks("Boots", "Iron Greaves") == 2u);
+	}
+
+	BOOST_AUTO_TEST_CASE(same_results)
+	{
+		const lang::item_filter filter = parse_real_filter(indexed_filter_source);
+		const lang::item_filter_index index(filter);
+
+		const auto make_item = [](std::string class_, std::string base_type, int item_level) {
+			lang::item itm;
+			itm.class_ = std::move(class_);
+			itm.base_type = std::move(base_type);
+			itm.item_level = item_level;
+			return itm;
+		};
+
+		check_indexed_style(filter, index, make_item("Stackable Currency", "Exalted Orb", 1));
+		check_indexed_style(filter, index, make_item("Stackable Currency", "Orb of Alchemy", 1));
+		check_indexed_style(filter, index, make_item("Currency", "Orb of Alchemy", 1));
+		check_indexed_style(filter, index, make_item("Currency", "Orb of Alchemy", 85));
+		check_indexed_style(filter, index, make_item("Stackable Currency", "Maelstrom", 1));
+		check_indexed_style(filter, index, make_item("Staves", "Maelstrom Staff", 1));
+		check_indexed_style(filter, index, make_item("Staves", "Maelström Staff", 1));
+		check_indexed_style(filter, index, make_item("Boots", "Iron Greaves", 85));
+		check_indexed_style(filter, index, make_item("Boots", "Iron Greaves", 1));
+	}
+
+	BOOST_AUTO_TEST_CASE(batch_filtering)
+	{
+		const lang::item_filter filter = parse_real_filter(indexed_filter_source);
+
+		std::vector<lang::item> items;
+		for (int item_level = 1; item_level <= 100; ++item_level) {
+			for (const char* base_type : {"Exalted Orb", "Orb of Alchemy", "Maelstrom", "Iron Greaves"}) {
+				lang::item itm;
+				itm.class_ = item_level % 2 == 0 ? "Stackable Currency" : "Currency";
+				itm.base_type = base_type;
+				itm.item_level = item_level;
+				items.push_back(std::move(itm));
+			}
+		}
+
+		std::vector<lang::item_filtering_result> results(items.size());
+		std::vector<lang::item_style> styles(items.size());
+		// small chunks to make threads interleave
+		utility::thread_pool pool(4);
+		const utility::parallel_settings settings{&pool, 3};
+		lang::pass_items_through_filter(items.data(), items.data() + items.size(), results.data(), filter, 1, settings);
+		lang::pass_items_through_filter_style_only(items.data(), items.data() + items.size(), styles.data(), filter, 1, settings);
+
+		for (std::size_t i = 0; i < items.size(); ++i) {
+			const lang::item_style expected = lang::pass_item_through_filter(items[i], filter, 1).style;
+			BOOST_TEST(results[i].style.visibility.show == expected.visibility.show);
+			BOOST_TEST(results[i].style.font_size.size.value == expected.font_size.size.value);
+			BOOST_TEST(styles[i].visibility.show == expected.visibility.show);
+			BOOST_TEST(styles[i].font_size.size.value == expected.font_size.size.value);
+		}
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(item_filter_memo_suite)
+
+	BOOST_AUTO_TEST_CASE(cached_styles)
+	{
+		const auto filter = std::make_shared<const lang::item_filter>(parse_real_filter(R"(
+Show
+	Class == "Currency"
+	StackSize >= 10
+	SetFontSize 45
+
+Show
+	Class == "Currency"
+	SetFontSize 40
+)"));
+
+		lang::item currency;
+		currency.class_ = "Currency";
+		currency.base_type = "Chaos Orb";
+		currency.stack_size = 5;
+
+		lang::item big_stack = currency;
+		big_stack.stack_size = 20;
+
+		// properties not supported by filters do not split items
+		lang::item described = currency;
+		described.description = "dropped in the Lab";
+
+		lang::item_filter_memo memo(filter);
+		BOOST_TEST(memo.pass_item(currency, 1).font_size.size.value == 40);
+		BOOST_TEST(memo.pass_item(big_stack, 1).font_size.size.value == 45);
+		BOOST_TEST(memo.pass_item(currency, 1).font_size.size.value == 40);
+		BOOST_TEST(memo.pass_item(described, 1).font_size.size.value == 40);
+		BOOST_TEST(memo.pass_item(big_stack, 1).font_size.size.value == 45);
+		// area level is a part of the key
+		BOOST_TEST(memo.pass_item(currency, 2).font_size.size.value == 40);
+
+		BOOST_TEST(memo.size() == 3u);
+		BOOST_TEST(memo.statistics().hits == 3u);
+		BOOST_TEST(memo.statistics().misses == 3u);
+		BOOST_TEST(memo.statistics().hit_rate() == 0.5);
+
+		// rebinding to the same filter keeps cached styles
+		memo.reset(filter);
+		BOOST_TEST(memo.size() == 3u);
+		BOOST_TEST(memo.statistics().invalidations == 0u);
+
+		// different filter drops cached styles, even if it is an equal copy
+		memo.reset(std::make_shared<const lang::item_filter>(*filter));
+		BOOST_TEST(memo.size() == 0u);
+		BOOST_TEST(memo.statistics().invalidations == 1u);
+
+		memo.reset(std::make_shared<const lang::item_filter>(parse_real_filter(R"(
+Show
+	Class == "Currency"
+	SetFontSize 35
+)")));
+		BOOST_TEST(memo.pass_item(big_stack, 1).font_size.size.value == 35);
+		BOOST_TEST(memo.size() == 1u);
+		BOOST_TEST(memo.statistics().misses == 4u);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(item_batch_suite)
+
+	constexpr auto batch_filter_source = R"(
+Show
+	AreaLevel > 80
+	Rarity Unique
+	SetFontSize 45
+
+Show
+	HasInfluence Shaper Elder
+	Identified False
+	SetFontSize 44
+	Continue
+
+Show
+	Class == "Boots"
+	ItemLevel 70 75 80
+	SetFontSize 43
+
+Show
+	BaseType "Ring"
+	Corrupted True
+	SetFontSize 42
+
+Show
+	Sockets >= 2
+	Quality > 10
+	SetTextColor 1 1 1
+	Continue
+
+Show
+	StackSize >= 10
+	Identified True
+	SetFontSize 41
+
+Hide
+	ItemLevel < 20
+	SetFontSize 40
+)";
+
+	std::vector<lang::item> make_batch_items()
+	{
+		std::vector<lang::item> items;
+		// not a multiple of word size, to test the last partial word
+		for (int i = 0; i < 203; ++i) {
+			lang::item itm;
+			itm.class_ = i % 3 == 0 ? "Boots" : "Rings";
+			itm.base_type = i % 3 == 0 ? "Iron Greaves" : "Gold Ring";
+			itm.item_level = i % 100;
+			itm.quality = i % 23;
+			itm.stack_size = i % 17 + 1;
+			itm.rarity_ = i % 7 == 0 ? lang::rarity_type::unique : lang::rarity_type::rare;
+			itm.is_identified = i % 2 == 0;
+			itm.corruption_status = i % 5 == 0 ? lang::corruption_status_t::corrupted : lang::corruption_status_t::normal;
+			itm.influence.shaper = i % 11 == 0;
+			itm.influence.elder = i % 13 == 0;
+			if (i % 4 == 0)
+				itm.sockets.groups.push_back(lang::linked_sockets{lang::socket_color::r, lang::socket_color::g});
+			items.push_back(std::move(itm));
+		}
+
+		return items;
+	}
+
+	BOOST_AUTO_TEST_CASE(same_results)
+	{
+		const lang::item_filter filter = parse_real_filter(batch_filter_source);
+		const lang::compiled_filter compiled = lang::compile_item_filter(filter);
+		const std::vector<lang::item> items = make_batch_items();
+		const lang::item_batch batch(items.data(), items.data() + items.size(), compiled);
+
+		BOOST_TEST_REQUIRE(batch.size() == items.size());
+		BOOST_TEST(batch.integer_column(lang::official_condition_property::item_level) != nullptr);
+		BOOST_TEST(batch.flags_column().size() == items.size());
+		BOOST_TEST(batch.integer_column(lang::official_condition_property::gem_level) == nullptr);
+
+		for (int area_level : {1, 83}) {
+			std::vector<lang::item_style> styles(items.size());
+			lang::pass_item_batch_through_compiled_filter(batch, compiled, area_level, styles.data());
+
+			for (std::size_t i = 0; i < items.size(); ++i) {
+				const lang::item_style expected = lang::pass_item_through_filter(items[i], filter, area_level).style;
+				BOOST_TEST(styles[i].visibility.show == expected.visibility.show);
+				BOOST_TEST(styles[i].font_size.size.value == expected.font_size.size.value);
+				BOOST_TEST(styles[i].text_color.c.r.value == expected.text_color.c.r.value);
+			}
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(block_masks)
+	{
+		const lang::item_filter filter = parse_real_filter(batch_filter_source);
+		const lang::compiled_filter compiled = lang::compile_item_filter(filter);
+		const std::vector<lang::item> items = make_batch_items();
+		const lang::item_batch batch(items.data(), items.data() + items.size(), compiled);
+
+		for (std::size_t b = 0; b < compiled.blocks.size(); ++b) {
+			const lang::item_batch::mask_type mask = lang::match_compiled_block(batch, compiled, b, 1);
+			BOOST_TEST_REQUIRE(mask.size() == batch.num_words());
+
+			const lang::compiled_block& block = compiled.blocks[b];
+			for (std::size_t i = 0; i < items.size(); ++i) {
+				const lang::prepared_item prepared = lang::prepare_item(items[i], compiled);
+				bool expected = true;
+				for (std::uint32_t c = 0; c < block.num_conditions; ++c)
+					expected = expected && lang::test_compiled_condition(items[i], prepared, compiled.conditions[block.first_condition + c], compiled, 1);
+
+				const bool actual = (mask[i / lang::item_batch::word_bits] >> (i % lang::item_batch::word_bits)) & 1u;
+				BOOST_TEST(actual == expected, "block " << b << ", item " << i);
+			}
+
+			// no bits past the last item
+			BOOST_TEST((mask.back() >> (items.size() % lang::item_batch::word_bits)) == 0u);
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(empty_batch)
+	{
+		const lang::compiled_filter compiled = lang::compile_item_filter(parse_real_filter(batch_filter_source));
+		const lang::item_batch batch(nullptr, nullptr, compiled);
+		BOOST_TEST(batch.size() == 0u);
+		BOOST_TEST(batch.num_words() == 0u);
+		lang::pass_item_batch_through_compiled_filter(batch, compiled, 1, nullptr);
+		BOOST_TEST(lang::match_compiled_block(batch, compiled, 0, 83).empty());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(condition_order_suite)
+
+	constexpr auto unordered_filter_source = R"(
+Show
+	SocketGroup >= 5
+	BaseType "Ring" "Amulet"
+	Rarity Unique
+	Corrupted True
+	SetFontSize 45
+
+Show
+	Class "Boots"
+	ItemLevel > 80
+	SetFontSize 40
+
+Show
+	Rarity Rare
+	SetFontSize 35
+)";
+
+	const lang::item_filter_block& nth_block(const lang::item_filter& filter, std::size_t n)
+	{
+		return std::get<lang::item_filter_block>(filter.blocks[n]);
+	}
+
+	std::vector<lang::item> make_sample_items()
+	{
+		std::vector<lang::item> items;
+		for (int item_level = 60; item_level <= 86; ++item_level) {
+			for (const char* base_type : {"Gold Ring", "Onyx Amulet", "Iron Greaves"}) {
+				lang::item itm;
+				itm.class_ = base_type == std::string_view("Iron Greaves") ? "Boots" : "Rings";
+				itm.base_type = base_type;
+				itm.item_level = item_level;
+				itm.rarity_ = item_level % 3 == 0 ? lang::rarity_type::unique : lang::rarity_type::rare;
+				items.push_back(std::move(itm));
+			}
+		}
+
+		return items;
+	}
+
+	void check_same_results(const lang::item_filter& original, const lang::item_filter& optimized)
+	{
+		BOOST_TEST(compiler::item_filter_to_string_without_preamble(original, {})
+			== compiler::item_filter_to_string_without_preamble(optimized, {}));
+
+		const lang::compiled_filter compiled = lang::compile_item_filter(optimized);
+		for (const lang::item& itm : make_sample_items()) {
+			const lang::item_filtering_result expected = lang::pass_item_through_filter(itm, original, 1);
+			const lang::item_filtering_result actual = lang::pass_item_through_filter(itm, optimized, 1);
+			BOOST_TEST(actual.style.font_size.size.value == expected.style.font_size.size.value);
+			BOOST_TEST(lang::pass_item_through_filter_style_only(itm, optimized, 1).font_size.size.value
+				== expected.style.font_size.size.value);
+			BOOST_TEST(lang::pass_item_through_compiled_filter(itm, compiled, 1).font_size.size.value
+				== expected.style.font_size.size.value);
+
+			// debug output reports conditions in source order
+			BOOST_TEST_REQUIRE(actual.match_history.size() == expected.match_history.size());
+			for (std::size_t i = 0; i < actual.match_history.size(); ++i) {
+				const auto& actual_results = actual.match_history[i].match_results;
+				const auto& expected_results = expected.match_history[i].match_results;
+				BOOST_TEST_REQUIRE(actual_results.size() == expected_results.size());
+				for (std::size_t j = 0; j < actual_results.size(); ++j) {
+					BOOST_TEST(actual_results[j].is_successful() == expected_results[j].is_successful());
+					BOOST_TEST(lang::compare(actual_results[j].condition_origin(), expected_results[j].condition_origin()) == 0);
+				}
+			}
+		}
+	}
+
+	BOOST_AUTO_TEST_CASE(static_cost_order)
+	{
+		const lang::item_filter original = parse_real_filter(unordered_filter_source);
+		lang::item_filter optimized = original;
+		lang::optimize_condition_order(optimized);
+
+		// Rarity, Corrupted, BaseType, SocketGroup
+		const std::vector<std::uint32_t> expected_order = {2, 3, 1, 0};
+		BOOST_TEST(nth_block(optimized, 0).conditions.evaluation_order == expected_order, boost::test_tools::per_element());
+		BOOST_TEST(nth_block(optimized, 1).conditions.evaluation_order.size() == 2u);
+		// already in the best order or nothing to reorder
+		BOOST_TEST(nth_block(optimized, 2).conditions.evaluation_order.empty());
+
+		check_same_results(original, optimized);
+
+		// compiled filters apply the static order by themselves
+		const lang::compiled_filter compiled_original = lang::compile_item_filter(original);
+		const lang::compiled_filter compiled_optimized = lang::compile_item_filter(optimized);
+		BOOST_TEST_REQUIRE(compiled_original.conditions.size() == compiled_optimized.conditions.size());
+		for (std::size_t i = 0; i < compiled_original.conditions.size(); ++i)
+			BOOST_TEST((compiled_original.conditions[i].property == compiled_optimized.conditions[i].property));
+	}
+
+	BOOST_AUTO_TEST_CASE(profiled_order)
+	{
+		const lang::item_filter original = parse_real_filter(unordered_filter_source);
+		lang::item_filter optimized = original;
+		lang::optimize_condition_order(optimized, make_sample_items(), 1);
+
+		// no sample item has sockets while most of them pass BaseType
+		// so (unlike static order) SocketGroup is tested before BaseType
+		const std::vector<std::uint32_t> expected_order = {2, 3, 0, 1};
+		BOOST_TEST(nth_block(optimized, 0).conditions.evaluation_order == expected_order, boost::test_tools::per_element());
+
+		check_same_results(original, optimized);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(unreachable_blocks_suite)
+
+	constexpr auto shadowed_filter_source = R"(
+Show
+	Class "Currency"
+	StackSize >= 5
+	SetFontSize 45
+
+Show
+	Class == "Stackable Currency"
+	BaseType == "Chaos Orb"
+	StackSize >= 10
+	SetFontSize 40
+
+Show
+	Class == "Stackable Currency"
+	StackSize >= 2
+	SetFontSize 38
+
+Show
+	Rarity <= Rare
+	HasInfluence Shaper Elder
+	Continue
+
+Show
+	Rarity Normal Magic
+	HasInfluence == Shaper
+	SetFontSize 35
+
+Show
+	Rarity <= Rare
+	HasInfluence Shaper Elder
+
+Show
+	Rarity Normal Magic
+	HasInfluence == Elder
+	Identified True
+	SetFontSize 30
+
+Show
+	Rarity Unique
+	HasInfluence == Elder
+	SetFontSize 25
+
+Show
+	ItemLevel > 80
+	ItemLevel < 60
+	SetFontSize 20
+)";
+
+	BOOST_AUTO_TEST_CASE(find_unreachable_blocks)
+	{
+		const lang::item_filter filter = parse_real_filter(shadowed_filter_source);
+		const std::vector<lang::unreachable_block> unreachable = lang::find_unreachable_blocks(filter);
+
+		BOOST_TEST_REQUIRE(unreachable.size() == 3u);
+		// exact Class is a subset of non-exact Class, StackSize range is narrower
+		BOOST_TEST(unreachable[0].block_index == 1u);
+		BOOST_TEST((unreachable[0].shadowed_by == std::optional<std::size_t>(0)));
+		// the block with Continue does not shadow anything, the one after it does
+		BOOST_TEST(unreachable[1].block_index == 6u);
+		BOOST_TEST((unreachable[1].shadowed_by == std::optional<std::size_t>(5)));
+		// contradictory conditions
+		BOOST_TEST(unreachable[2].block_index == 8u);
+		BOOST_TEST(!unreachable[2].shadowed_by.has_value());
+	}
+
+	BOOST_AUTO_TEST_CASE(remove_unreachable_blocks)
+	{
+		const lang::item_filter original = parse_real_filter(shadowed_filter_source);
+		lang::item_filter optimized = original;
+		BOOST_TEST(lang::remove_unreachable_blocks(optimized).size() == 3u);
+		BOOST_TEST(optimized.blocks.size() == original.blocks.size() - 3u);
+		BOOST_TEST(lang::find_unreachable_blocks(optimized).empty());
+
+		const lang::compiled_filter compiled = lang::compile_item_filter(optimized);
+		for (const char* base_type : {"Chaos Orb", "Orb of Alchemy", "Gold Ring"}) {
+			for (int stack_size = 1; stack_size <= 12; ++stack_size) {
+				for (int r = 0; r < 4; ++r) {
+					for (int influence = 0; influence < 4; ++influence) {
+						lang::item itm;
+						itm.class_ = base_type == std::string_view("Gold Ring") ? "Rings" : "Stackable Currency";
+						itm.base_type = base_type;
+						itm.stack_size = stack_size;
+						itm.item_level = 50 + stack_size * 3;
+						itm.rarity_ = static_cast<lang::rarity_type>(r);
+						itm.is_identified = stack_size % 2 == 0;
+						itm.influence.shaper = (influence & 1) != 0;
+						itm.influence.elder = (influence & 2) != 0;
+
+						const int expected = lang::pass_item_through_filter(itm, original, 1).style.font_size.size.value;
+						BOOST_TEST(lang::pass_item_through_filter(itm, optimized, 1).style.font_size.size.value == expected);
+						BOOST_TEST(lang::pass_item_through_compiled_filter(itm, compiled, 1).font_size.size.value == expected);
+					}
+				}
+			}
+		}
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(merge_blocks_suite)
+
+	constexpr auto mergeable_filter_source = R"(
+Show
+	Class == "Skill Gems"
+	BaseType == "Arc" "Frostbolt"
+	Quality 20
+	SetFontSize 40
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Spark"
+	Quality 20
+	SetFontSize 40
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Spark"
+	Quality 19
+	SetFontSize 40
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Fireball"
+	Quality 19
+	SetFontSize 40
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Fireball"
+	Quality 19
+	SetFontSize 40
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Cleave"
+	Quality 18
+	SetFontSize 35
+
+Show
+	Class == "Skill Gems"
+	BaseType == "Cleave"
+	Quality 16
+	SetFontSize 35
+
+Show
+	Class == "Skill Gems"
+	BaseType != "Arc"
+	Quality 17
+	SetFontSize 35
+
+Show
+	Class == "Skill Gems"
+	BaseType != "Spark"
+	Quality 17
+	SetFontSize 35
+)";
+
+	BOOST_AUTO_TEST_CASE(merge_adjacent_blocks)
+	{
+		const lang::item_filter original = parse_real_filter(mergeable_filter_source);
+		lang::item_filter merged = original;
+		const lang::block_merge_statistics stats = lang::merge_adjacent_blocks(merged);
+
+		// 1 + 2 (BaseType), 3 (differs from the result in BaseType and Quality) + 4 (BaseType)
+		// + 5 (adds nothing), 6 (different actions) + 7 (Quality), 8, 9 (!= can not be merged)
+		BOOST_TEST(stats.merged_blocks == 4u);
+		BOOST_TEST_REQUIRE(merged.blocks.size() == 5u);
+
+		const std::string original_str = compiler::item_filter_to_string_without_preamble(original, {});
+		const std::string merged_str = compiler::item_filter_to_string_without_preamble(merged, {});
+		BOOST_TEST(stats.saved_bytes == original_str.size() - merged_str.size());
+		BOOST_TEST(merged_str.find("BaseType == \"Arc\" \"Frostbolt\" \"Spark\"\n\tQuality 20\n") != std::string::npos);
+		BOOST_TEST(merged_str.find("BaseType == \"Spark\" \"Fireball\"\n\tQuality 19\n") != std::string::npos);
+		BOOST_TEST(merged_str.find("BaseType == \"Cleave\"\n\tQuality 18 16\n") != std::string::npos);
+
+		for (const char* base_type : {"Arc", "Frostbolt", "Spark", "Fireball", "Cleave", "Vaal Arc"}) {
+			for (int quality = 15; quality <= 20; ++quality) {
+				lang::item itm;
+				itm.class_ = "Skill Gems";
+				itm.base_type = base_type;
+				itm.quality = quality;
+
+				const lang::item_filtering_result expected = lang::pass_item_through_filter(itm, original, 1);
+				const lang::item_filtering_result actual = lang::pass_item_through_filter(itm, merged, 1);
+				BOOST_TEST(actual.style.visibility.show == expected.style.visibility.show);
+				BOOST_TEST(actual.style.font_size.size.value == expected.style.font_size.size.value);
+			}
+		}
+	}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(socket_spec_suite)
@@ -318,6 +1029,24 @@ BOOST_AUTO_TEST_SUITE(socket_spec_suite)
 		BOOST_TEST(!test_socket_group_condition(condition, sockets));
 	}
 
+	BOOST_AUTO_TEST_CASE(summary)
+	{
+		const lang::socket_summary summary = make_socket_info("R-G-B-B B W").summary();
+		const auto count_of = [](const lang::socket_summary::counts& counts, lang::socket_color c) {
+			return static_cast<int>(counts.colors[static_cast<std::size_t>(c)]);
+		};
+
+		BOOST_TEST(summary.num_groups == 3);
+		BOOST_TEST(summary.max_links == 4);
+		BOOST_TEST(summary.total.sockets == 6);
+		BOOST_TEST(count_of(summary.total, lang::socket_color::b) == 3);
+		BOOST_TEST(count_of(summary.total, lang::socket_color::w) == 1);
+		BOOST_TEST(summary.groups[0].sockets == 4);
+		BOOST_TEST(count_of(summary.groups[0], lang::socket_color::b) == 2);
+		BOOST_TEST(count_of(summary.groups[1], lang::socket_color::b) == 1);
+		BOOST_TEST(count_of(summary.groups[2], lang::socket_color::w) == 1);
+	}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace fs::test
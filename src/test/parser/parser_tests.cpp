@@ -2,11 +2,17 @@
 #include "common/test_fixtures.hpp"
 
 #include <fs/parser/parser.hpp>
+#include <fs/parser/ast_strings.hpp>
 #include <fs/utility/holds_alternative.hpp>
 
 #include <boost/test/unit_test.hpp>
 
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 
 using namespace fs;
 namespace ast = parser::ast;
@@ -17,8 +23,8 @@ namespace {
 template <typename Value>
 bool test_literal(const ast::common::string_literal& str_lit, const Value& value)
 {
-	if (str_lit != value) {
-		BOOST_ERROR("failed comparison of " << str_lit << " and " << value);
+	if (str_lit.value != value) {
+		BOOST_ERROR("failed comparison of " << str_lit.value << " and " << value);
 		return false;
 	}
 
@@ -110,6 +116,198 @@ bool test_identifier_definition(const sf::definition& def, const char* name, con
 	return true;
 }
 
+// offsets of [first, last) of each top-level AST
+template <typename Ast>
+std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>>
+top_level_ranges(const std::vector<Ast>& asts, const parser::parse_metadata& metadata)
+{
+	const char* const first = metadata.lookup.whole_text().data();
+
+	std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> result;
+	for (const Ast& ast : asts) {
+		const parser::range_type r = metadata.lookup.range_of(ast);
+		result.emplace_back(r.begin() - first, r.end() - first);
+	}
+
+	return result;
+}
+
+std::vector<std::string_view> all_lines(const parser::line_lookup& lines)
+{
+	std::vector<std::string_view> result;
+	for (std::size_t i = 0; i < lines.num_lines(); ++i)
+		result.push_back(lines.get_line(i));
+
+	return result;
+}
+
+// (copy of the AST is needed because visitor can modify strings)
+template <typename Ast>
+std::vector<std::string_view> all_strings(Ast ast)
+{
+	std::vector<std::string_view> result;
+	parser::for_each_ast_string(ast, [&](std::string_view& str) { result.push_back(str); });
+	return result;
+}
+
+// offsets of [first, last) of each position-tagged AST node
+template <typename Ast>
+std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> all_node_ranges(Ast ast, const parser::parse_metadata& metadata)
+{
+	const char* const first = metadata.lookup.whole_text().data();
+
+	std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> result;
+	parser::visit_ast(
+		ast,
+		[](std::string_view& /* str */) {},
+		[&](parser::x3::position_tagged& node) {
+			if (node.id_first < 0)
+				return;
+
+			const parser::range_type r = metadata.lookup.range_of(node);
+			result.emplace_back(r.begin() - first, r.end() - first);
+		});
+	return result;
+}
+
+bool is_within(std::string_view str, std::string_view text)
+{
+	return text.data() <= str.data() && str.data() + str.size() <= text.data() + text.size();
+}
+
+template <typename ParsedFilter, typename TopLevelAsts>
+void test_same_parse(
+	const ParsedFilter& expected,
+	const ParsedFilter& actual,
+	std::string_view text,
+	TopLevelAsts top_level_asts)
+{
+	BOOST_TEST_REQUIRE(actual.metadata.lookup.whole_text().data() == text.data());
+	BOOST_TEST_REQUIRE(
+		(top_level_ranges(top_level_asts(expected.ast), expected.metadata)
+		== top_level_ranges(top_level_asts(actual.ast), actual.metadata)),
+		"edited text:\n" << text);
+	BOOST_TEST_REQUIRE(
+		(all_lines(expected.metadata.lines) == all_lines(actual.metadata.lines)),
+		"edited text:\n" << text);
+	BOOST_TEST_REQUIRE(
+		(all_node_ranges(expected.ast, expected.metadata) == all_node_ranges(actual.ast, actual.metadata)),
+		"edited text:\n" << text);
+
+	// strings of kept ASTs must refer to the edited text, not the previous one
+	const std::vector<std::string_view> actual_strings = all_strings(actual.ast);
+	BOOST_TEST_REQUIRE((all_strings(expected.ast) == actual_strings), "edited text:\n" << text);
+	for (std::string_view str : actual_strings)
+		BOOST_TEST_REQUIRE(is_within(str, text), "edited text:\n" << text);
+}
+
+// Applies small edits at every position of the input and checks
+// that incremental parse gives the same results as the full parse.
+template <typename ParsedFilter, typename ParseFunction, typename ReparseFunction, typename TopLevelAsts>
+void test_incremental_parse(
+	std::string_view input,
+	ParseFunction parse_function,
+	ReparseFunction reparse_function,
+	TopLevelAsts top_level_asts)
+{
+	const auto previous_result = parse_function(input);
+	BOOST_TEST_REQUIRE(std::holds_alternative<ParsedFilter>(previous_result));
+	const ParsedFilter& previous = std::get<ParsedFilter>(previous_result);
+
+	struct edit_with_text
+	{
+		std::size_t removed_size;
+		std::string_view inserted_text;
+	};
+
+	std::size_t num_incremental = 0;
+	for (const edit_with_text& e : {
+		edit_with_text{0, " "}, edit_with_text{0, "\n"}, edit_with_text{0, "#"}, edit_with_text{0, "}"},
+		edit_with_text{0, "Show\n"}, edit_with_text{1, ""}, edit_with_text{1, "x"}, edit_with_text{4, "\n\n"}})
+	{
+		for (std::size_t offset = 0; offset + e.removed_size <= input.size(); ++offset) {
+			std::string edited(input);
+			edited.replace(offset, e.removed_size, e.inserted_text);
+			const parser::text_edit edit{offset, e.removed_size, e.inserted_text.size()};
+
+			const auto expected = parse_function(edited);
+			const auto actual = parse_function(edited, previous, edit);
+			BOOST_TEST_REQUIRE(expected.index() == actual.index(), "edit at " << offset << ":\n" << edited);
+
+			ParsedFilter previous_copy = previous;
+			const std::optional<ParsedFilter> incremental = reparse_function(edited, previous_copy, edit);
+
+			if (!std::holds_alternative<ParsedFilter>(expected)) {
+				// incremental parse never succeeds when the full parse fails
+				BOOST_TEST_REQUIRE(!incremental.has_value(), "edit at " << offset << ":\n" << edited);
+				continue;
+			}
+
+			const ParsedFilter& expected_filter = std::get<ParsedFilter>(expected);
+			test_same_parse(expected_filter, std::get<ParsedFilter>(actual), edited, top_level_asts);
+
+			if (incremental) {
+				++num_incremental;
+				test_same_parse(expected_filter, *incremental, edited, top_level_asts);
+			}
+		}
+	}
+
+	// most edits are within statements, not all of them should fall back to the full parse
+	BOOST_TEST(num_incremental > 0u);
+}
+
+// Edits the same text over and over, each time incrementally
+// reparsing the result of the previous incremental reparse.
+template <typename ParsedFilter, typename ParseFunction, typename ReparseFunction, typename TopLevelAsts>
+void test_chained_incremental_parse(
+	const std::string& input,
+	std::string_view replaced,
+	std::string_view replacement,
+	ParseFunction parse_function,
+	ReparseFunction reparse_function,
+	TopLevelAsts top_level_asts)
+{
+	// previous text must outlive the next reparse
+	std::string texts[2] = {input, input};
+	auto result = parse_function(texts[0]);
+	BOOST_TEST_REQUIRE(std::holds_alternative<ParsedFilter>(result));
+	ParsedFilter current = std::get<ParsedFilter>(std::move(result));
+
+	// sizes of position caches after each edit
+	std::vector<std::size_t> sizes;
+	for (std::size_t i = 1; i <= 20; ++i) {
+		const std::string_view from = i % 2u == 1u ? replaced : replacement;
+		const std::string_view to = i % 2u == 1u ? replacement : replaced;
+
+		std::string& edited = texts[i % 2u];
+		edited = texts[(i + 1u) % 2u];
+		const std::size_t offset = edited.find(from);
+		BOOST_TEST_REQUIRE(offset != std::string::npos);
+		edited.replace(offset, from.size(), to);
+
+		std::optional<ParsedFilter> incremental = reparse_function(
+			edited, current, parser::text_edit{offset, from.size(), to.size()});
+		BOOST_TEST_REQUIRE(incremental.has_value(), "edit " << i << ":\n" << edited);
+
+		const auto expected = parse_function(edited);
+		BOOST_TEST_REQUIRE(std::holds_alternative<ParsedFilter>(expected));
+		const ParsedFilter& expected_filter = std::get<ParsedFilter>(expected);
+		test_same_parse(expected_filter, *incremental, edited, top_level_asts);
+
+		current = std::move(*incremental);
+
+		// positions of replaced ASTs are dropped: the cache is never larger than
+		// after a full parse and repeating the same edits does not grow it
+		const std::size_t size = current.metadata.lookup.size();
+		BOOST_TEST(size <= expected_filter.metadata.lookup.size(), "edit " << i);
+		if (sizes.size() >= 2u)
+			BOOST_TEST(size == sizes[sizes.size() - 2u], "edit " << i);
+
+		sizes.push_back(size);
+	}
+}
+
 } // namespace
 
 namespace fs::test
@@ -303,6 +501,72 @@ Show
 		 */
 	}
 
+	BOOST_AUTO_TEST_CASE(incremental_parse_spirit_filter)
+	{
+		const std::string input = minimal_input() + R"(
+$color_black = 0 0 0
+$orb = "Orb"
+SetBackgroundColor $color_black
+
+Class "Currency"
+{
+	BaseType $orb
+	{
+		SetAlertSound "orb.wav"
+		Show
+	}
+
+	Hide
+}
+# comment
+Rarity Unique
+{
+	Show
+}
+)";
+
+		const auto parse = [](std::string_view text, auto&&... args) { return parser::parse_spirit_filter(text, args...); };
+		const auto reparse = [](std::string_view text, parser::parsed_spirit_filter& previous, parser::text_edit edit) {
+			return parser::reparse_spirit_filter(text, previous, edit);
+		};
+		const auto statements = [](const sf::ast_type& ast) -> const std::vector<sf::statement>& { return ast.statements; };
+
+		test_incremental_parse<parser::parsed_spirit_filter>(input, parse, reparse, statements);
+		test_chained_incremental_parse<parser::parsed_spirit_filter>(input, "\tHide", "\tShow", parse, reparse, statements);
+
+		// strings nested in kept definitions must be moved to the edited text too
+		auto previous = parser::parse_spirit_filter(input);
+		BOOST_TEST_REQUIRE(std::holds_alternative<parser::parsed_spirit_filter>(previous));
+
+		std::string edited = input;
+		const std::size_t offset = edited.find("Hide");
+		edited.replace(offset, 4, "Show");
+		const std::optional<parser::parsed_spirit_filter> result = parser::reparse_spirit_filter(
+			edited, std::get<parser::parsed_spirit_filter>(previous), parser::text_edit{offset, 4, 4});
+		BOOST_TEST_REQUIRE(result.has_value());
+
+		const std::vector<sf::definition>& defs = result->ast.definitions;
+		BOOST_TEST_REQUIRE(defs.size() == 2u);
+		BOOST_TEST_REQUIRE(test_literal_definition<ast::common::string_literal>(defs[1], "orb", "Orb"));
+		const sf::primitive_value* const prim = get_primitive(defs[1], "orb");
+		const auto& expr = boost::get<ast::common::literal_expression>(prim->var);
+		BOOST_TEST(is_within(boost::get<ast::common::string_literal>(expr.var).value, edited));
+	}
+
+	BOOST_AUTO_TEST_CASE(incremental_parse_real_filter)
+	{
+		const std::string input = "Show\r\n\tClass \"Currency\"\r\n\r\nHide\n\tRarity Unique\n# comment\n\nShow\n";
+
+		const auto parse = [](std::string_view text, auto&&... args) { return parser::parse_real_filter(text, args...); };
+		const auto reparse = [](std::string_view text, parser::parsed_real_filter& previous, parser::text_edit edit) {
+			return parser::reparse_real_filter(text, previous, edit);
+		};
+		const auto blocks = [](const parser::ast::rf::ast_type& ast) -> const parser::ast::rf::ast_type& { return ast; };
+
+		test_incremental_parse<parser::parsed_real_filter>(input, parse, reparse, blocks);
+		test_chained_incremental_parse<parser::parsed_real_filter>(input, "Unique", "Rare", parse, reparse, blocks);
+	}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
 
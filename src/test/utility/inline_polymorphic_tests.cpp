@@ -0,0 +1,118 @@
+#include <fs/utility/inline_polymorphic.hpp>
+#include <fs/lang/conditions.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+int num_alive = 0;
+
+struct shape
+{
+	shape() { ++num_alive; }
+	shape(const shape&) { ++num_alive; }
+	virtual ~shape() { --num_alive; }
+
+	virtual std::string name() const = 0;
+};
+
+struct circle : shape
+{
+	std::string name() const override { return "circle"; }
+};
+
+struct named_shape : shape
+{
+	explicit named_shape(std::string name)
+	: m_name(std::move(name)) {}
+
+	std::string name() const override { return m_name; }
+
+	std::string m_name;
+};
+
+using shape_value = fs::utility::inline_polymorphic<shape, 64>;
+
+}
+
+BOOST_AUTO_TEST_SUITE(inline_polymorphic_suite)
+
+	BOOST_AUTO_TEST_CASE(empty)
+	{
+		const shape_value default_value;
+		BOOST_TEST(!default_value);
+		BOOST_TEST((default_value == nullptr));
+
+		const shape_value null_value = nullptr;
+		BOOST_TEST(!null_value);
+		BOOST_TEST((null_value.get() == nullptr));
+	}
+
+	BOOST_AUTO_TEST_CASE(copy_and_move)
+	{
+		BOOST_REQUIRE(num_alive == 0);
+
+		{
+			shape_value first = shape_value::make<named_shape>("a very long name which does not fit into SSO buffer");
+			shape_value second = shape_value::make<circle>();
+			BOOST_TEST(num_alive == 2);
+
+			shape_value copy = first;
+			BOOST_TEST(num_alive == 3);
+			BOOST_TEST(copy->name() == first->name());
+			BOOST_TEST((copy.get() != first.get()));
+
+			shape_value moved = std::move(first);
+			BOOST_TEST(num_alive == 3);
+			BOOST_TEST(!first);
+			BOOST_TEST(moved->name() == copy->name());
+
+			copy = second;
+			BOOST_TEST(num_alive == 3);
+			BOOST_TEST(copy->name() == "circle");
+
+			second = std::move(moved);
+			BOOST_TEST(num_alive == 2);
+			BOOST_TEST(!moved);
+			BOOST_TEST(second->name() == "a very long name which does not fit into SSO buffer");
+
+			second.reset();
+			BOOST_TEST(num_alive == 1);
+			BOOST_TEST(!second);
+		}
+
+		BOOST_TEST(num_alive == 0);
+	}
+
+	BOOST_AUTO_TEST_CASE(condition_copies_own_values)
+	{
+		namespace lang = fs::lang;
+
+		const auto make_values = [](std::initializer_list<const char*> names) {
+			lang::string_comparison_condition::container_type values;
+			for (const char* name : names)
+				values.push_back(lang::string{name, {}});
+			return values;
+		};
+
+		const lang::official_condition_value original = lang::make_base_type_condition(
+			lang::equality_comparison_type::equal, make_values({"Divine", "Exalted"}), {});
+		lang::official_condition_value copy = original;
+
+		const auto& original_str = dynamic_cast<const lang::string_comparison_condition&>(*original);
+		auto& copy_str = dynamic_cast<lang::string_comparison_condition&>(*copy);
+		BOOST_TEST((&copy_str.values() != &original_str.values()));
+
+		const lang::official_condition_value other = lang::make_base_type_condition(
+			lang::equality_comparison_type::equal, make_values({"Mirror"}), {});
+		BOOST_TEST_REQUIRE(copy_str.merge_values(*other));
+		BOOST_TEST(copy_str.values().size() == 3u);
+		BOOST_TEST(original_str.values().size() == 2u);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
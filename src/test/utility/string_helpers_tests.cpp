@@ -2,6 +2,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 class string_helpers_fixture
 {
 	// nothing for now
@@ -45,6 +49,13 @@ BOOST_FIXTURE_TEST_SUITE(string_helpers_suite, string_helpers_fixture)
 		BOOST_TEST( compare_strings_ignore_diacritics("Maelström Staff", "ström", false));
 		BOOST_TEST(!compare_strings_ignore_diacritics("Maelström Staff", "ström", true));
 
+		// unicode - requirement without diacritics
+		BOOST_TEST( compare_strings_ignore_diacritics("Maelström Staff", "Maelstrom Staff", false));
+		BOOST_TEST( compare_strings_ignore_diacritics("Maelström Staff", "Maelstrom Staff", true));
+		BOOST_TEST( compare_strings_ignore_diacritics("Maelström Staff", "strom", false));
+		BOOST_TEST(!compare_strings_ignore_diacritics("Maelström Staff", "strom", true));
+		BOOST_TEST( compare_strings_ignore_diacritics("ÖöÖ", "OoO", true));
+
 		// corner cases - incorrect second UTF-8 byte
 		BOOST_TEST(!compare_strings_ignore_diacritics("ö", "Ö", false));
 		BOOST_TEST(!compare_strings_ignore_diacritics("ö", "Ö", true));
@@ -67,6 +78,61 @@ BOOST_FIXTURE_TEST_SUITE(string_helpers_suite, string_helpers_fixture)
 		BOOST_TEST(!compare_strings_ignore_diacritics(invalid_utf8, "o", true));
 	}
 
+	BOOST_AUTO_TEST_CASE(compare_strings_ignore_diacritics_long_values)
+	{
+		using fs::utility::compare_strings_ignore_diacritics;
+		using fs::utility::compare_strings_ignore_diacritics_scalar;
+
+		// long enough values to go through multiple SIMD blocks and the scalar tail
+		const std::string filler = "Orb of Chaos Staff Amulet Ring Maelstr";
+		std::vector<std::string> values;
+		for (std::size_t length = 0; length <= 2 * filler.size(); ++length) {
+			std::string value;
+			while (value.size() < length)
+				value += filler;
+			value.resize(length);
+
+			values.push_back(value);
+			values.push_back(value + "Maelström Staff");
+			values.push_back("Maelström Staff" + value);
+			values.push_back(value + "ö");
+			values.push_back(value + "Ö" + value);
+		}
+
+		const auto requirements = {
+			"o", "O", "ö", "Ö", "Orb", "Maelstrom", "Maelström", "Maelstrom Staff", "Staff Amulet", "x", "ffO", "Ring Maelstrom"
+		};
+
+		for (const std::string& value : values) {
+			for (std::string_view requirement : requirements) {
+				for (bool exact : {false, true}) {
+					BOOST_TEST(
+						compare_strings_ignore_diacritics(value, requirement, exact)
+							== compare_strings_ignore_diacritics_scalar(value, requirement, exact),
+						"value: \"" << value << "\", requirement: \"" << requirement << "\", exact: " << exact);
+				}
+			}
+		}
+
+		BOOST_TEST( compare_strings_ignore_diacritics(filler + filler + "Maelström Staff", "Maelstrom Staff", false));
+		BOOST_TEST(!compare_strings_ignore_diacritics(filler + filler + "Maelström Staff", "Maelström Stafff", false));
+	}
+
+	BOOST_AUTO_TEST_CASE(remove_diacritics)
+	{
+		using fs::utility::remove_diacritics;
+
+		BOOST_TEST(remove_diacritics("") == "");
+		BOOST_TEST(remove_diacritics("The Wolf's Legacy") == "The Wolf's Legacy");
+		BOOST_TEST(remove_diacritics("Maelström Staff") == "Maelstrom Staff");
+		BOOST_TEST(remove_diacritics("ÖöÖ") == "OoO");
+
+		// invalid UTF-8 is left as is
+		constexpr auto c = static_cast<char>(0xC3);
+		const std::string invalid_utf8(1u, c);
+		BOOST_TEST(remove_diacritics(invalid_utf8) == invalid_utf8);
+	}
+
 	class trim_fixture
 	{
 	protected:
@@ -0,0 +1,82 @@
+#include <fs/utility/substring_matcher.hpp>
+#include <fs/utility/string_helpers.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+std::size_t find_first_pattern_naive(std::string_view value, const std::vector<std::string_view>& patterns)
+{
+	for (std::size_t i = 0; i < patterns.size(); ++i)
+		if (fs::utility::compare_strings_ignore_diacritics(value, patterns[i], false))
+			return i;
+
+	return fs::utility::substring_matcher::npos;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(substring_matcher_suite)
+
+	BOOST_AUTO_TEST_CASE(no_patterns)
+	{
+		const fs::utility::substring_matcher default_matcher;
+		BOOST_TEST(!default_matcher.matches_any(""));
+		BOOST_TEST(!default_matcher.matches_any("Chaos Orb"));
+
+		const fs::utility::substring_matcher empty_matcher(std::vector<std::string_view>{});
+		BOOST_TEST(!empty_matcher.matches_any(""));
+		BOOST_TEST(!empty_matcher.matches_any("Chaos Orb"));
+	}
+
+	BOOST_AUTO_TEST_CASE(first_pattern)
+	{
+		const fs::utility::substring_matcher matcher({"Orb", "Chaos", "Exalted Orb", "Orb"});
+		BOOST_TEST(matcher.find_first_pattern("Chaos Orb") == 0u);
+		BOOST_TEST(matcher.find_first_pattern("Chaos Shard") == 1u);
+		BOOST_TEST(matcher.find_first_pattern("Exalted Shard") == fs::utility::substring_matcher::npos);
+		BOOST_TEST(matcher.find_first_pattern("") == fs::utility::substring_matcher::npos);
+	}
+
+	BOOST_AUTO_TEST_CASE(empty_pattern)
+	{
+		const fs::utility::substring_matcher matcher({"Ring", ""});
+		BOOST_TEST(matcher.find_first_pattern("") == 1u);
+		BOOST_TEST(matcher.find_first_pattern("Amulet") == 1u);
+		BOOST_TEST(matcher.find_first_pattern("Gold Ring") == 0u);
+	}
+
+	BOOST_AUTO_TEST_CASE(same_as_naive_comparison)
+	{
+		const std::vector<std::string_view> patterns = {
+			"Ring", "Amulet", "ring", "Maelstrom", "Maelström", "ström", "aaab", "aab", "ab", "b",
+			"Staff of the Maelstrom", "OoO", "he", "she", "his", "hers"
+		};
+		const std::vector<std::string_view> values = {
+			"", "R", "Ring", "Gold Ring", "Amulet Ring", "Maelstrom Staff", "Maelström Staff",
+			"Maelstrxm", "aaaab", "aaaaaaaaa", "b", "ÖöÖ", "ushers", "Staff of the Maelström",
+			"Staff of the Maelstro"
+		};
+
+		for (std::size_t n = 1; n <= patterns.size(); ++n) {
+			// test multiple subsets so that patterns land on different positions
+			const std::vector<std::string_view> first_n(patterns.begin(), patterns.begin() + n);
+			const std::vector<std::string_view> last_n(patterns.end() - n, patterns.end());
+
+			for (const auto& subset : {first_n, last_n}) {
+				const fs::utility::substring_matcher matcher(subset);
+
+				for (std::string_view value : values) {
+					const std::size_t expected = find_first_pattern_naive(value, subset);
+					BOOST_TEST(matcher.find_first_pattern(value) == expected, "value: \"" << value << "\"");
+					BOOST_TEST(matcher.matches_any(value) == (expected != fs::utility::substring_matcher::npos));
+				}
+			}
+		}
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
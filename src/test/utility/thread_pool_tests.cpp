@@ -0,0 +1,57 @@
+#include <fs/utility/thread_pool.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace utility = fs::utility;
+
+BOOST_AUTO_TEST_SUITE(thread_pool_suite)
+
+	BOOST_AUTO_TEST_CASE(each_index_once)
+	{
+		utility::thread_pool pool(4);
+		BOOST_TEST(pool.num_threads() == 4u);
+
+		std::vector<int> counts(1000, 0);
+		utility::parallel_for(counts.size(), utility::parallel_settings{&pool, 7}, [&](std::size_t i) { ++counts[i]; });
+
+		for (int count : counts)
+			BOOST_TEST(count == 1);
+	}
+
+	BOOST_AUTO_TEST_CASE(nested_calls_share_pool)
+	{
+		utility::thread_pool pool(3);
+
+		// every outer index occupies a thread of the pool while waiting for inner work
+		std::atomic<std::size_t> sum{0};
+		utility::parallel_for(16, utility::parallel_settings{&pool, 1}, [&](std::size_t) {
+			utility::parallel_for(100, utility::parallel_settings{&pool, 10}, [&](std::size_t j) { sum += j; });
+		});
+
+		BOOST_TEST(sum.load() == 16u * 4950u);
+	}
+
+	BOOST_AUTO_TEST_CASE(exception_propagation)
+	{
+		utility::thread_pool pool(4);
+		std::atomic<std::size_t> calls{0};
+		BOOST_CHECK_THROW(
+			utility::parallel_for(100, utility::parallel_settings{&pool, 1}, [&](std::size_t i) {
+				++calls;
+				if (i == 50)
+					throw std::runtime_error("test");
+			}),
+			std::runtime_error);
+
+		// pool remains usable
+		calls = 0;
+		utility::parallel_for(100, utility::parallel_settings{&pool, 1}, [&](std::size_t) { ++calls; });
+		BOOST_TEST(calls.load() == 100u);
+	}
+
+BOOST_AUTO_TEST_SUITE_END()